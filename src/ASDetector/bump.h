@@ -28,6 +28,7 @@
 #include "pt2f.h"
 #include "bumpmodel.h"
 #include "digitalstraightsegment.h"
+#include "objectarena.h"
 #include <cstddef>
 
 
@@ -35,7 +36,7 @@
  * @class Bump bump.h
  * \brief Cross section of a ridge or hollow structure.
  */
-class Bump
+class Bump : public ArenaObject
 {
 public:
 
@@ -23,6 +23,7 @@
 */
 
 #include "ctrackdetector.h"
+#include "workerpool.h"
 #include <cmath>
 #include <algorithm>
 
@@ -42,12 +43,8 @@ const float CTrackDetector::MAX_TRACK_WIDTH = 6.0f;
 const int CTrackDetector::DEFAULT_PLATEAU_LACK_TOLERANCE = 11;
 const int CTrackDetector::NOBOUNDS_TOLERANCE = 10;
 const int CTrackDetector::INITIAL_TRACK_EXTENT = 6;
-const int CTrackDetector::DEFAULT_POS_AND_HEIGHT_REGISTER_SIZE = 8;
-const int CTrackDetector::DEFAULT_UNSTABILITY_REGISTER_SIZE = 6;
 const int CTrackDetector::DEFAULT_MIN_DENSITY = 60;
 const float CTrackDetector::DEFAULT_MAX_SHIFT_LENGTH = 1.65f;
-const float CTrackDetector::LN_UNSTAB = 0.25f;
-const int CTrackDetector::NB_UNSTAB = 2;
 const float CTrackDetector::POS_INCR = 0.05f;
 
 const int CTrackDetector::NB_SIDE_TRIALS = 5;
@@ -72,22 +69,7 @@ CTrackDetector::CTrackDetector ()
   istatus = RESULT_NONE;
   pfeat.setMinLength (CarriageTrack::MIN_WIDTH);
   pfeat.setMaxLength (CarriageTrack::MAX_WIDTH);
-  posht_nb = DEFAULT_POS_AND_HEIGHT_REGISTER_SIZE;
-  lpok = new bool[posht_nb];
-  lpos = new float[posht_nb];
-  lhok = new bool[posht_nb];
-  lht = new float[posht_nb];
-  initial_ref = 0;
-  initial_refs = 0.0f;
-  initial_refe = 0.0f;
-  initial_refh = 0.0f;
   initial_unbounded = true;
-  unstab_nb = DEFAULT_UNSTABILITY_REGISTER_SIZE;
-  spos = new float[unstab_nb];
-  epos = new float[unstab_nb];
-  spok = new bool[unstab_nb];
-  epok = new bool[unstab_nb];
-  resetRegisters ();
   out_count = 0;
 }
 
@@ -106,6 +88,9 @@ void CTrackDetector::clear ()
   if (ict != NULL) delete ict;
   ict = NULL;
   istatus = RESULT_NONE;
+  arena.reset ();
+  rside.arena ()->reset ();
+  lside.arena ()->reset ();
 }
 
 
@@ -126,10 +111,33 @@ void CTrackDetector::setPointsGrid (IPtTileSet *data, int width, int height,
 }
 
 
+void CTrackDetector::copySettings (const CTrackDetector &det)
+{
+  ptset = det.ptset;
+  subdiv = det.subdiv;
+  csize = det.csize;
+  scanp = det.scanp;
+  discanp = det.discanp;
+  auto_p = det.auto_p;
+  connect_on = det.connect_on;
+  profileRecordOn = det.profileRecordOn;
+  psorter.setRadix (det.psorter.isRadixOn ());
+  pfeat = det.pfeat;
+  plateau_lack_tolerance = det.plateau_lack_tolerance;
+  initial_track_extent = det.initial_track_extent;
+  density_insensitive = det.density_insensitive;
+  shift_length_pruning = det.shift_length_pruning;
+  max_shift_length = det.max_shift_length;
+  density_pruning = det.density_pruning;
+  min_density = det.min_density;
+}
+
+
 CarriageTrack *CTrackDetector::detect (const Pt2i &p1, const Pt2i &p2)
 {
   // Cleans up former detection
   clear ();
+  ObjectArena::Scope scope (&arena);
 
   // Checks input stroke length
   ip1.set (p1);
@@ -253,12 +261,12 @@ void CTrackDetector::detect (int exlimit)
   int scan0_shift = (int) (valc < 0.0f ? valc - 0.5f : valc + 0.5f);
 
   // Creates adaptive directional scanners for point cloud and display
-  DirectionalScanner *ds = scanp.getScanner (
+  DirectionalScanner *ds = scanp.getScanner (scan_holder,
     Pt2i (p1.x () * subdiv + subdiv / 2, p1.y () * subdiv + subdiv / 2),
     Pt2i (p2.x () * subdiv + subdiv / 2, p2.y () * subdiv + subdiv / 2),
     true);
   ds->releaseClearance ();
-  DirectionalScanner *disp = discanp.getScanner (p1, p2, true);
+  DirectionalScanner *disp = discanp.getScanner (disp_holder, p1, p2, true);
 
   // Gets the central scan of the point cloud
   std::vector<Pt2i> pix;
@@ -273,8 +281,6 @@ void CTrackDetector::detect (int exlimit)
     if (exlimit != 0)
       istatus = RESULT_FAIL_NO_AVAILABLE_SCAN;
     else fstatus = RESULT_FAIL_NO_AVAILABLE_SCAN;
-    delete ds;
-    delete disp;
     return;
   }
 
@@ -284,21 +290,8 @@ void CTrackDetector::detect (int exlimit)
 
   // Gets and sorts scanned points by distance to first stroke point
   std::vector<Pt2f> cpts;
-  std::vector<Pt2i>::iterator it = pix.begin ();
-  while (it != pix.end ())
-  {
-    std::vector<Pt3f> ptcl;
-    if (! ptset->collectPoints (ptcl, it->x (), it->y ())) out_count ++;
-    std::vector<Pt3f>::iterator pit = ptcl.begin ();
-    while (pit != ptcl.end ())
-    {
-      Vr2f pcl (pit->x () - p1f.x (), pit->y () - p1f.y ());
-      cpts.push_back (Pt2f (pcl.scalarProduct (p12) / l12, pit->z ()));
-      pit ++;
-    }
-    it ++;
-  }
-  sort (cpts.begin (), cpts.end (), compIFurther);
+  out_count += ptset->collectScanProfile (cpts, pix, p1f, p12, l12);
+  psorter.sortOnMillimeters (cpts);
 
   // Detects the central plateau
   CarriageTrack *ct = new CarriageTrack ();
@@ -342,48 +335,17 @@ void CTrackDetector::detect (int exlimit)
     if (exlimit != 0)
       istatus = RESULT_FAIL_NO_CENTRAL_PLATEAU;
     else fstatus = RESULT_FAIL_NO_CENTRAL_PLATEAU;
-    delete ds;
-    delete disp;
     return;
   }
 
-  // Updates reference pattern and detects next plateaux on each side
-  if (cpl->bounded ()) initial_unbounded = false;
-  initial_refs = cpl->internalStart ();
-  initial_refe = cpl->internalEnd ();
-  initial_refh = cpl->getMinHeight ();
-  DirectionalScanner *ds2 = ds->getCopy ();
-  DirectionalScanner *disp2 = disp->getCopy ();
-
-  resetRegisters (cpl->reliable (),
-                  cpl->estimatedCenter (), cpl->getMinHeight ());
-  track (true, scanp.isLastScanReversed (), exlimit,
-         ds, disp, p1f, p12, l12, initial_refs, initial_refe, initial_refh);
-  bool firstUnbounded = initial_unbounded;
-
-  resetRegisters (cpl->reliable (),
-                  cpl->estimatedCenter (), cpl->getMinHeight ());
-  track (false, scanp.isLastScanReversed (), exlimit,
-         ds2, disp2, p1f, p12, l12, initial_refs, initial_refe, initial_refh);
-
-  // second chance for first side if the central plateau was not bounded
-  //   and a bound was found on the second side.
-  if (firstUnbounded && ! initial_unbounded)
-  {
-    resetRegisters (cpl->reliable (),
-                    cpl->estimatedCenter (), cpl->getMinHeight ());
-    
-    track (true, scanp.isLastScanReversed (), exlimit,
-           ds, disp, p1f, p12, l12, initial_refs, initial_refe, initial_refh);
-  }
+  // Detects next plateaux on each side
+  trackSides (cpl, false, exlimit, ds, disp, p1f, p12, l12);
   if (pfeat.tailMinSize () != 0 && ct->prune (pfeat.tailMinSize ()))
   {
     ct->setStatus (RESULT_FAIL_NO_CONSISTENT_SEQUENCE);
     if (exlimit != 0) istatus = RESULT_FAIL_NO_CONSISTENT_SEQUENCE;
     else fstatus = RESULT_FAIL_NO_CONSISTENT_SEQUENCE;
   }
-  delete ds;
-  delete disp;
 }
 
 
@@ -402,12 +364,12 @@ void CTrackDetector::detect ()
   int scan0_shift = (int) (valc < 0.0f ? valc - 0.5f : valc + 0.5f);
 
   // Creates adaptive directional scanners for point cloud and display
-  DirectionalScanner *ds = scanp.getScanner (
+  DirectionalScanner *ds = scanp.getScanner (scan_holder,
     Pt2i (p1.x () * subdiv + subdiv / 2, p1.y () * subdiv + subdiv / 2),
     Pt2i (p2.x () * subdiv + subdiv / 2, p2.y () * subdiv + subdiv / 2),
     true);
   ds->releaseClearance ();
-  DirectionalScanner *disp = discanp.getScanner (p1, p2, true);
+  DirectionalScanner *disp = discanp.getScanner (disp_holder, p1, p2, true);
 
   // Gets the central scan of the point cloud
   std::vector<Pt2i> pix;
@@ -420,8 +382,6 @@ void CTrackDetector::detect ()
   if (pix.empty ())
   {
     fstatus = RESULT_FAIL_NO_AVAILABLE_SCAN;
-    delete ds;
-    delete disp;
     return;
   }
 
@@ -431,49 +391,44 @@ void CTrackDetector::detect ()
 
   // Gets and sorts scanned points by distance to first stroke point
   std::vector<Pt2f> cpts;
-  std::vector<Pt2i>::iterator it = pix.begin ();
-  while (it != pix.end ())
-  {
-    std::vector<Pt3f> ptcl;
-    if (! ptset->collectPoints (ptcl, it->x (), it->y ())) out_count ++;
-    std::vector<Pt3f>::iterator pit = ptcl.begin ();
-    while (pit != ptcl.end ())
-    {
-      Vr2f pcl (pit->x () - p1f.x (), pit->y () - p1f.y ());
-      cpts.push_back (Pt2f (pcl.scalarProduct (p12) / l12, pit->z ()));
-      pit ++;
-    }
-    it ++;
-  }
-  sort (cpts.begin (), cpts.end (), compIFurther);
+  out_count += ptset->collectScanProfile (cpts, pix, p1f, p12, l12);
+  psorter.sortOnMillimeters (cpts);
 
   // Creates the carriage track
   fct = new CarriageTrack ();
   fct->setDetectionSeed (p1, p2, csize);
 
-  float *tests = new float[NB_SIDE_TRIALS * 2];
-  for (int i = 0; i < NB_SIDE_TRIALS; i ++)
-  {
-    tests[2 * i] = pfeat.firstPlateauSearchDistance () * (i + 1);
-    tests[2 * i + 1] = - pfeat.firstPlateauSearchDistance () * (i + 1);
-  }
-  Plateau *cpl = new Plateau (&pfeat, scan0_shift);
-  bool found = (pfeat.isNetBuildOn () ?
-    cpl->track (cpts, NULL, 0, 0.0f, l12) :
-    cpl->track (cpts, 0.0f, l12, 0.0f, 0.0f, 0));
-  for (int ptest = 0; ptest != NB_SIDE_TRIALS * 2; ptest++)
+  // Central plateau trials (unshifted, then increasingly shifted on each
+  //   side) run concurrently on the shared profile, then are compared in
+  //   trial order, the thinnest successful plateau being kept.
+  PlateauProfile prof;
+  prof.set (cpts);
+  int nbtrials = NB_SIDE_TRIALS * 2 + 1;
+  std::vector<Plateau *> trials;
+  for (int i = 0; i < nbtrials; i++)
+    trials.push_back (new Plateau (&pfeat, scan0_shift));
+  std::vector<int> successes (nbtrials, 0);
+  WorkerPool::common ().run (nbtrials, [&] (int i) {
+    float shift = 0.0f;
+    if (i != 0)
+    {
+      shift = pfeat.firstPlateauSearchDistance () * ((i - 1) / 2 + 1);
+      if ((i - 1) % 2 != 0) shift = - shift;
+    }
+    successes[i] = (pfeat.isNetBuildOn () ?
+      trials[i]->track (cpts, prof, NULL, 0, shift, l12) :
+      trials[i]->track (cpts, prof, 0.0f, l12, 0.0f, shift, 0)); });
+  Plateau *cpl = trials[0];
+  bool found = (successes[0] != 0);
+  for (int i = 1; i < nbtrials; i++)
   {
-    Plateau *cpl2 = new Plateau (&pfeat, scan0_shift);
-    bool success = (pfeat.isNetBuildOn () ?
-      cpl2->track (cpts, NULL, 0, tests[ptest], l12) :
-      cpl2->track (cpts, 0.0f, l12, 0.0f, tests[ptest], 0));
-    if (success) found = true;
-    if (success && cpl2->thinerThan (cpl))
+    if (successes[i]) found = true;
+    if (successes[i] && trials[i]->thinerThan (cpl))
     {
       delete cpl;
-      cpl = cpl2;
+      cpl = trials[i];
     }
-    else delete cpl2;
+    else delete trials[i];
   }
   if (profileRecordOn) fct->start (cpl, dispix, cpts,
                                    scanp.isLastScanReversed ());
@@ -487,59 +442,108 @@ void CTrackDetector::detect ()
   {
     fct->setStatus (RESULT_FAIL_NO_CENTRAL_PLATEAU);
     fstatus = RESULT_FAIL_NO_CENTRAL_PLATEAU;
-    delete ds;
-    delete disp;
     return;
   }
 
-  // Updates reference pattern and detects next plateaux on each side
-  if (cpl->bounded ()) initial_unbounded = false;
-  initial_ref = 0;
-  initial_refs = cpl->internalStart ();
-  initial_refe = cpl->internalEnd ();
-  initial_refh = cpl->getMinHeight ();
-  DirectionalScanner *ds2 = ds->getCopy ();
-  DirectionalScanner *disp2 = disp->getCopy ();
-
-  resetRegisters (cpl->reliable (),
-                  cpl->estimatedCenter (), cpl->getMinHeight ());
-  if (pfeat.isNetBuildOn ())
-    track (true, scanp.isLastScanReversed (), 0, ds, disp, p1f, p12, l12, cpl);
-  else track (true, scanp.isLastScanReversed (), 0, ds, disp,
-              p1f, p12, l12, initial_refs, initial_refe, initial_refh);
-  bool firstUnbounded = initial_unbounded;
-
-  resetRegisters (cpl->reliable (),
-                  cpl->estimatedCenter (), cpl->getMinHeight ());
-  if (pfeat.isNetBuildOn ())
-    track (false, scanp.isLastScanReversed (), 0, ds2, disp2,
-           p1f, p12, l12, fct->plateau (initial_ref));
-  else track (false, scanp.isLastScanReversed (), 0, ds2, disp2,
-              p1f, p12, l12, initial_refs, initial_refe, initial_refh);
-
-  // second chance for first side if the central plateau was not bounded
-  //   and a bound was found on the second side.
-  if (firstUnbounded && ! initial_unbounded)
-  {
-    resetRegisters (cpl->reliable (),
-                    cpl->estimatedCenter (), cpl->getMinHeight ());
-    if (pfeat.isNetBuildOn ())
-      track (true, scanp.isLastScanReversed (), 0, ds, disp,
-             p1f, p12, l12, fct->plateau (initial_ref));
-    else track (true, scanp.isLastScanReversed (), 0, ds, disp,
-                p1f, p12, l12, initial_refs, initial_refe, initial_refh);
-  }
+  // Detects next plateaux on each side
+  trackSides (cpl, pfeat.isNetBuildOn (), 0, ds, disp, p1f, p12, l12);
   if (pfeat.tailMinSize () != 0 && fct->prune (pfeat.tailMinSize ()))
   {
     fct->setStatus (RESULT_FAIL_NO_CONSISTENT_SEQUENCE);
     fstatus = RESULT_FAIL_NO_CONSISTENT_SEQUENCE;
   }
-  delete ds;
-  delete disp;
 }
 
 
-void CTrackDetector::track (bool onright, bool reversed, int exlimit,
+void CTrackDetector::trackSides (Plateau *cpl, bool netbuild, int exlimit,
+                                 DirectionalScanner *ds,
+                                 DirectionalScanner *disp,
+                                 Pt2f p1f, Vr2f p12, float l12)
+{
+  // Both sides start from the central plateau reference pattern
+  if (cpl->bounded ()) initial_unbounded = false;
+  rside.setReference (initial_unbounded, 0, cpl->internalStart (),
+                      cpl->internalEnd (), cpl->getMinHeight ());
+  lside.setReference (rside);
+  rside.sorter ()->setRadix (psorter.isRadixOn ());
+  lside.sorter ()->setRadix (psorter.isRadixOn ());
+  DirectionalScanner *ds2 = ds->getCopy (scan_holder2);
+  DirectionalScanner *disp2 = disp->getCopy (disp_holder2);
+
+  // Without bounds, the second side is tracked speculatively, and tracked
+  //   again from its start if bounds are found on the first side.
+  bool speculative = initial_unbounded;
+  DirectionalScanner *ds3 = NULL, *disp3 = NULL;
+  if (speculative)
+  {
+    ds3 = ds->getCopy (scan_holder3);
+    disp3 = disp->getCopy (disp_holder3);
+  }
+  WorkerPool::common ().run (2, [&] (int i) {
+    ObjectArena::Scope scope (i == 0 ? rside.arena () : lside.arena ());
+    if (i == 0)
+      trackSide (rside, cpl, true, netbuild, exlimit, ds, disp, p1f, p12, l12);
+    else trackSide (lside, cpl, false, netbuild, exlimit,
+                    ds2, disp2, p1f, p12, l12); });
+  collect (rside, exlimit);
+
+  if (speculative && ! rside.unbounded ())
+  {
+    lside.setReference (rside);
+    trackSide (lside, cpl, false, netbuild, exlimit,
+               ds3, disp3, p1f, p12, l12);
+    collect (lside, exlimit);
+  }
+  else
+  {
+    collect (lside, exlimit);
+
+    // second chance for first side if the central plateau was not bounded
+    //   and a bound was found on the second side.
+    if (speculative && ! lside.unbounded ())
+    {
+      rside.setReference (lside);
+      trackSide (rside, cpl, true, netbuild, exlimit, ds, disp, p1f, p12, l12);
+      collect (rside, exlimit);
+    }
+  }
+  initial_unbounded = lside.unbounded ();
+}
+
+
+void CTrackDetector::trackSide (CTrackSide &side, Plateau *cpl, bool onright,
+                                bool netbuild, int exlimit,
+                                DirectionalScanner *ds,
+                                DirectionalScanner *disp,
+                                Pt2f p1f, Vr2f p12, float l12)
+{
+  side.restart ();
+  side.resetRegisters (cpl->reliable (),
+                       cpl->estimatedCenter (), cpl->getMinHeight ());
+  if (netbuild)
+    track (side, onright, scanp.isLastScanReversed (), exlimit, ds, disp,
+           p1f, p12, l12,
+           (exlimit != 0 ? ict : fct)->plateau (side.reference ()));
+  else track (side, onright, scanp.isLastScanReversed (), exlimit, ds, disp,
+              p1f, p12, l12, side.referenceStart (), side.referenceEnd (),
+              side.referenceHeight ());
+}
+
+
+void CTrackDetector::collect (const CTrackSide &side, int exlimit)
+{
+  out_count += side.outs ();
+  if (side.status () != RESULT_NONE)
+  {
+    (exlimit != 0 ? ict : fct)->setStatus (side.status ());
+    if (exlimit != 0) istatus = side.status ();
+    else fstatus = side.status ();
+  }
+}
+
+
+void CTrackDetector::track (CTrackSide &side,
+                            bool onright, bool reversed, int exlimit,
                             DirectionalScanner *ds, DirectionalScanner *disp,
                             Pt2f p1f, Vr2f p12, float l12,
                             float refs, float refe, float refh)
@@ -550,6 +554,7 @@ void CTrackDetector::track (bool onright, bool reversed, int exlimit,
   if (onright) exlimit = - exlimit;
   CarriageTrack *ct = (exlimit != 0 ? ict : fct);
   ct->clear (onright);
+  ScanStrip *strip = side.strip ();
   int confdist = 1;
   Pt2i ss_p1, ss_p2;
   getInputStroke (ss_p1, ss_p2, exlimit != 0);
@@ -569,52 +574,41 @@ void CTrackDetector::track (bool onright, bool reversed, int exlimit,
     ds->bindTo (dss_n.x (), dss_n.y (), scan_shift * subdiv + subdiv / 2);
 
     // Collects next scan points and sorts them by distance
-    std::vector<Pt2i> pix;
     std::vector<Pt2i> dispix;
     if ((onright && ! reversed) || (reversed && ! onright))
       disp->nextOnRight (dispix);
     else disp->nextOnLeft (dispix);
+    strip->clear ();
     if (dispix.empty ()) search = false;
-    else
-      for (int i = 0; search && i < subdiv; i++)
-        if ((onright && ! reversed) || (reversed && ! onright))
-        {
-          if (ds->nextOnRight (pix) == 0) search = false;
-        }
-        else if (ds->nextOnLeft (pix) == 0) search = false;
-    if (pix.empty ()) search = false;
+    else if ((onright && ! reversed) || (reversed && ! onright))
+    {
+      if (ds->nextOnRight (*strip, subdiv) != subdiv) search = false;
+    }
+    else if (ds->nextOnLeft (*strip, subdiv) != subdiv) search = false;
+    if (strip->empty ()) search = false;
     else
     {
       std::vector<Pt2f> pts;
-      std::vector<Pt2i>::iterator it = pix.begin ();
-      while (it != pix.end ())
-      {
-        std::vector<Pt3f> ptcl;
-        if (! ptset->collectPoints (ptcl, it->x (), it->y ())) out_count ++;
-        std::vector<Pt3f>::iterator pit = ptcl.begin ();
-        while (pit != ptcl.end ())
-        {
-          Vr2f pcl (pit->x () - p1f.x (), pit->y () - p1f.y ());
-          pts.push_back (Pt2f (pcl.scalarProduct (p12) / l12, pit->z ()));
-          pit ++;
-        }
-        it ++;
-      }
-      sort (pts.begin (), pts.end (), compIFurther);
+      side.addOuts (ptset->collectScanProfile (pts, strip->pixels (),
+                                               p1f, p12, l12));
+      side.sorter ()->sortOnMillimeters (pts);
 
       // Detects the plateau and updates the track section
+      //   (shifted trials share the integer profile of the first one)
+      PlateauProfile *prof = side.profile ();
+      prof->set (pts);
       Plateau *pl = new Plateau (&pfeat, scan_shift);
-      pl->track (pts, refs, refe, refh, 0.0f, confdist);
+      pl->track (pts, *prof, refs, refe, refh, 0.0f, confdist);
       if (pl->getStatus () != Plateau::PLATEAU_RES_OK)
       {
         Plateau *pl2 = new Plateau (&pfeat, scan_shift);
-        pl2->track (pts, refs, refe, refh,
+        pl2->track (pts, *prof, refs, refe, refh,
                     pfeat.plateauSearchDistance (), confdist);
         if (pl2->getStatus () != Plateau::PLATEAU_RES_OK)
         {
           delete pl2;
           Plateau *pl3 = new Plateau (&pfeat, scan_shift);
-          pl3->track (pts, refs, refe, refh,
+          pl3->track (pts, *prof, refs, refe, refh,
                       -pfeat.plateauSearchDistance (), confdist);
           if (pl3->getStatus () != Plateau::PLATEAU_RES_OK)
             delete pl3;
@@ -640,20 +634,14 @@ void CTrackDetector::track (bool onright, bool reversed, int exlimit,
       // no lack count increment otherwise
 
       // Manages start bounds setting
-      if (search && initial_unbounded)
+      if (search && side.unbounded ())
       {
         if (pl->bounded () && pl->isAccepted ())
-        {
-          initial_unbounded = false;
-          initial_refs = pl->internalStart ();
-          initial_refe = pl->internalEnd ();
-        }
+          side.setBounds (pl->internalStart (), pl->internalEnd ());
         else
           if (num == NOBOUNDS_TOLERANCE || num == - NOBOUNDS_TOLERANCE)
           {
-            ct->setStatus (RESULT_FAIL_NO_BOUNDS);
-            if (exlimit != 0) istatus = RESULT_FAIL_NO_BOUNDS;
-            else fstatus = RESULT_FAIL_NO_BOUNDS;
+            side.setStatus (RESULT_FAIL_NO_BOUNDS);
             search = false;
           }
       }
@@ -661,10 +649,10 @@ void CTrackDetector::track (bool onright, bool reversed, int exlimit,
       if (search)
       {
         // Estimates deviation and slope
-        pl->setDeviation (updatePosition (pl->possible (),
-                                          pl->estimatedCenter ()));
-        pl->setSlope (updateHeight (pl->consistentHeight (),
-                                    pl->getMinHeight ()));
+        pl->setDeviation (side.updatePosition (pl->possible (),
+                                               pl->estimatedCenter ()));
+        pl->setSlope (side.updateHeight (pl->consistentHeight (),
+                                         pl->getMinHeight ()));
 
         // Updates reference pattern for next plateau detection
         if (pl->possible ())
@@ -705,7 +693,8 @@ void CTrackDetector::track (bool onright, bool reversed, int exlimit,
 
 
 // AMRELnet version
-void CTrackDetector::track (bool onright, bool reversed, int exlimit,
+void CTrackDetector::track (CTrackSide &side,
+                            bool onright, bool reversed, int exlimit,
                             DirectionalScanner *ds, DirectionalScanner *disp,
                             Pt2f p1f, Vr2f p12, float l12, Plateau *ref)
 {
@@ -715,6 +704,7 @@ void CTrackDetector::track (bool onright, bool reversed, int exlimit,
   if (onright) exlimit = - exlimit;
   CarriageTrack *ct = (exlimit != 0 ? ict : fct);
   ct->clear (onright);
+  ScanStrip *strip = side.strip ();
   int confdist = 1;
   Pt2i ss_p1, ss_p2;
   getInputStroke (ss_p1, ss_p2, exlimit != 0);
@@ -734,42 +724,31 @@ void CTrackDetector::track (bool onright, bool reversed, int exlimit,
     ds->bindTo (dss_n.x (), dss_n.y (), scan_shift * subdiv + subdiv / 2);
 
     // Collects next scan points and sorts them by distance
-    std::vector<Pt2i> pix;
     std::vector<Pt2i> dispix;
     if ((onright && ! reversed) || (reversed && ! onright))
       disp->nextOnRight (dispix);
     else disp->nextOnLeft (dispix);
+    strip->clear ();
     if (dispix.empty ()) search = false;
-    else
-      for (int i = 0; search && i < subdiv; i++)
-        if ((onright && ! reversed) || (reversed && ! onright))
-        {
-          if (ds->nextOnRight (pix) == 0) search = false;
-        }
-        else if (ds->nextOnLeft (pix) == 0) search = false;
-    if (pix.empty ()) search = false;
+    else if ((onright && ! reversed) || (reversed && ! onright))
+    {
+      if (ds->nextOnRight (*strip, subdiv) != subdiv) search = false;
+    }
+    else if (ds->nextOnLeft (*strip, subdiv) != subdiv) search = false;
+    if (strip->empty ()) search = false;
     else
     {
       std::vector<Pt2f> pts;
-      std::vector<Pt2i>::iterator it = pix.begin ();
-      while (it != pix.end ())
-      {
-        std::vector<Pt3f> ptcl;
-        if (! ptset->collectPoints (ptcl, it->x (), it->y ())) out_count ++;
-        std::vector<Pt3f>::iterator pit = ptcl.begin ();
-        while (pit != ptcl.end ())
-        {
-          Vr2f pcl (pit->x () - p1f.x (), pit->y () - p1f.y ());
-          pts.push_back (Pt2f (pcl.scalarProduct (p12) / l12, pit->z ()));
-          pit ++;
-        }
-        it ++;
-      }
+      side.addOuts (ptset->collectScanProfile (pts, strip->pixels (),
+                                               p1f, p12, l12));
 
       // Detects the plateau and updates the track section
+      //   (shifted trials share the integer profile of the first one)
       Plateau *pl = new Plateau (&pfeat, scan_shift);
-      sort (pts.begin (), pts.end (), compIFurther);
-      pl->track (pts, ref, confdist, 0.0f, 0.0f);
+      side.sorter ()->sortOnMillimeters (pts);
+      PlateauProfile *prof = side.profile ();
+      prof->set (pts);
+      pl->track (pts, *prof, ref, confdist, 0.0f, 0.0f);
       if (pl->getStatus () != Plateau::PLATEAU_RES_OK)
       {
         float *retests = new float[NB_SIDE_TRIALS * 2];
@@ -782,7 +761,7 @@ void CTrackDetector::track (bool onright, bool reversed, int exlimit,
         for (int i = 0; tracking && i < NB_SIDE_TRIALS * 2; i++)
         {
           Plateau *pl2 = new Plateau (&pfeat, scan_shift);
-          pl2->track (pts, ref, confdist, retests[i], 0.0f);
+          pl2->track (pts, *prof, ref, confdist, retests[i], 0.0f);
           if (pl2->getStatus () > pl->getStatus ())
           {
             delete pl;
@@ -805,19 +784,14 @@ void CTrackDetector::track (bool onright, bool reversed, int exlimit,
       // no lack count increment otherwise
 
       // Manages start bounds setting
-      if (search && initial_unbounded)
+      if (search && side.unbounded ())
       {
         if (pl->bounded () && pl->isAccepted ())
-        {
-          initial_unbounded = false;
-          initial_ref = num;
-        }
+          side.setBounds (num);
         else
           if (num == NOBOUNDS_TOLERANCE || num == - NOBOUNDS_TOLERANCE)
           {
-            ct->setStatus (RESULT_FAIL_NO_BOUNDS);
-            if (exlimit != 0) istatus = RESULT_FAIL_NO_BOUNDS;
-            else fstatus = RESULT_FAIL_NO_BOUNDS;
+            side.setStatus (RESULT_FAIL_NO_BOUNDS);
             search = false;
           }
       }
@@ -825,10 +799,10 @@ void CTrackDetector::track (bool onright, bool reversed, int exlimit,
       if (search)
       {
         // Estimates deviation and slope
-        pl->setDeviation (updatePosition (pl->possible (),
-                                          pl->estimatedCenter ()));
-        pl->setSlope (updateHeight (pl->consistentHeight (),
-                                    pl->getMinHeight ()));
+        pl->setDeviation (side.updatePosition (pl->possible (),
+                                               pl->estimatedCenter ()));
+        pl->setSlope (side.updateHeight (pl->consistentHeight (),
+                                         pl->getMinHeight ()));
       }
       //if (pl->possible ()) ref = pl;
       ref = pl;
@@ -861,9 +835,7 @@ void CTrackDetector::track (bool onright, bool reversed, int exlimit,
           else
           {
             search = false;
-            ct->setStatus (RESULT_FAIL_DISCONNECT);
-            if (exlimit != 0) istatus = RESULT_FAIL_DISCONNECT;
-            else fstatus = RESULT_FAIL_DISCONNECT;
+            side.setStatus (RESULT_FAIL_DISCONNECT);
           }
         }
         else
@@ -886,9 +858,7 @@ void CTrackDetector::track (bool onright, bool reversed, int exlimit,
         confdist = 1;
         if (! pl->isConnectedTo (ct->plateau (num < 0 ? num + 1 : num - 1)))
         {
-          ct->setStatus (RESULT_FAIL_DISCONNECT);
-          if (exlimit != 0) istatus = RESULT_FAIL_DISCONNECT;
-          else fstatus = RESULT_FAIL_DISCONNECT;
+          side.setStatus (RESULT_FAIL_DISCONNECT);
           search = false;
         }
       }
@@ -902,167 +872,6 @@ void CTrackDetector::track (bool onright, bool reversed, int exlimit,
 }
 
 
-void CTrackDetector::resetRegisters (bool ok, float pos, float ht)
-{
-  for (int i = 0; i < unstab_nb; i++)
-  {
-    spos[i] = 0.0f;
-    epos[i] = 0.0f;
-    spok[i] = false;
-    epok[i] = false;
-  }
-  for (int i = 1; i < posht_nb; i++)
-  {
-    lpok[i] = false;
-    lpos[i] = 0.0f;
-    lhok[i] = false;
-    lht[i] = 0.0f;
-  }
-  lpok[0] = ok;
-  lpos[0] = pos;
-  lhok[0] = ok;
-  lht[0] = ht;
-}
-
-
-float CTrackDetector::updatePosition (bool ok, float pos)
-{
-  int nbok = 0, last = -1, first = -1;
-  for (int i = posht_nb - 1; i > 0; i--)
-  {
-    lpok[i] = lpok[i-1];
-    lpos[i] = lpos[i-1];
-    if (lpok[i])
-    {
-      if (nbok != 0) last = i;
-      else first = i;
-      nbok ++;
-    }
-  }
-  lpok[0] = ok;
-  lpos[0] = pos;
-  if (ok)
-  {
-    if (nbok != 0) last = 0;
-    else first = 0;
-    nbok ++;
-  }
-
-  if (nbok <= 1) return 0.0f;
-  float dtrend = 0.0f, trend = (lpos[last] - lpos[first]) / (first - last);
-  if (nbok == 2) return (trend);
-  int last2 = -1;
-  for (int i = first - 1; i > last; i --)
-  {
-    if (lpok[i])
-    {
-      if (dtrend == 0.0f)
-      {
-        dtrend = (lpos[last] - lpos[i]) / (i - last) - trend;
-        last2 = i;
-      }
-      else if (((lpos[last] - lpos[i]) / (i - last) - trend) * dtrend < 0.0f)
-        return (trend);
-      else last2 = i;
-    }
-  }
-  return ((lpos[last] - lpos[last2]) / (last2 - last));
-}
-
-
-float CTrackDetector::updateHeight (bool ok, float ht)
-{
-  int nbok = 0, last = -1, first = -1;
-  for (int i = posht_nb - 1; i > 0; i--)
-  {
-    lhok[i] = lhok[i-1];
-    lht[i] = lht[i-1];
-    if (lhok[i])
-    {
-      if (nbok != 0) last = i;
-      else first = i;
-      nbok ++;
-    }
-  }
-  lhok[0] = ok;
-  lht[0] = ht;
-  if (ok)
-  {
-    if (nbok != 0) last = 0;
-    else first = 0;
-    nbok ++;
-  }
-
-  if (nbok <= 1) return 0.0f;
-  float dtrend = 0.0f, trend = (lht[last] - lht[first]) / (first - last);
-  if (nbok == 2) return (trend);
-  int last2 = -1;
-  for (int i = first - 1; i > last; i --)
-  {
-    if (lhok[i])
-    {
-      if (dtrend == 0.0f)
-      {
-        dtrend = (lht[last] - lht[i]) / (i - last) - trend;
-        last2 = i;
-      }
-      else if (((lht[last] - lht[i]) / (i - last) - trend) * dtrend < 0.0f)
-        return (trend);
-      else last2 = i;
-    }
-  }
-  return (lht[last] - lht[last2]) / (last2 - last);
-}
-
-
-int CTrackDetector::boundsStability (float slast, float elast,
-                                     bool sok, bool eok, float trw)
-{
-  for (int i = unstab_nb - 1; i > 0; i--)
-  {
-    spos[i] = spos[i-1];
-    epos[i] = epos[i-1];
-    spok[i] = spok[i-1];
-    epok[i] = epok[i-1];
-  }
-  spos[0] = slast;
-  epos[0] = elast;
-  spok[0] = sok;
-  epok[0] = eok;
-
-  if (trw > pfeat.maxLength ())
-  {
-    float spath = 0.0f, epath = 0.0f;
-    int snok = (sok ? 1 : 0), enok = (eok ? 1 : 0);
-    for (int i = unstab_nb - 1; i > 0; i--)
-    {
-      spath += spos[i-1] < spos[i] ? spos[i] - spos[i-1] : spos[i-1] - spos[i];
-      epath += epos[i-1] < epos[i] ? epos[i] - epos[i-1] : epos[i-1] - epos[i];
-      if (spok[i]) snok ++;
-      if (epok[i]) enok ++;
-    }
-    if (spath - epath > LN_UNSTAB * unstab_nb) return -1;
-    if (epath - spath > LN_UNSTAB * unstab_nb) return 1;
-  }
-  return 0;
-}
-
-
-bool CTrackDetector::compIFurther (Pt2f p1, Pt2f p2)
-{
-  return (floor (p2.x () * 1000) > floor (p1.x () * 1000)
-          || (floor (p2.x () * 1000) == floor (p1.x () * 1000)
-              && floor (p2.y () * 1000) > floor (p1.y () * 1000)));
-}
-
-bool CTrackDetector::compLFurther (Pt3f p1, Pt3f p2)
-{
-  return (floor (p2.x () * 1000) > floor (p1.x () * 1000)
-          || (floor (p2.x () * 1000) == floor (p1.x () * 1000)
-              && floor (p2.y () * 1000) > floor (p1.y () * 1000)));
-}
-
-
 void CTrackDetector::incPlateauLackTolerance (int dir)
 {
   setPlateauLackTolerance (plateau_lack_tolerance + dir);
@@ -1230,7 +1039,7 @@ void CTrackDetector::labelPoints (CarriageTrack *ct)
     a = -a;
     b = -b;
   }
-  DirectionalScanner *ds = scanp.getScanner (
+  DirectionalScanner *ds = scanp.getScanner (scan_holder,
     Pt2i (ctp1.x () * subdiv + subdiv / 2, ctp1.y () * subdiv + subdiv / 2),
     Pt2i (ctp2.x () * subdiv + subdiv / 2, ctp2.y () * subdiv + subdiv / 2),
     true);
@@ -1267,7 +1076,7 @@ void CTrackDetector::labelPoints (CarriageTrack *ct)
       }
       it ++;
     }
-    sort (cpts.begin (), cpts.end (), compLFurther);
+    psorter.sortOnMillimeters (cpts);
     int s_num = pl->startIndex (), e_num = pl->endIndex ();
     if ((int) cpts.size () > e_num)
     {
@@ -1286,20 +1095,23 @@ void CTrackDetector::labelPoints (CarriageTrack *ct)
   {
     Plateau *pl = ct->plateau (i);
     ds->bindTo (a, b, pl->scanShift () * subdiv + subdiv / 2);
-    std::vector<Pt2i> pix;
-    for (int i = 0; search && i < subdiv; i++)
+    scan_strip.clear ();
+    if (search)
+    {
       if (scanp.isLastScanReversed ())
       {
-        if (ds->nextOnLeft (pix) == 0) search = false;
+        if (ds->nextOnLeft (scan_strip, subdiv) != subdiv) search = false;
       }
-      else if (ds->nextOnRight (pix) == 0) search = false;
+      else if (ds->nextOnRight (scan_strip, subdiv) != subdiv) search = false;
+    }
+    const std::vector<Pt2i> &pix = scan_strip.pixels ();
 
     if (pl->isAccepted ())
     {
       std::vector<Pt3f> cpts;
       std::vector<int> tls;
       std::vector<int> lbs;
-      std::vector<Pt2i>::iterator it = pix.begin ();
+      std::vector<Pt2i>::const_iterator it = pix.begin ();
       int labind = 0;
       while (it != pix.end ())
       {
@@ -1316,7 +1128,7 @@ void CTrackDetector::labelPoints (CarriageTrack *ct)
         }
         it ++;
       }
-      sort (cpts.begin (), cpts.end (), compLFurther);
+      psorter.sortOnMillimeters (cpts);
       int s_num = pl->startIndex (), e_num = pl->endIndex ();
       if ((int) cpts.size () > e_num)
       {
@@ -1336,20 +1148,23 @@ void CTrackDetector::labelPoints (CarriageTrack *ct)
   {
     Plateau *pl = ct->plateau (i);
     ds->bindTo (a, b, pl->scanShift () * subdiv + subdiv / 2);
-    std::vector<Pt2i> pix;
-    for (int i = 0; search && i < subdiv; i++)
+    scan_strip.clear ();
+    if (search)
+    {
       if (scanp.isLastScanReversed ())
       {
-        if (ds->nextOnRight (pix) == 0) search = false;
+        if (ds->nextOnRight (scan_strip, subdiv) != subdiv) search = false;
       }
-      else if (ds->nextOnLeft (pix) == 0) search = false;
+      else if (ds->nextOnLeft (scan_strip, subdiv) != subdiv) search = false;
+    }
+    const std::vector<Pt2i> &pix = scan_strip.pixels ();
 
     if (pl->isAccepted ())
     {
       std::vector<Pt3f> cpts;
       std::vector<int> tls;
       std::vector<int> lbs;
-      std::vector<Pt2i>::iterator it = pix.begin ();
+      std::vector<Pt2i>::const_iterator it = pix.begin ();
       int labind = 0;
       while (it != pix.end ())
       {
@@ -1366,7 +1181,7 @@ void CTrackDetector::labelPoints (CarriageTrack *ct)
         }
         it ++;
       }
-      sort (cpts.begin (), cpts.end (), compLFurther);
+      psorter.sortOnMillimeters (cpts);
       int s_num = pl->startIndex (), e_num = pl->endIndex ();
       if ((int) cpts.size () > e_num)
       {
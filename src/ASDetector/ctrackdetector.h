@@ -26,7 +26,9 @@
 #define CARRIAGE_TRACK_DETECTOR_H
 
 #include "carriagetrack.h"
+#include "ctrackside.h"
 #include "ipttileset.h"
+#include "profilesorter.h"
 #include "scannerprovider.h"
 
 
@@ -87,6 +89,20 @@ public:
    */
   void clear ();
 
+  /**
+   * \brief Sets the points grid and all detection settings of another
+   *   detector, so that both detectors may run concurrently on this grid.
+   * Detected features and former detection context are not copied.
+   * @param det Detector to imitate.
+   */
+  void copySettings (const CTrackDetector &det);
+
+  /**
+   * \brief Forgets the central plateau bounds found in former detections.
+   * Next detection no more depends on previously processed strokes.
+   */
+  inline void forgetFormerBounds () { initial_unbounded = true; }
+
   /**
    * \brief Avoids former detection clearance.
    */
@@ -272,6 +288,17 @@ public:
   inline void switchDensitySensitivity () {
     density_insensitive = ! density_insensitive; }
 
+  /**
+   * \brief Indicates whether scan profiles are radix sorted (or std::sort).
+   */
+  inline bool isRadixSorting () const { return psorter.isRadixOn (); }
+
+  /**
+   * \brief Switches scan profiles sort between radix sort and std::sort.
+   */
+  inline void switchRadixSorting () {
+    psorter.setRadix (! psorter.isRadixOn ()); }
+
   /**
    * \brief Returns the DTM cell size.
    */
@@ -298,18 +325,10 @@ private :
   static const int NOBOUNDS_TOLERANCE;
   /** Initial track extent on each side of the central plateau. */
   static const int INITIAL_TRACK_EXTENT;
-  /** Default count of registered center positions and heights. */
-  static const int DEFAULT_POS_AND_HEIGHT_REGISTER_SIZE;
-  /** Default count of registered bound positions and consistencies. */
-  static const int DEFAULT_UNSTABILITY_REGISTER_SIZE;
   /** Default plateau density percentage required to validate a track. */
   static const int DEFAULT_MIN_DENSITY;
   /** Default maximal value for accepted absolute shift length. */
   static const float DEFAULT_MAX_SHIFT_LENGTH;
-  /** Default deviation offset for bounds unstability checking. */
-  static const float LN_UNSTAB;
-  /** Default unconsistency offset for bounds unstability checking. */
-  static const int NB_UNSTAB;
   /** Position increment for test settings. */
   static const float POS_INCR;
   /** Amount of side trials in automatic mode. */
@@ -317,6 +336,24 @@ private :
 
   /** Points grid. */
   IPtTileSet *ptset;
+  /** Scan profile sorter. */
+  ProfileSorter psorter;
+  /** Memory arena of the objects created during a detection. */
+  ObjectArena arena;
+  /** Point cloud scanner storage for the first tracked side. */
+  ScannerHolder scan_holder;
+  /** Point cloud scanner storage for the second tracked side. */
+  ScannerHolder scan_holder2;
+  /** Display scanner storage for the first tracked side. */
+  ScannerHolder disp_holder;
+  /** Display scanner storage for the second tracked side. */
+  ScannerHolder disp_holder2;
+  /** Point cloud scanner storage for a second side tracking restart. */
+  ScannerHolder scan_holder3;
+  /** Display scanner storage for a second side tracking restart. */
+  ScannerHolder disp_holder3;
+  /** Point cloud scans gathered for one display scan. */
+  ScanStrip scan_strip;
   /** Cloud grid / Dtm grid ratio. */
   int subdiv;
   /** DTM cell size: pixel to cloud point (meter) ratio. */
@@ -366,36 +403,12 @@ private :
   /** Initial stroke second input point in DTM pixels. */
   Pt2i ip2;
 
-  /** Position and height register size. */
-  int posht_nb;
-  /** Last position reliabilities. */
-  bool *lpok;
-  /** Last position values. */
-  float *lpos;
-  /** Last height reliabilities. */
-  bool *lhok;
-  /** Last height values. */
-  float *lht;
-  /** Initially found reference plateau number. */
-  int initial_ref;
-  /** Initially found reference start position. */
-  float initial_refs;
-  /** Initially found reference end position. */
-  float initial_refe;
-  /** Initially found reference height. */
-  float initial_refh;
   /** Fine bounds detected at initial step. */
   bool initial_unbounded;
-  /** Bounds stability register size. */
-  int unstab_nb;
-  /** Last start position values. */
-  float *spos;
-  /** Last end position values. */
-  float *epos;
-  /** Last start position consistency status. */
-  bool *spok;
-  /** Last end position consistency status. */
-  bool *epok;
+  /** Tracking context of the first side (on the right). */
+  CTrackSide rside;
+  /** Tracking context of the second side (on the left). */
+  CTrackSide lside;
 
   int out_count;
 
@@ -411,8 +424,52 @@ private :
    */
   void detect ();
 
+  /**
+   * \brief Tracks plateaux on both sides of the central plateau.
+   * Sides are tracked concurrently. When fine bounds are still to be found,
+   *   a side is tracked again if the other one provides them, as it would
+   *   in a side by side tracking.
+   * @param cpl Central plateau.
+   * @param netbuild Indicates whether road network version is used.
+   * @param exlimit Limit of plateaux extension.
+   * @param ds Directional scanner used for detection.
+   * @param disp Directional scanner used for display.
+   * @param p1f Input reference point (in meters).
+   * @param p12 Input stroke vector (in meters).
+   * @param l12 Reference stroke length (in meters).
+   */
+  void trackSides (Plateau *cpl, bool netbuild, int exlimit,
+                   DirectionalScanner *ds, DirectionalScanner *disp,
+                   Pt2f p1f, Vr2f p12, float l12);
+
+  /**
+   * \brief Tracks plateaux on one side of the central plateau.
+   * @param side Side tracking context.
+   * @param cpl Central plateau.
+   * @param onright Extension direction.
+   * @param netbuild Indicates whether road network version is used.
+   * @param exlimit Limit of plateaux extension.
+   * @param ds Directional scanner used for detection.
+   * @param disp Directional scanner used for display.
+   * @param p1f Input reference point (in meters).
+   * @param p12 Input stroke vector (in meters).
+   * @param l12 Reference stroke length (in meters).
+   */
+  void trackSide (CTrackSide &side, Plateau *cpl, bool onright,
+                  bool netbuild, int exlimit,
+                  DirectionalScanner *ds, DirectionalScanner *disp,
+                  Pt2f p1f, Vr2f p12, float l12);
+
+  /**
+   * \brief Reports the status and out counts of a side tracking.
+   * @param side Side tracking context.
+   * @param exlimit Limit of plateaux extension.
+   */
+  void collect (const CTrackSide &side, int exlimit);
+
   /**
    * \brief Performs a carriage track detection.
+   * @param side Side tracking context.
    * @param onright Extension direction.
    * @param reversed Indicates whether scans are reversed.
    * @param exlimit Limit of plateaux extension.
@@ -425,7 +482,7 @@ private :
    * @param refe Template end position.
    * @param refh Template lower height.
    */
-  void track (bool onright, bool reversed, int exlimit,
+  void track (CTrackSide &side, bool onright, bool reversed, int exlimit,
               DirectionalScanner *ds, DirectionalScanner *disp,
               Pt2f p1f, Vr2f p12, float l12,
               float refs, float refe, float refh);
@@ -434,6 +491,7 @@ private :
    * \brief Performs a on carriage track detection.
    * Ensures connexity between adjacent plateaux.
    * Specific version for road network extraction.
+   * @param side Side tracking context.
    * @param onright Extension direction.
    * @param reversed Indicates whether scans are reversed.
    * @param exlimit Limit of plateaux extension.
@@ -444,61 +502,10 @@ private :
    * @param l12 Reference stroke length (in meters).
    * @param ref Reference plateau.
    */
-  void track (bool onright, bool reversed, int exlimit,
+  void track (CTrackSide &side, bool onright, bool reversed, int exlimit,
               DirectionalScanner *ds, DirectionalScanner *disp,
               Pt2f p1f, Vr2f p12, float l12, Plateau *ref);
 
-  /**
-   * \brief Resets bounds and center position and height registers.
-   * @param ok Last position and height reliability.
-   * @param pos Last position value.
-   * @param ht Last height value.
-   */
-  void resetRegisters (bool ok = false, float pos = 0.0f, float ht = 0.0f);
-
-  /**
-   * \brief Sets the last position and returns estimated deviation.
-   * @param ok Last position reliability.
-   * @param pos Last position value if reliable.
-   */
-  float updatePosition (bool ok, float pos = 0.0f);
-
-  /**
-   * \brief Sets the last height and returns estimated slope.
-   * @param ok Last height reliability.
-   * @param ht Last height value if reliable.
-   */
-  float updateHeight (bool ok, float ht = 0.0f);
-
-  /**
-   * \brief Registers bounds positions and estimate bounds stability.
-   * Returns 1 if start bound is much more stable than end bound,
-   *         -1 if end bound is much more stable than start bound,
-   *         0 in any other cases.
-   * @param slat Last start bound position.
-   * @param elat Last end bound position.
-   * @param sok Last start bound consistency status.
-   * @param eok Last end bound consistency status.
-   * @param trw Track estimated width.
-   */
-  int boundsStability (float slast, float elast,
-                       bool sok, bool eok, float trw);
-
-  /**
-   * \brief Compares points by distance to scan bound on integer basis.
-   * @param p1 First point.
-   * @param p2 Second point.
-   */
-  static bool compIFurther (Pt2f p1, Pt2f p2);
-
-  /**
-   * \brief Compares labelled points by distance to scan bound on integer basis.
-   * The third dimension is used for the label.
-   * @param p1 First point.
-   * @param p2 Second point.
-   */
-  static bool compLFurther (Pt3f p1, Pt3f p2);
-
   /**
    * \brief Aligns input stroke on detected track points.
    * @param pts Central points of carriage track plateaux.
@@ -28,6 +28,7 @@
 #include "plateau.h"
 #include "pt2i.h"
 #include "pt2f.h"
+#include "objectarena.h"
 #include <cstddef>
 
 
@@ -35,7 +36,7 @@
  * @class CTrackSection ctracksection.h
  * \brief Carriage track section.
  */
-class CTrackSection
+class CTrackSection : public ArenaObject
 {
 public:
 
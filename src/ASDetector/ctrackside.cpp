@@ -0,0 +1,254 @@
+/*  Copyright 2021 Philippe Even and Phuc Ngo,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+#include "ctrackside.h"
+
+const int CTrackSide::DEFAULT_POS_AND_HEIGHT_REGISTER_SIZE = 8;
+const int CTrackSide::DEFAULT_UNSTABILITY_REGISTER_SIZE = 6;
+const float CTrackSide::LN_UNSTAB = 0.25f;
+const int CTrackSide::NB_UNSTAB = 2;
+
+
+CTrackSide::CTrackSide ()
+{
+  ref_num = 0;
+  ref_start = 0.0f;
+  ref_end = 0.0f;
+  ref_height = 0.0f;
+  ref_unbounded = true;
+  res_status = 0;
+  out_count = 0;
+  posht_nb = DEFAULT_POS_AND_HEIGHT_REGISTER_SIZE;
+  lpok = new bool[posht_nb];
+  lpos = new float[posht_nb];
+  lhok = new bool[posht_nb];
+  lht = new float[posht_nb];
+  unstab_nb = DEFAULT_UNSTABILITY_REGISTER_SIZE;
+  spos = new float[unstab_nb];
+  epos = new float[unstab_nb];
+  spok = new bool[unstab_nb];
+  epok = new bool[unstab_nb];
+  resetRegisters ();
+}
+
+
+CTrackSide::~CTrackSide ()
+{
+  delete [] lpok;
+  delete [] lpos;
+  delete [] lhok;
+  delete [] lht;
+  delete [] spos;
+  delete [] epos;
+  delete [] spok;
+  delete [] epok;
+}
+
+
+void CTrackSide::setReference (bool unbounded, int ref,
+                               float refs, float refe, float refh)
+{
+  ref_unbounded = unbounded;
+  ref_num = ref;
+  ref_start = refs;
+  ref_end = refe;
+  ref_height = refh;
+}
+
+
+void CTrackSide::setReference (const CTrackSide &side)
+{
+  setReference (side.ref_unbounded, side.ref_num,
+                side.ref_start, side.ref_end, side.ref_height);
+}
+
+
+void CTrackSide::setBounds (float refs, float refe)
+{
+  ref_unbounded = false;
+  ref_start = refs;
+  ref_end = refe;
+}
+
+
+void CTrackSide::setBounds (int ref)
+{
+  ref_unbounded = false;
+  ref_num = ref;
+}
+
+
+void CTrackSide::restart ()
+{
+  res_status = 0;
+  out_count = 0;
+}
+
+
+void CTrackSide::resetRegisters (bool ok, float pos, float ht)
+{
+  for (int i = 0; i < unstab_nb; i++)
+  {
+    spos[i] = 0.0f;
+    epos[i] = 0.0f;
+    spok[i] = false;
+    epok[i] = false;
+  }
+  for (int i = 1; i < posht_nb; i++)
+  {
+    lpok[i] = false;
+    lpos[i] = 0.0f;
+    lhok[i] = false;
+    lht[i] = 0.0f;
+  }
+  lpok[0] = ok;
+  lpos[0] = pos;
+  lhok[0] = ok;
+  lht[0] = ht;
+}
+
+
+float CTrackSide::updatePosition (bool ok, float pos)
+{
+  int nbok = 0, last = -1, first = -1;
+  for (int i = posht_nb - 1; i > 0; i--)
+  {
+    lpok[i] = lpok[i-1];
+    lpos[i] = lpos[i-1];
+    if (lpok[i])
+    {
+      if (nbok != 0) last = i;
+      else first = i;
+      nbok ++;
+    }
+  }
+  lpok[0] = ok;
+  lpos[0] = pos;
+  if (ok)
+  {
+    if (nbok != 0) last = 0;
+    else first = 0;
+    nbok ++;
+  }
+
+  if (nbok <= 1) return 0.0f;
+  float dtrend = 0.0f, trend = (lpos[last] - lpos[first]) / (first - last);
+  if (nbok == 2) return (trend);
+  int last2 = -1;
+  for (int i = first - 1; i > last; i --)
+  {
+    if (lpok[i])
+    {
+      if (dtrend == 0.0f)
+      {
+        dtrend = (lpos[last] - lpos[i]) / (i - last) - trend;
+        last2 = i;
+      }
+      else if (((lpos[last] - lpos[i]) / (i - last) - trend) * dtrend < 0.0f)
+        return (trend);
+      else last2 = i;
+    }
+  }
+  return ((lpos[last] - lpos[last2]) / (last2 - last));
+}
+
+
+float CTrackSide::updateHeight (bool ok, float ht)
+{
+  int nbok = 0, last = -1, first = -1;
+  for (int i = posht_nb - 1; i > 0; i--)
+  {
+    lhok[i] = lhok[i-1];
+    lht[i] = lht[i-1];
+    if (lhok[i])
+    {
+      if (nbok != 0) last = i;
+      else first = i;
+      nbok ++;
+    }
+  }
+  lhok[0] = ok;
+  lht[0] = ht;
+  if (ok)
+  {
+    if (nbok != 0) last = 0;
+    else first = 0;
+    nbok ++;
+  }
+
+  if (nbok <= 1) return 0.0f;
+  float dtrend = 0.0f, trend = (lht[last] - lht[first]) / (first - last);
+  if (nbok == 2) return (trend);
+  int last2 = -1;
+  for (int i = first - 1; i > last; i --)
+  {
+    if (lhok[i])
+    {
+      if (dtrend == 0.0f)
+      {
+        dtrend = (lht[last] - lht[i]) / (i - last) - trend;
+        last2 = i;
+      }
+      else if (((lht[last] - lht[i]) / (i - last) - trend) * dtrend < 0.0f)
+        return (trend);
+      else last2 = i;
+    }
+  }
+  return (lht[last] - lht[last2]) / (last2 - last);
+}
+
+
+int CTrackSide::boundsStability (float slast, float elast,
+                                 bool sok, bool eok, float trw, float maxw)
+{
+  for (int i = unstab_nb - 1; i > 0; i--)
+  {
+    spos[i] = spos[i-1];
+    epos[i] = epos[i-1];
+    spok[i] = spok[i-1];
+    epok[i] = epok[i-1];
+  }
+  spos[0] = slast;
+  epos[0] = elast;
+  spok[0] = sok;
+  epok[0] = eok;
+
+  if (trw > maxw)
+  {
+    float spath = 0.0f, epath = 0.0f;
+    int snok = (sok ? 1 : 0), enok = (eok ? 1 : 0);
+    for (int i = unstab_nb - 1; i > 0; i--)
+    {
+      spath += spos[i-1] < spos[i] ? spos[i] - spos[i-1] : spos[i-1] - spos[i];
+      epath += epos[i-1] < epos[i] ? epos[i] - epos[i-1] : epos[i-1] - epos[i];
+      if (spok[i]) snok ++;
+      if (epok[i]) enok ++;
+    }
+    if (spath - epath > LN_UNSTAB * unstab_nb) return -1;
+    if (epath - spath > LN_UNSTAB * unstab_nb) return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,263 @@
+/*  Copyright 2021 Philippe Even and Phuc Ngo,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef CTRACK_SIDE_H
+#define CTRACK_SIDE_H
+
+#include "profilesorter.h"
+#include "scanstrip.h"
+#include "plateauprofile.h"
+#include "objectarena.h"
+
+
+/** 
+ * @class CTrackSide ctrackside.h
+ * \brief Tracking context of one side of a carriage track detection.
+ * Holds all the data modified while tracking plateaux on one side of the
+ *   central plateau, so that both sides can be tracked concurrently.
+ */
+class CTrackSide
+{
+public:
+
+  /**
+   * \brief Creates a side tracking context.
+   */
+  CTrackSide ();
+
+  /**
+   * \brief Deletes the side tracking context.
+   */
+  ~CTrackSide ();
+
+  /**
+   * \brief Sets the start reference of the tracking.
+   * @param unbounded Indicates whether fine bounds are still to be found.
+   * @param ref Reference plateau number.
+   * @param refs Reference start position.
+   * @param refe Reference end position.
+   * @param refh Reference height.
+   */
+  void setReference (bool unbounded, int ref,
+                     float refs, float refe, float refh);
+
+  /**
+   * \brief Sets the start reference of the tracking from another side.
+   * @param side Side context providing the reference.
+   */
+  void setReference (const CTrackSide &side);
+
+  /**
+   * \brief Sets the fine bounds found on this side.
+   * @param refs Reference start position.
+   * @param refe Reference end position.
+   */
+  void setBounds (float refs, float refe);
+
+  /**
+   * \brief Sets the bounded reference plateau found on this side.
+   * @param ref Reference plateau number.
+   */
+  void setBounds (int ref);
+
+  /**
+   * \brief Indicates whether fine bounds are still to be found.
+   */
+  inline bool unbounded () const { return ref_unbounded; }
+
+  /**
+   * \brief Returns the reference plateau number.
+   */
+  inline int reference () const { return ref_num; }
+
+  /**
+   * \brief Returns the reference start position.
+   */
+  inline float referenceStart () const { return ref_start; }
+
+  /**
+   * \brief Returns the reference end position.
+   */
+  inline float referenceEnd () const { return ref_end; }
+
+  /**
+   * \brief Returns the reference height.
+   */
+  inline float referenceHeight () const { return ref_height; }
+
+  /**
+   * \brief Resets tracking status and count of points out of loaded tiles.
+   */
+  void restart ();
+
+  /**
+   * \brief Returns the last failure status of the tracking (or 0).
+   */
+  inline int status () const { return res_status; }
+
+  /**
+   * \brief Sets the failure status of the tracking.
+   * @param status Failure status.
+   */
+  inline void setStatus (int status) { res_status = status; }
+
+  /**
+   * \brief Returns the count of scanned cells out of loaded tiles.
+   */
+  inline int outs () const { return out_count; }
+
+  /**
+   * \brief Adds scanned cells out of loaded tiles.
+   * @param nb Count of cells to add.
+   */
+  inline void addOuts (int nb) { out_count += nb; }
+
+  /**
+   * \brief Returns the scan profile sorter of the side.
+   */
+  inline ProfileSorter *sorter () { return &psorter; }
+
+  /**
+   * \brief Returns the point cloud scan strip of the side.
+   */
+  inline ScanStrip *strip () { return &scan_strip; }
+
+  /**
+   * \brief Returns the integer scan profile shared by plateau trials.
+   */
+  inline PlateauProfile *profile () { return &iprof; }
+
+  /**
+   * \brief Returns the memory arena of the objects created on the side.
+   */
+  inline ObjectArena *arena () { return &side_arena; }
+
+  /**
+   * \brief Resets bounds and center position and height registers.
+   * @param ok Last position and height reliability.
+   * @param pos Last position value.
+   * @param ht Last height value.
+   */
+  void resetRegisters (bool ok = false, float pos = 0.0f, float ht = 0.0f);
+
+  /**
+   * \brief Sets the last position and returns estimated deviation.
+   * @param ok Last position reliability.
+   * @param pos Last position value if reliable.
+   */
+  float updatePosition (bool ok, float pos = 0.0f);
+
+  /**
+   * \brief Sets the last height and returns estimated slope.
+   * @param ok Last height reliability.
+   * @param ht Last height value if reliable.
+   */
+  float updateHeight (bool ok, float ht = 0.0f);
+
+  /**
+   * \brief Registers bounds positions and estimate bounds stability.
+   * Returns 1 if start bound is much more stable than end bound,
+   *         -1 if end bound is much more stable than start bound,
+   *         0 in any other cases.
+   * @param slat Last start bound position.
+   * @param elat Last end bound position.
+   * @param sok Last start bound consistency status.
+   * @param eok Last end bound consistency status.
+   * @param trw Track estimated width.
+   * @param maxw Maximal plateau width.
+   */
+  int boundsStability (float slast, float elast,
+                       bool sok, bool eok, float trw, float maxw);
+
+
+private:
+
+  /** Default count of registered center positions and heights. */
+  static const int DEFAULT_POS_AND_HEIGHT_REGISTER_SIZE;
+  /** Default count of registered bound positions and consistencies. */
+  static const int DEFAULT_UNSTABILITY_REGISTER_SIZE;
+  /** Default deviation offset for bounds unstability checking. */
+  static const float LN_UNSTAB;
+  /** Default unconsistency offset for bounds unstability checking. */
+  static const int NB_UNSTAB;
+
+  /** Reference plateau number. */
+  int ref_num;
+  /** Reference start position. */
+  float ref_start;
+  /** Reference end position. */
+  float ref_end;
+  /** Reference height. */
+  float ref_height;
+  /** Fine bounds still to be found. */
+  bool ref_unbounded;
+  /** Last failure status of the tracking. */
+  int res_status;
+  /** Count of scanned cells out of loaded tiles. */
+  int out_count;
+
+  /** Scan profile sorter. */
+  ProfileSorter psorter;
+  /** Point cloud scans gathered for one display scan. */
+  ScanStrip scan_strip;
+  /** Integer scan profile shared by plateau tracking trials. */
+  PlateauProfile iprof;
+  /** Memory arena of the objects created on the side. */
+  ObjectArena side_arena;
+
+  /** Position and height register size. */
+  int posht_nb;
+  /** Last position reliabilities. */
+  bool *lpok;
+  /** Last position values. */
+  float *lpos;
+  /** Last height reliabilities. */
+  bool *lhok;
+  /** Last height values. */
+  float *lht;
+  /** Bounds stability register size. */
+  int unstab_nb;
+  /** Last start position values. */
+  float *spos;
+  /** Last end position values. */
+  float *epos;
+  /** Last start position consistency status. */
+  bool *spok;
+  /** Last end position consistency status. */
+  bool *epok;
+
+
+  /**
+   * \brief Forbids side context copy.
+   */
+  CTrackSide (const CTrackSide &);
+
+  /**
+   * \brief Forbids side context assignment.
+   */
+  CTrackSide &operator= (const CTrackSide &);
+};
+#endif
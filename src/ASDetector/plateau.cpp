@@ -42,6 +42,8 @@ const int Plateau::PLATEAU_RES_TOO_LARGE_NARROWING = -12;
 const int Plateau::PLATEAU_RES_TOO_NARROW = -13;
 const int Plateau::PLATEAU_RES_OUT_OF_HEIGHT_REF = -14;
 
+const int Plateau::HEIGHT_BINS = 16;
+
 
 Plateau::Plateau (PlateauModel *pmod, int ct_shift)
 {
@@ -90,34 +92,33 @@ bool Plateau::detect (const std::vector<Pt2f> &ptsh, bool all, float exh)
   }
 
   // Detects height interval with the highest number of impacts
-  std::vector<Pt2f> ptsv (ptsh);
-  sort (ptsv.begin (), ptsv.end (), compHigher);
+  static thread_local std::vector<float> hts;
+  sortHeights (ptsh, hts);
 
-  std::vector<Pt2f>::iterator it = ptsv.begin ();
+  std::vector<float>::iterator it = hts.begin ();
   int nbhmax = 1;
   int nbh = 1;
-  float meanh = it->y ();
+  float meanh = *it;
   float exhh = exh + 2 * pmod->thicknessTolerance ();
-  std::vector<Pt2f>::iterator itmin = it;
-  while (it != ptsv.end ())
+  std::vector<float>::iterator itmin = it;
+  while (it != hts.end ())
   {
-    if (all || it->y () < exh || it->y () >= exhh) nbh ++;
-    if (it->y () - itmin->y () > pmod->thicknessTolerance ())
+    if (all || *it < exh || *it >= exhh) nbh ++;
+    if (*it - *itmin > pmod->thicknessTolerance ())
     {
       do
       {
         itmin ++;
-        if (all || itmin->y () < exh || itmin->y () >= exhh) nbh --;
+        if (all || *itmin < exh || *itmin >= exhh) nbh --;
       }
-      while (itmin != it
-             && it->y () - itmin->y () > pmod->thicknessTolerance ());
+      while (itmin != it && *it - *itmin > pmod->thicknessTolerance ());
     }
     else
     {
       if (nbh > nbhmax)
       {
         nbhmax = nbh;
-        meanh = itmin->y ();
+        meanh = *itmin;
       }
     }
     it ++;
@@ -247,6 +248,17 @@ bool Plateau::detect (const std::vector<Pt2f> &ptsh, bool all, float exh)
 bool Plateau::track (const std::vector<Pt2f> &ptsh,
                      float lstart, float lend, float lheight,
                      float cshift, int confdist)
+{
+  PlateauProfile prof;
+  prof.set (ptsh);
+  return (track (ptsh, prof, lstart, lend, lheight, cshift, confdist));
+}
+
+
+bool Plateau::track (const std::vector<Pt2f> &ptsh,
+                     const PlateauProfile &prof,
+                     float lstart, float lend, float lheight,
+                     float cshift, int confdist)
 {
   // Updates assigned reference pattern
   s_ref = lstart;
@@ -279,30 +291,13 @@ bool Plateau::track (const std::vector<Pt2f> &ptsh,
   }
   int lpt = (int) (ptsh.size ()) - 1;
 
-  // Translates to int and finds start point
+  // Finds start point in the integer profile
   float lcenter = (lstart + lend) / 2 + cshift;
   int icenter = (int) (lcenter * 1000 + (lcenter < 0 ? - 0.5f : 0.5f));
-  int ifirst = 0;
-  int i = 0;
-  bool searching = true;
-  std::vector<Pt2i> ptsi;
-  std::vector<Pt2f>::const_iterator it = ptsh.begin ();
-  locheight = it->y ();
-  while (it != ptsh.end ())
-  {
-    int x = floor (it->x () * 1000);
-    if (searching && x > icenter)
-    {
-      searching = false;
-      if (i == 0) ifirst = 0;
-      else if (x - icenter > icenter - ptsi.back().x ()) ifirst = i - 1;
-      else ifirst = i;
-    }
-    ptsi.push_back (Pt2i (x, floor ((it->y () - locheight) * 1000)));
-    i ++;
-    it ++;
-  }
-  int myend = i;
+  const std::vector<Pt2i> &ptsi = prof.points ();
+  locheight = prof.baseHeight ();
+  int ifirst = prof.startIndex (icenter);
+  int myend = (int) (ptsi.size ());
 
   // Checks the reference height
   if ((confdist != 0)
@@ -497,6 +492,16 @@ bool Plateau::track (const std::vector<Pt2f> &ptsh,
 // AMRELnet version
 bool Plateau::track (const std::vector<Pt2f> &ptsh, Plateau *refp,
                      int confdist, float cshift, float l12)
+{
+  PlateauProfile prof;
+  prof.set (ptsh);
+  return (track (ptsh, prof, refp, confdist, cshift, l12));
+}
+
+
+bool Plateau::track (const std::vector<Pt2f> &ptsh,
+                     const PlateauProfile &prof, Plateau *refp,
+                     int confdist, float cshift, float l12)
 {
   if (confdist == 0)
   {
@@ -673,30 +678,13 @@ bool Plateau::track (const std::vector<Pt2f> &ptsh, Plateau *refp,
     return false;
   }
 
-  // Translates to int and finds start point
+  // Finds start point in the integer profile
   float lcenter = (s_est + e_est) / 2 + cshift;
   int icenter = (int) (lcenter * 1000 + 0.5f);
-  int ifirst = 0;
-  int i = 0;
-  bool searching = true;
-  std::vector<Pt2i> ptsi;
-  std::vector<Pt2f>::const_iterator it = ptsh.begin ();
-  locheight = it->y ();
-  while (it != ptsh.end ())
-  {
-    int x = floor (it->x () * 1000);
-    if (searching && x > icenter)
-    {
-      searching = false;
-      if (i == 0) ifirst = 0;
-      else if (x - icenter > icenter - ptsi.back().x ()) ifirst = i - 1;
-      else ifirst = i;
-    }
-    ptsi.push_back (Pt2i (x, floor ((it->y () - locheight) * 1000)));
-    i ++;
-    it ++;
-  }
-  int myend = i;
+  const std::vector<Pt2i> &ptsi = prof.points ();
+  locheight = prof.baseHeight ();
+  int ifirst = prof.startIndex (icenter);
+  int myend = (int) (ptsi.size ());
 
   // Checks the reference height
   if ((confdist != 0)
@@ -1167,9 +1155,63 @@ Pt2f Plateau::getDSSend () const
 }
 
 
-bool Plateau::compHigher (Pt2f p1, Pt2f p2)
+void Plateau::sortHeights (const std::vector<Pt2f> &ptsh,
+                           std::vector<float> &hts) const
 {
-  return (p2.y () > p1.y ());
+  int nb = (int) (ptsh.size ());
+  float hlow = ptsh[0].y (), hhigh = hlow;
+  std::vector<Pt2f>::const_iterator pit = ptsh.begin ();
+  while (pit != ptsh.end ())
+  {
+    if (pit->y () < hlow) hlow = pit->y ();
+    else if (pit->y () > hhigh) hhigh = pit->y ();
+    pit ++;
+  }
+
+  // Bins are thickness tolerance fractions, at most two per point
+  float bw = pmod->thicknessTolerance () / HEIGHT_BINS;
+  int nbins = 1;
+  if (hhigh > hlow && bw > 0.0f)
+  {
+    float span = (hhigh - hlow) / bw;
+    if (span >= 2 * nb) bw = (hhigh - hlow) / (2 * nb - 1);
+    nbins = (span >= 2 * nb ? 2 * nb : 1 + (int) span);
+  }
+  static thread_local std::vector<int> hist;
+  hist.assign (nbins + 1, 0);
+  for (pit = ptsh.begin (); pit != ptsh.end (); pit ++)
+  {
+    int b = (nbins == 1 ? 0 : (int) ((pit->y () - hlow) / bw));
+    hist[(b < nbins ? b : nbins - 1) + 1] ++;
+  }
+  for (int b = 1; b <= nbins; b++) hist[b] += hist[b - 1];
+  hts.resize (nb);
+  for (pit = ptsh.begin (); pit != ptsh.end (); pit ++)
+  {
+    int b = (nbins == 1 ? 0 : (int) ((pit->y () - hlow) / bw));
+    hts[hist[b < nbins ? b : nbins - 1] ++] = pit->y ();
+  }
+
+  // Each bin now ends at the start of the next one
+  int start = 0;
+  for (int b = 0; b < nbins; b++)
+  {
+    int end = hist[b];
+    if (end - start > 16) std::sort (hts.begin () + start, hts.begin () + end);
+    else
+      for (int i = start + 1; i < end; i++)
+      {
+        float h = hts[i];
+        int j = i;
+        while (j > start && hts[j - 1] > h)
+        {
+          hts[j] = hts[j - 1];
+          j --;
+        }
+        hts[j] = h;
+      }
+    start = end;
+  }
 }
 
 
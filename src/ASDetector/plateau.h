@@ -27,14 +27,16 @@
 
 #include "pt2f.h"
 #include "plateaumodel.h"
+#include "plateauprofile.h"
 #include "digitalstraightsegment.h"
+#include "objectarena.h"
 
 
 /** 
  * @class Plateau plateau.h
  * \brief Cross section of a carriage track.
  */
-class Plateau
+class Plateau : public ArenaObject
 {
 public:
 
@@ -107,6 +109,21 @@ public:
               float lstart, float lend, float lheight,
               float cshift, int confdist);
 
+  /**
+   * \brief Detects the plateau in a scan knowing the neighboring plateau.
+   * Uses an integer translation of the scan already set.
+   * @param ptsh Scan points sorted by increasing distance to scan start bound.
+   * @param prof Integer translation of the scan points.
+   * @param lstart Awaited start position.
+   * @param lend Awaited end position.
+   * @param lheight Awaited altitude.
+   * @param cshift Reference center shift.
+   * @param confdist Distance to last reliable plateau (in count of stripes).
+   */
+  bool track (const std::vector<Pt2f> &ptsh, const PlateauProfile &prof,
+              float lstart, float lend, float lheight,
+              float cshift, int confdist);
+
   /**
    * \brief Detects the plateau in a scan knowing the neighboring plateau.
    * Ensures connexity between adjacent plateaux.
@@ -119,6 +136,19 @@ public:
   bool track (const std::vector<Pt2f> &ptsh, Plateau *refp,
               int confdist, float cshift, float l12 = 0.0f);
 
+  /**
+   * \brief Detects the plateau in a scan knowing the neighboring plateau.
+   * Specific version for road network extraction, using an integer
+   *   translation of the scan already set.
+   * @param ptsh Scan points sorted by increasing distance to scan start bound.
+   * @param prof Integer translation of the scan points.
+   * @param refp Reference plateau (NULL if first detection)
+   * @param confdist Distance to last reliable plateau (0 if first detection).
+   * @param cshift Reference center shift.
+   */
+  bool track (const std::vector<Pt2f> &ptsh, const PlateauProfile &prof,
+              Plateau *refp, int confdist, float cshift, float l12 = 0.0f);
+
   /**
    * \brief Provides plateau detection status.
    */
@@ -425,6 +455,8 @@ private :
   static const float POS_INCREMENT;
   /** Minimal position tolerance value. */
   static const float MIN_POS_TOLERANCE;
+  /** Count of height histogram bins per thickness tolerance. */
+  static const int HEIGHT_BINS;
 
   /** Detection result. */
   int status;
@@ -504,11 +536,14 @@ private :
   void setPosition (float wmt);
 
   /**
-   * \brief Compares points by increasing altitude.
-   * @param p1 First point.
-   * @param p2 Second point.
+   * \brief Sorts scan point heights by increasing value.
+   * Heights are first dispatched in a histogram of thickness tolerance
+   *   fractions, then each histogram bin is sorted.
+   * @param ptsh Scan points.
+   * @param hts Sorted heights (output).
    */
-  static bool compHigher (Pt2f p1, Pt2f p2);
+  void sortHeights (const std::vector<Pt2f> &ptsh,
+                    std::vector<float> &hts) const;
 
   /**
    * \brief Compares points by increasing distance.
@@ -0,0 +1,68 @@
+/*  Copyright 2021 Philippe Even and Phuc Ngo,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#include "plateauprofile.h"
+#include <cmath>
+
+
+PlateauProfile::PlateauProfile ()
+{
+  locheight = 0.0f;
+}
+
+
+void PlateauProfile::set (const std::vector<Pt2f> &ptsh)
+{
+  ptsi.clear ();
+  if (ptsh.empty ()) return;
+  ptsi.reserve (ptsh.size ());
+  std::vector<Pt2f>::const_iterator it = ptsh.begin ();
+  locheight = it->y ();
+  while (it != ptsh.end ())
+  {
+    ptsi.push_back (Pt2i (floor (it->x () * 1000),
+                          floor ((it->y () - locheight) * 1000)));
+    it ++;
+  }
+}
+
+
+int PlateauProfile::startIndex (int icenter) const
+{
+  int nb = (int) (ptsi.size ());
+  for (int i = 0; i < nb; i++)
+  {
+    int x = ptsi[i].x ();
+    if (x > icenter)
+    {
+      if (i == 0) return 0;
+      else if (x - icenter > icenter - ptsi[i - 1].x ()) return (i - 1);
+      else return i;
+    }
+  }
+  return 0;
+}
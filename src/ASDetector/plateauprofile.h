@@ -0,0 +1,87 @@
+/*  Copyright 2021 Philippe Even and Phuc Ngo,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#ifndef PLATEAU_PROFILE_H
+#define PLATEAU_PROFILE_H
+
+#include <vector>
+#include "pt2i.h"
+#include "pt2f.h"
+
+
+/** 
+ * @class PlateauProfile plateauprofile.h
+ * \brief Scan profile translated to integer millimeters for plateau tracking.
+ * Successive tracking trials with different center shifts on a same scan
+ *   share this translation instead of processing the profile again.
+ * Setting a new profile keeps the allocated storage.
+ */
+class PlateauProfile
+{
+public:
+
+  /**
+   * \brief Creates an empty profile.
+   */
+  PlateauProfile ();
+
+  /**
+   * \brief Translates a scan profile.
+   * Distances are floored to millimeters, and heights are floored to
+   *   millimeters relatively to the first profile point height.
+   * @param ptsh Scan points sorted by increasing distance to scan start bound.
+   */
+  void set (const std::vector<Pt2f> &ptsh);
+
+  /**
+   * \brief Returns the translated points.
+   */
+  inline const std::vector<Pt2i> &points () const { return ptsi; }
+
+  /**
+   * \brief Returns the height of the first profile point (meters).
+   */
+  inline float baseHeight () const { return locheight; }
+
+  /**
+   * \brief Returns the index of the point nearest to a position.
+   * The search stops at the first point beyond the position. If none is
+   *   found, the first point index (0) is returned.
+   * @param icenter Position in millimeters.
+   */
+  int startIndex (int icenter) const;
+
+
+private:
+
+  /** Translated points. */
+  std::vector<Pt2i> ptsi;
+  /** Height of first profile point. */
+  float locheight;
+};
+
+#endif
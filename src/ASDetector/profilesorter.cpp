@@ -0,0 +1,176 @@
+/*  Copyright 2021 Philippe Even and Phuc Ngo,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cstring>
+#include "profilesorter.h"
+
+const int ProfileSorter::RADIX_BITS = 8;
+const int ProfileSorter::RADIX_MIN_SIZE = 64;
+
+
+ProfileSorter::ProfileSorter ()
+{
+  radix_on = true;
+}
+
+
+void ProfileSorter::sortOnMillimeters (std::vector<Pt2f> &pts)
+{
+  if (pts.size () < 2) return;
+  if (! radix_on || ! sortMillimeterKeys (pts))
+    std::sort (pts.begin (), pts.end (), compIFurther);
+}
+
+
+void ProfileSorter::sortOnMillimeters (std::vector<Pt3f> &pts)
+{
+  if (pts.size () < 2) return;
+  if (! radix_on || ! sortMillimeterKeys (pts))
+    std::sort (pts.begin (), pts.end (), compLFurther);
+}
+
+
+void ProfileSorter::sortOnDistance (std::vector<Pt2f> &pts)
+{
+  int nb = (int) (pts.size ());
+  if (nb < 2) return;
+  if (radix_on)
+  {
+    // Float bits mapped to order preserving unsigned values
+    int ibits = bitCount ((uint64_t) (nb - 1));
+    uint64_t kmin = 0, kmax = 0;
+    keys.resize (nb);
+    for (int i = 0; i < nb; i++)
+    {
+      float val = pts[i].x ();
+      if (val == 0.0f) val = 0.0f;   // -0 and 0 are equal distances
+      uint32_t u;
+      memcpy (&u, &val, sizeof (u));
+      keys[i] = ((u & 0x80000000u) != 0 ? ~u : u | 0x80000000u);
+      if (i == 0 || keys[i] < kmin) kmin = keys[i];
+      if (i == 0 || keys[i] > kmax) kmax = keys[i];
+    }
+    int kbits = bitCount (kmax - kmin);
+    for (int i = 0; i < nb; i++)
+      keys[i] = ((keys[i] - kmin) << ibits) | (uint64_t) i;
+    sortKeys (kbits, ibits);
+    reorder (pts, ibits);
+    return;
+  }
+  std::sort (pts.begin (), pts.end (), compFurther);
+}
+
+
+bool ProfileSorter::packKeys (int ibits, int &kbits)
+{
+  int nb = (int) (xkeys.size ());
+  const int64_t *xk = xkeys.data (), *yk = ykeys.data ();
+  int64_t xmin = xk[0], xmax = xk[0], ymin = yk[0], ymax = yk[0];
+  for (int i = 1; i < nb; i++)
+  {
+    if (xk[i] < xmin) xmin = xk[i];
+    else if (xk[i] > xmax) xmax = xk[i];
+    if (yk[i] < ymin) ymin = yk[i];
+    else if (yk[i] > ymax) ymax = yk[i];
+  }
+  int xbits = bitCount ((uint64_t) (xmax - xmin));
+  int ybits = bitCount ((uint64_t) (ymax - ymin));
+  kbits = xbits + ybits;
+  if (kbits + ibits > 64) return false;
+  keys.resize (nb);
+  for (int i = 0; i < nb; i++)
+    keys[i] = (((((uint64_t) (xk[i] - xmin)) << ybits)
+                | ((uint64_t) (yk[i] - ymin))) << ibits) | (uint64_t) i;
+  return true;
+}
+
+
+void ProfileSorter::sortKeys (int kbits, int ibits)
+{
+  // Keys are unique thanks to the index bits
+  int nb = (int) (keys.size ());
+  if (nb < RADIX_MIN_SIZE)
+  {
+    std::sort (keys.begin (), keys.end ());
+    return;
+  }
+
+  // Index bits are already ordered, only key bits need to be sorted
+  int nbuck = 1 << RADIX_BITS;
+  tkeys.resize (nb);
+  counts.resize (nbuck);
+  for (int shift = ibits; shift < ibits + kbits; shift += RADIX_BITS)
+  {
+    std::fill (counts.begin (), counts.end (), 0);
+    for (int i = 0; i < nb; i++)
+      counts[(int) ((keys[i] >> shift) & (nbuck - 1))] ++;
+    if (counts[(int) ((keys[0] >> shift) & (nbuck - 1))] == nb) continue;
+    int sum = 0;
+    for (int b = 0; b < nbuck; b++)
+    {
+      int c = counts[b];
+      counts[b] = sum;
+      sum += c;
+    }
+    for (int i = 0; i < nb; i++)
+      tkeys[counts[(int) ((keys[i] >> shift) & (nbuck - 1))] ++] = keys[i];
+    keys.swap (tkeys);
+  }
+}
+
+
+int ProfileSorter::bitCount (uint64_t val)
+{
+  int nb = 0;
+  while (val != 0)
+  {
+    val >>= 1;
+    nb ++;
+  }
+  return nb;
+}
+
+
+bool ProfileSorter::compIFurther (Pt2f p1, Pt2f p2)
+{
+  return (floor (p2.x () * 1000) > floor (p1.x () * 1000)
+          || (floor (p2.x () * 1000) == floor (p1.x () * 1000)
+              && floor (p2.y () * 1000) > floor (p1.y () * 1000)));
+}
+
+
+bool ProfileSorter::compLFurther (Pt3f p1, Pt3f p2)
+{
+  return (floor (p2.x () * 1000) > floor (p1.x () * 1000)
+          || (floor (p2.x () * 1000) == floor (p1.x () * 1000)
+              && floor (p2.y () * 1000) > floor (p1.y () * 1000)));
+}
+
+
+bool ProfileSorter::compFurther (Pt2f p1, Pt2f p2)
+{
+  return (p2.x () > p1.x ());
+}
@@ -0,0 +1,210 @@
+/*  Copyright 2021 Philippe Even and Phuc Ngo,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef PROFILE_SORTER_H
+#define PROFILE_SORTER_H
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include "pt2f.h"
+#include "pt3f.h"
+
+
+/** 
+ * @class ProfileSorter profilesorter.h
+ * \brief Sorter of scan profile points by distance to the scan bound.
+ * Points are sorted by a stable LSD radix sort on integer keys, computed
+ *   once per point, instead of std::sort with a comparison function.
+ * Points with equal keys keep their scan order.
+ */
+class ProfileSorter
+{
+public:
+
+  /**
+   * \brief Creates a profile sorter.
+   */
+  ProfileSorter ();
+
+  /**
+   * \brief Checks whether radix sort is used (or std::sort).
+   */
+  inline bool isRadixOn () const { return radix_on; }
+
+  /**
+   * \brief Sets the use of radix sort (or std::sort).
+   * @param status Radix sort status.
+   */
+  inline void setRadix (bool status) { radix_on = status; }
+
+  /**
+   * \brief Sorts profile points by distance, then height, on millimeter basis.
+   * @param pts Profile points (distance, height).
+   */
+  void sortOnMillimeters (std::vector<Pt2f> &pts);
+
+  /**
+   * \brief Sorts labelled points by distance, then height, on millimeter basis.
+   * The third dimension is used for the label.
+   * @param pts Labelled profile points (distance, height, label).
+   */
+  void sortOnMillimeters (std::vector<Pt3f> &pts);
+
+  /**
+   * \brief Sorts profile points by distance.
+   * @param pts Profile points (distance, height).
+   */
+  void sortOnDistance (std::vector<Pt2f> &pts);
+
+
+private:
+
+  /** Count of key bits processed at each radix pass. */
+  static const int RADIX_BITS;
+  /** Count of points below which packed keys are sorted by std::sort. */
+  static const int RADIX_MIN_SIZE;
+
+  /** Radix sort use status. */
+  bool radix_on;
+  /** Millimeter distance keys. */
+  std::vector<int64_t> xkeys;
+  /** Millimeter height keys. */
+  std::vector<int64_t> ykeys;
+  /** Sorted keys, with point index in lowest bits. */
+  std::vector<uint64_t> keys;
+  /** Radix pass output keys. */
+  std::vector<uint64_t> tkeys;
+  /** Radix bucket counts. */
+  std::vector<int> counts;
+  /** Reordered profile points, swapped with sorted points. */
+  std::vector<Pt2f> spts;
+  /** Reordered labelled points, swapped with sorted points. */
+  std::vector<Pt3f> slpts;
+
+
+  /**
+   * \brief Packs millimeter distance and height keys in sorted keys.
+   * Returns false if keys do not fit in 64 bits.
+   * @param ibits Count of index bits.
+   * @param kbits Count of key bits above index bits (output).
+   */
+  bool packKeys (int ibits, int &kbits);
+
+  /**
+   * \brief Radix sorts points by distance, then height, on millimeter basis.
+   * Returns false if the keys are too large (points left unsorted).
+   * @param pts Points with distance and height as first coordinates.
+   */
+  template <class T> bool sortMillimeterKeys (std::vector<T> &pts)
+  {
+    int nb = (int) (pts.size ());
+    int ibits = bitCount ((uint64_t) (nb - 1)), kbits = 0;
+    xkeys.resize (nb);
+    ykeys.resize (nb);
+    for (int i = 0; i < nb; i++)
+    {
+      xkeys[i] = mmKey (pts[i].x ());
+      ykeys[i] = mmKey (pts[i].y ());
+    }
+    if (! packKeys (ibits, kbits)) return false;
+    sortKeys (kbits, ibits);
+    reorder (pts, ibits);
+    return true;
+  }
+
+  /**
+   * \brief Sorts the packed keys.
+   * @param kbits Count of key bits above index bits.
+   * @param ibits Count of index bits.
+   */
+  void sortKeys (int kbits, int ibits);
+
+  /**
+   * \brief Returns the count of bits needed to code a value.
+   * @param val Coded value.
+   */
+  static int bitCount (uint64_t val);
+
+  /**
+   * \brief Returns the millimeter key of a coordinate.
+   * @param val Coordinate value in meter.
+   */
+  static inline int64_t mmKey (float val) {
+    return ((int64_t) floor (val * 1000)); }
+
+  /**
+   * \brief Compares points by distance to scan bound on integer basis.
+   * @param p1 First point.
+   * @param p2 Second point.
+   */
+  static bool compIFurther (Pt2f p1, Pt2f p2);
+
+  /**
+   * \brief Compares labelled points by distance to scan bound on integer basis.
+   * The third dimension is used for the label.
+   * @param p1 First point.
+   * @param p2 Second point.
+   */
+  static bool compLFurther (Pt3f p1, Pt3f p2);
+
+  /**
+   * \brief Compares points by distance to scan bound.
+   * @param p1 First point.
+   * @param p2 Second point.
+   */
+  static bool compFurther (Pt2f p1, Pt2f p2);
+
+  /**
+   * \brief Returns the reordering buffer for profile points.
+   */
+  inline std::vector<Pt2f> &buffer (const std::vector<Pt2f> &) {
+    return spts; }
+
+  /**
+   * \brief Returns the reordering buffer for labelled points.
+   */
+  inline std::vector<Pt3f> &buffer (const std::vector<Pt3f> &) {
+    return slpts; }
+
+  /**
+   * \brief Reorders points according to the sorted keys.
+   * Reordered points are written in a buffer kept between calls,
+   *   then swapped with the input points.
+   * @param pts Points to reorder.
+   * @param ibits Count of index bits.
+   */
+  template <class T> void reorder (std::vector<T> &pts, int ibits)
+  {
+    uint64_t imask = (((uint64_t) 1) << ibits) - 1;
+    std::vector<T> &sorted = buffer (pts);
+    sorted.resize (pts.size ());
+    typename std::vector<T>::iterator sit = sorted.begin ();
+    std::vector<uint64_t>::const_iterator it = keys.begin ();
+    while (it != keys.end ()) *sit++ = pts[(int) (*it++ & imask)];
+    pts.swap (sorted);
+  }
+};
+#endif
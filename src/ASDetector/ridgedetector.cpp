@@ -72,6 +72,7 @@ void RidgeDetector::clear ()
   if (ibg != NULL) delete ibg;
   ibg = NULL;
   istatus = RESULT_NONE;
+  arena.reset ();
 }
 
 
@@ -86,10 +87,26 @@ void RidgeDetector::setPointsGrid (IPtTileSet *data, int width, int height,
 }
 
 
+void RidgeDetector::copySettings (const RidgeDetector &det)
+{
+  ptset = det.ptset;
+  subdiv = det.subdiv;
+  csize = det.csize;
+  scanp = det.scanp;
+  discanp = det.discanp;
+  profileRecordOn = det.profileRecordOn;
+  psorter.setRadix (det.psorter.isRadixOn ());
+  bfeat = det.bfeat;
+  bump_lack_tolerance = det.bump_lack_tolerance;
+  initial_ridge_extent = det.initial_ridge_extent;
+}
+
+
 Ridge *RidgeDetector::detect (const Pt2i &p1, const Pt2i &p2)
 {
   // Cleans up former detection
   clear ();
+  ObjectArena::Scope scope (&arena);
 
   // Checks input stroke length
   ip1.set (p1);
@@ -192,12 +209,12 @@ void RidgeDetector::detect (int exlimit)
   int scan0_shift = (int) (valc < 0.0f ? valc - 0.5f : valc + 0.5f);
 
   // Creates adaptive directional scanners for point cloud and display
-  DirectionalScanner *ds = scanp.getScanner (
+  DirectionalScanner *ds = scanp.getScanner (scan_holder,
     Pt2i (p1.x () * subdiv + subdiv / 2, p1.y () * subdiv + subdiv / 2),
     Pt2i (p2.x () * subdiv + subdiv / 2, p2.y () * subdiv + subdiv / 2),
     true);
   ds->releaseClearance ();
-  DirectionalScanner *disp = discanp.getScanner (p1, p2, true);
+  DirectionalScanner *disp = discanp.getScanner (disp_holder, p1, p2, true);
 
   // Gets the central scan of the point cloud
   std::vector<Pt2i> pix;
@@ -221,21 +238,8 @@ void RidgeDetector::detect (int exlimit)
 
   // Gets and sorts scanned points by distance to first stroke point
   std::vector<Pt2f> cpts;
-  std::vector<Pt2i>::iterator it = pix.begin ();
-  while (it != pix.end ())
-  {
-    std::vector<Pt3f> ptcl;
-    ptset->collectPoints (ptcl, it->x (), it->y ());
-    std::vector<Pt3f>::iterator pit = ptcl.begin ();
-    while (pit != ptcl.end ())
-    {
-      Vr2f pcl (pit->x () - p1f.x (), pit->y () - p1f.y ());
-      cpts.push_back (Pt2f (pcl.scalarProduct (p12n), pit->z ()));
-      pit ++;
-    }
-    it ++;
-  }
-  sort (cpts.begin (), cpts.end (), compFurther);
+  ptset->collectScanProfile (cpts, pix, p1f, p12n);
+  psorter.sortOnDistance (cpts);
 
   // Detects the central bump
   Ridge *ridge = new Ridge ();
@@ -255,8 +259,8 @@ void RidgeDetector::detect (int exlimit)
   }
 
   // Sets template and detects next bumps on each side
-  DirectionalScanner *ds2 = ds->getCopy ();
-  DirectionalScanner *disp2 = disp->getCopy ();
+  DirectionalScanner *ds2 = ds->getCopy (scan_holder2);
+  DirectionalScanner *disp2 = disp->getCopy (disp_holder2);
 
   resetPositionsAndHeights (bmp->isAccepted (), bmp->estimatedCenter());
   track (true, scanp.isLastScanReversed (), exlimit,
@@ -296,38 +300,23 @@ void RidgeDetector::track (bool onright, bool reversed, int exlimit,
     ds->bindTo (dss_n.x (), dss_n.y (), scan_shift * subdiv + subdiv / 2);
 
     // Collects next scan points and sorts them by distance
-    std::vector<Pt2i> pix;
     std::vector<Pt2i> dispix;
     if ((onright && ! reversed) || (reversed && ! onright))
       disp->nextOnRight (dispix);
     else disp->nextOnLeft (dispix);
+    scan_strip.clear ();
     if (dispix.empty ()) search = false;
-    else
-      for (int i = 0; search && i < subdiv; i++)
-        if ((onright && ! reversed) || (reversed && ! onright))
-        {
-          if (ds->nextOnRight (pix) == 0) search = false;
-        }
-        else if (ds->nextOnLeft (pix) == 0) search = false;
-    if (pix.empty ()) search = false;
+    else if ((onright && ! reversed) || (reversed && ! onright))
+    {
+      if (ds->nextOnRight (scan_strip, subdiv) != subdiv) search = false;
+    }
+    else if (ds->nextOnLeft (scan_strip, subdiv) != subdiv) search = false;
+    if (scan_strip.empty ()) search = false;
     else
     {
       std::vector<Pt2f> pts;
-      std::vector<Pt2i>::iterator it = pix.begin ();
-      while (it != pix.end ())
-      {
-        std::vector<Pt3f> ptcl;
-        ptset->collectPoints (ptcl, it->x (), it->y ());
-        std::vector<Pt3f>::iterator pit = ptcl.begin ();
-        while (pit != ptcl.end ())
-        {
-          Vr2f pcl (pit->x () - p1f.x (), pit->y () - p1f.y ());
-          pts.push_back (Pt2f (pcl.scalarProduct (p12n), pit->z ()));
-          pit ++;
-        }
-        it ++;
-      }
-      sort (pts.begin (), pts.end (), compFurther);
+      ptset->collectScanProfile (pts, scan_strip.pixels (), p1f, p12n);
+      psorter.sortOnDistance (pts);
 
       // Detects the bump and updates the ridge section
       Bump *bump = new Bump (&bfeat, scan_shift);
@@ -545,12 +534,6 @@ float RidgeDetector::updateHeight (bool ok, float ht)
 }
 
 
-bool RidgeDetector::compFurther (Pt2f p1, Pt2f p2)
-{
-  return (p2.x () > p1.x ());
-}
-
-
 bool RidgeDetector::isOver () const
 {
   return (bfeat.isOver ());
@@ -27,6 +27,7 @@
 
 #include "ridge.h"
 #include "ipttileset.h"
+#include "profilesorter.h"
 #include "scannerprovider.h"
 
 
@@ -82,6 +83,14 @@ public:
   void setPointsGrid (IPtTileSet *data, int width, int height,
                       int subdiv, float cellsize);
 
+  /**
+   * \brief Sets the points grid and all detection settings of another
+   *   detector, so that both detectors may run concurrently on this grid.
+   * Detected features are not copied.
+   * @param det Detector to imitate.
+   */
+  void copySettings (const RidgeDetector &det);
+
   /**
    * \brief Detects a ridge between input points.
    * Returns the detected ridge.
@@ -177,6 +186,17 @@ public:
   inline bool isInitializationOn () const {
     return (initial_ridge_extent != 0); }
 
+  /**
+   * \brief Indicates whether scan profiles are radix sorted (or std::sort).
+   */
+  inline bool isRadixSorting () const { return psorter.isRadixOn (); }
+
+  /**
+   * \brief Switches scan profiles sort between radix sort and std::sort.
+   */
+  inline void switchRadixSorting () {
+    psorter.setRadix (! psorter.isRadixOn ()); }
+
   /**
    * \brief Returns the DTM cell size.
    */
@@ -206,6 +226,20 @@ private :
 
   /** Points grid. */
   IPtTileSet *ptset;
+  /** Scan profile sorter. */
+  ProfileSorter psorter;
+  /** Memory arena of the objects created during a detection. */
+  ObjectArena arena;
+  /** Point cloud scanner storage for the first tracked side. */
+  ScannerHolder scan_holder;
+  /** Point cloud scanner storage for the second tracked side. */
+  ScannerHolder scan_holder2;
+  /** Display scanner storage for the first tracked side. */
+  ScannerHolder disp_holder;
+  /** Display scanner storage for the second tracked side. */
+  ScannerHolder disp_holder2;
+  /** Point cloud scans gathered for one display scan. */
+  ScanStrip scan_strip;
   /** Cloud grid / Dtm grid ratio. */
   int subdiv;
   /** DTM cell size: pixel to cloud point (meter) ratio. */
@@ -303,12 +337,5 @@ private :
    */
   float updateHeight (bool ok, float ht = 0.0f);
 
-  /**
-   * \brief Compares points by distance to scan bound.
-   * @param p1 First point.
-   * @param p2 Second point.
-   */
-  static bool compFurther (Pt2f p1, Pt2f p2);
-
 };
 #endif
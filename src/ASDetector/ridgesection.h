@@ -28,13 +28,14 @@
 #include "bump.h"
 #include "pt2i.h"
 #include "pt2f.h"
+#include "objectarena.h"
 
 
 /** 
  * @class RidgeSection ridgesection.h
  * \brief Ridge structure section.
  */
-class RidgeSection
+class RidgeSection : public ArenaObject
 {
 public:
 
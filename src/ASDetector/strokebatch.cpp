@@ -0,0 +1,113 @@
+/*  Copyright 2021 Philippe Even and Phuc Ngo,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+#include "strokebatch.h"
+#include "workerpool.h"
+#include <atomic>
+#include <condition_variable>
+
+
+StrokeBatch::StrokeBatch ()
+{
+}
+
+
+StrokeBatch::~StrokeBatch ()
+{
+  std::vector<CTrackDetector *>::iterator tit = tdets.begin ();
+  while (tit != tdets.end ()) delete *tit++;
+  std::vector<RidgeDetector *>::iterator rit = rdets.begin ();
+  while (rit != rdets.end ()) delete *rit++;
+}
+
+
+void StrokeBatch::addStroke (const Pt2i &p1, const Pt2i &p2)
+{
+  strokes.push_back (p1);
+  strokes.push_back (p2);
+}
+
+
+void StrokeBatch::detectTracks (const CTrackDetector &det,
+                    const std::function<void (int, CTrackDetector &)> &use)
+{
+  int nbctx = contextCount ();
+  while ((int) (tdets.size ()) < nbctx)
+    tdets.push_back (new CTrackDetector ());
+  // Strokes are claimed in order, so that waiting for the use of former
+  //   strokes cannot block
+  std::atomic<int> next (0);
+  int delivered = 0;
+  std::condition_variable turn;
+  WorkerPool::common ().run (nbctx, [&] (int c) {
+    CTrackDetector *ctx = tdets[c];
+    ctx->copySettings (det);
+    for (int i = next++; i < size (); i = next++)
+    {
+      ctx->forgetFormerBounds ();
+      ctx->detect (strokes[2 * i], strokes[2 * i + 1]);
+      std::unique_lock<std::mutex> lock (use_lock);
+      turn.wait (lock, [&] { return (delivered == i); });
+      use (i, *ctx);
+      delivered ++;
+      turn.notify_all ();
+    }
+    ctx->clear (); });
+}
+
+
+void StrokeBatch::detectRidges (const RidgeDetector &det,
+                    const std::function<void (int, RidgeDetector &)> &use)
+{
+  int nbctx = contextCount ();
+  while ((int) (rdets.size ()) < nbctx)
+    rdets.push_back (new RidgeDetector ());
+  // Strokes are claimed in order, so that waiting for the use of former
+  //   strokes cannot block
+  std::atomic<int> next (0);
+  int delivered = 0;
+  std::condition_variable turn;
+  WorkerPool::common ().run (nbctx, [&] (int c) {
+    RidgeDetector *ctx = rdets[c];
+    ctx->copySettings (det);
+    for (int i = next++; i < size (); i = next++)
+    {
+      ctx->detect (strokes[2 * i], strokes[2 * i + 1]);
+      std::unique_lock<std::mutex> lock (use_lock);
+      turn.wait (lock, [&] { return (delivered == i); });
+      use (i, *ctx);
+      delivered ++;
+      turn.notify_all ();
+    }
+    ctx->clear (); });
+}
+
+
+int StrokeBatch::contextCount () const
+{
+  int nbctx = WorkerPool::common ().size ();
+  return (nbctx < size () ? nbctx : size ());
+}
@@ -0,0 +1,116 @@
+/*  Copyright 2021 Philippe Even and Phuc Ngo,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef STROKE_BATCH_H
+#define STROKE_BATCH_H
+
+#include <vector>
+#include <mutex>
+#include <functional>
+#include "ctrackdetector.h"
+#include "ridgedetector.h"
+
+
+/** 
+ * @class StrokeBatch strokebatch.h
+ * \brief List of input strokes detected concurrently.
+ * Each thread of the worker pool runs its own detection context, set as
+ *   a given detector, over the shared points grid.
+ * Strokes are detected independently of each other, so that the result
+ *   of a stroke does not depend on the order of the strokes.
+ */
+class StrokeBatch
+{
+public:
+
+  /**
+   * \brief Creates an empty stroke batch.
+   */
+  StrokeBatch ();
+
+  /**
+   * \brief Deletes the stroke batch and its detection contexts.
+   */
+  ~StrokeBatch ();
+
+  /**
+   * \brief Removes all the strokes.
+   */
+  inline void clear () { strokes.clear (); }
+
+  /**
+   * \brief Appends a stroke to the batch.
+   * @param p1 Stroke first point.
+   * @param p2 Stroke second point.
+   */
+  void addStroke (const Pt2i &p1, const Pt2i &p2);
+
+  /**
+   * \brief Returns the count of strokes.
+   */
+  inline int size () const { return ((int) (strokes.size () / 2)); }
+
+  /**
+   * \brief Detects carriage tracks for all the strokes.
+   * The result of each stroke is passed to the provided function, while
+   *   still held by the detection context. Calls of this function are
+   *   serialized, and sorted by stroke number.
+   * @param det Detector providing the points grid and detection settings.
+   * @param use Function called with the stroke number and the context.
+   */
+  void detectTracks (const CTrackDetector &det,
+                     const std::function<void (int, CTrackDetector &)> &use);
+
+  /**
+   * \brief Detects ridges or hollows for all the strokes.
+   * The result of each stroke is passed to the provided function, while
+   *   still held by the detection context. Calls of this function are
+   *   serialized, and sorted by stroke number.
+   * @param det Detector providing the points grid and detection settings.
+   * @param use Function called with the stroke number and the context.
+   */
+  void detectRidges (const RidgeDetector &det,
+                     const std::function<void (int, RidgeDetector &)> &use);
+
+
+private:
+
+  /** Stroke end points, two by stroke. */
+  std::vector<Pt2i> strokes;
+  /** Carriage track detection contexts, kept for reuse. */
+  std::vector<CTrackDetector *> tdets;
+  /** Ridge detection contexts, kept for reuse. */
+  std::vector<RidgeDetector *> rdets;
+  /** Lock on detection results use. */
+  std::mutex use_lock;
+
+  /**
+   * \brief Returns the count of detection contexts to run.
+   */
+  int contextCount () const;
+};
+
+#endif
@@ -27,6 +27,7 @@
 
 #include "pt2i.h"
 #include "edist.h"
+#include "objectarena.h"
 #include <deque>
 
 
@@ -34,7 +35,7 @@
  * @class BiPtList biptlist.h
  * \brief Bi-directional list of points.
  */
-class BiPtList
+class BiPtList : public ArenaObject
 {
 public:
 
@@ -28,13 +28,14 @@
 #include "convexhull.h"
 #include "digitalstraightsegment.h"
 #include "biptlist.h"
+#include "objectarena.h"
 
 
 /** 
  * @class BlurredSegment blurredsegment.h
  * \brief A set of 2D points lying inside a digital straight line.
  */
-class BlurredSegment
+class BlurredSegment : public ArenaObject
 {
 public:
 
@@ -26,13 +26,14 @@
 #define CHVERTEX_H
 
 #include "pt2i.h"
+#include "objectarena.h"
 
 
 /** 
  * @class CHVertex chvertex.h
  * \brief Chained vertex with two adjacent points, on left and right.
  */
-class CHVertex : public Pt2i
+class CHVertex : public Pt2i, public ArenaObject
 {
 public:
 
@@ -26,13 +26,14 @@
 #define CONVEXHULL
 
 #include "antipodal.h"
+#include "objectarena.h"
 
 
 /** 
  * @class ConvexHull convexhull.h
  * \brief Convex hull of a polyline.
  */
-class ConvexHull
+class ConvexHull : public ArenaObject
 {
 public:
 
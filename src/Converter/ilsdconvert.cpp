@@ -0,0 +1,244 @@
+/*  Copyright 2021 Philippe Even, Phuc Ngo and Pierre Even,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdlib>
+#include "ipttile.h"
+#include "ipttileset.h"
+#include "terrainmap.h"
+#include "workerpool.h"
+
+using namespace std;
+
+
+/** Access types of the tiles. */
+static const int ACCESS[3] = {IPtTile::TOP, IPtTile::MID, IPtTile::ECO};
+/** Lock on console outputs. */
+static mutex out_lock;
+
+
+/**
+ * \brief Creates all the missing access types of a point tile.
+ * Returns whether some access type of the tile was found.
+ * @param dir Tile file directory.
+ * @param name Tile name.
+ * @param packed Packed format modality of created tile files.
+ * @param force Replacement modality of existing tile files.
+ */
+static bool convertTile (const string &dir, const string &name,
+                         bool packed, bool force)
+{
+  IPtTile *intile = NULL;
+  bool missing[3];
+  for (int i = 0; i < 3; i++)
+  {
+    IPtTile *tile = new IPtTile (dir, name, ACCESS[i]);
+    bool exists = tile->load (intile == NULL);
+    if (intile == NULL && exists)
+    {
+      intile = tile;
+      missing[i] = false;
+    }
+    else
+    {
+      missing[i] = force || ! exists;
+      delete tile;
+    }
+  }
+  if (intile == NULL)
+  {
+    lock_guard<mutex> lock (out_lock);
+    cout << "No tile found for " << name << endl;
+    return false;
+  }
+  for (int i = 0; i < 3; i++)
+    if (missing[i])
+    {
+      IPtTile *tile = new IPtTile (dir, name, ACCESS[i]);
+      tile->convert (*intile, ACCESS[i]);
+      bool saved = (packed ? tile->savePacked () : tile->save ());
+      lock_guard<mutex> lock (out_lock);
+      if (saved) cout << "Created " << tile->getName () << endl;
+      else cout << "Failed to save " << tile->getName () << endl;
+      delete tile;
+    }
+  delete intile;
+  return true;
+}
+
+
+/**
+ * \brief Creates normal map files of listed DTM (ASC) files.
+ * Listed files are processed as a whole to get continuous tile borders.
+ * Returns whether all normal map files were created.
+ * @param dir Normal map file directory.
+ * @param files DTM file paths.
+ * @param packed Packed format modality of created normal map files.
+ */
+static bool convertDtm (const string &dir, const vector<string> &files,
+                        bool packed)
+{
+  TerrainMap mappy;
+  mappy.setPackedFormat (packed);
+  vector<string> nvmnames;
+  for (int i = 0; i < (int) (files.size ()); i++)
+  {
+    if (! mappy.addDtmFile (files[i], true))
+    {
+      cout << "Problem with file " << files[i] << endl;
+      return false;
+    }
+    size_t last = files[i].find_last_of ("/\\");
+    last = (last == string::npos ? 0 : last + 1);
+    size_t suff = files[i].find_last_of ('.');
+    if (suff == string::npos || suff < last) suff = files[i].length ();
+    nvmnames.push_back (dir + files[i].substr (last, suff - last)
+                        + TerrainMap::NVM_SUFFIX);
+  }
+  return mappy.saveNormalMapsFromDtm (nvmnames, true);
+}
+
+
+/**
+ * \brief Checks listed tiles of an access type by sweeping their points.
+ * Tile points are loaded on demand in background, within a memory budget.
+ * Returns whether all the points announced by tile headers were found.
+ * @param dir Tile file directory.
+ * @param names Tile names.
+ * @param access Tile access type.
+ * @param budget Memory budget of loaded tiles (in bytes).
+ */
+static bool checkTiles (const string &dir, const vector<string> &names,
+                        int access, int64_t budget)
+{
+  IPtTileSet ptset;
+  ptset.setPrefetching (true);
+  ptset.setCacheBudget (budget);
+  for (int i = 0; i < (int) (names.size ()); i++)
+    if (! ptset.addTile (dir, names[i], access, false))
+      cout << "No tile found for " << names[i] << endl;
+  if (! ptset.create ()) return false;
+
+  int64_t nbpts = 0, maxbytes = 0;
+  int tw = ptset.tileWidth (), th = ptset.tileHeight ();
+  int k = ptset.nextTile ();
+  while (k != -1)
+  {
+    int ci = k % ptset.columnsOfTiles (), cj = k / ptset.columnsOfTiles ();
+    for (int j = cj * th; j < (cj + 1) * th; j++)
+      for (int i = ci * tw; i < (ci + 1) * tw; i++)
+        nbpts += ptset.cellSize (i, j);
+    if (ptset.cacheFootprint () > maxbytes) maxbytes = ptset.cacheFootprint ();
+    k = ptset.nextTile ();
+  }
+  bool ok = (nbpts == (int64_t) (ptset.size ()));
+  cout << (ok ? "Checked " : "Missing points in ") << ptset.size ()
+       << " points of access " << access << " tiles (up to "
+       << (maxbytes >> 20) << " MB loaded)" << endl;
+  return ok;
+}
+
+
+int main (int argc, char* argv[])
+{
+  string dir ("");
+  string list ("");
+  bool packed = false;
+  bool force = false;
+  bool dtm = false;
+  bool check = false;
+  int budget = 256;
+  int nbthreads = 0;
+
+  for (int i = 1; i < argc; i++)
+  {
+    string arg (argv[i]);
+    if (arg == string ("-d") && i + 1 < argc) dir = string (argv[++i]);
+    else if (arg == string ("-j") && i + 1 < argc) nbthreads = atoi (argv[++i]);
+    else if (arg == string ("-p")) packed = true;
+    else if (arg == string ("-f")) force = true;
+    else if (arg == string ("-n")) dtm = true;
+    else if (arg == string ("-c")) check = true;
+    else if (arg == string ("-m") && i + 1 < argc) budget = atoi (argv[++i]);
+    else if (arg.at (0) != '-' && list == "") list = arg;
+    else
+    {
+      cout << "Unknown argument: " << arg << endl;
+      list = "";
+      break;
+    }
+  }
+  if (list == "")
+  {
+    cout << "Usage: ILSDConvert [-d dir] [-j threads] [-p] [-f] [-n]"
+         << " [-c [-m MB]] list" << endl;
+    cout << "  Creates missing fast, medium and eco tiles of listed tiles."
+         << endl;
+    cout << "  -d : output directory (default ./til/, or ./nvm/ with -n)"
+         << endl;
+    cout << "  -j : count of threads (default all cores)" << endl;
+    cout << "  -p : saves tiles in packed format" << endl;
+    cout << "  -f : recreates existing tiles from the first found one" << endl;
+    cout << "  -n : creates normal maps of listed DTM (ASC) files" << endl;
+    cout << "  -c : then checks the tiles, loaded in background" << endl;
+    cout << "  -m : memory budget of checked tiles (default 256 MB)" << endl;
+    return 1;
+  }
+  if (dir == "") dir = (dtm ? "./nvm/" : "./til/");
+  if (dir.back () != '/' && dir.back () != '\\') dir += "/";
+
+  vector<string> names;
+  ifstream input (list.c_str (), ios::in);
+  if (! input)
+  {
+    cout << "Failed to open file " << list << endl;
+    return 1;
+  }
+  string name;
+  while (input >> name) names.push_back (name);
+  input.close ();
+
+  if (dtm) return (convertDtm (dir, names, packed) ? 0 : 2);
+
+  vector<char> found (names.size ());
+  WorkerPool pool (nbthreads);
+  pool.run ((int) (names.size ()), [&] (int i) {
+    found[i] = convertTile (dir, names[i], packed, force); });
+
+  int nbfail = 0;
+  for (int i = 0; i < (int) (names.size ()); i++) if (! found[i]) nbfail ++;
+  cout << (names.size () - nbfail) << " tiles converted, "
+       << nbfail << " not found" << endl;
+  if (check)
+    for (int i = 0; i < 3; i++)
+      if (! checkTiles (dir, names, ACCESS[i], ((int64_t) budget) << 20))
+        nbfail ++;
+  return (nbfail == 0 ? 0 : 2);
+}
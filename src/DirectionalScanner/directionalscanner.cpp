@@ -28,7 +28,7 @@
 
 DirectionalScanner::~DirectionalScanner ()
 {
-  if (steps != NULL) delete steps;
+  if (ownsteps && steps != NULL) delete [] steps;
   steps = NULL;
 }
 
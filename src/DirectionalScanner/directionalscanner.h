@@ -26,6 +26,9 @@
 #define DIRECTIONAL_SCANNER_H
 
 #include "pt2i.h"
+#include "scanstrip.h"
+
+class ScannerHolder;
 
 
 /** 
@@ -47,6 +50,13 @@ public:
    */
   virtual DirectionalScanner *getCopy () = 0;
 
+  /**
+   * \brief Returns a copy of the directional scanner built in given holder.
+   * The copy shares the line pattern of this scanner.
+   * @param holder Scanner holder used as copy storage.
+   */
+  virtual DirectionalScanner *getCopy (ScannerHolder &holder) = 0;
+
   /**
    * \brief Gets the central scan in a vector.
    * Adds central scan points to given vector and returns its new size.
@@ -68,6 +78,24 @@ public:
    */
   virtual int nextOnRight (std::vector<Pt2i> &scan) = 0;
 
+  /**
+   * \brief Appends next scans on the left to a scan strip.
+   * Stops when the strip still gets no pixel (out of scan area).
+   * Returns the count of appended scans.
+   * @param strip Scan strip to be completed.
+   * @param nb Count of required scans.
+   */
+  virtual int nextOnLeft (ScanStrip &strip, int nb) = 0;
+
+  /**
+   * \brief Appends next scans on the right to a scan strip.
+   * Stops when the strip still gets no pixel (out of scan area).
+   * Returns the count of appended scans.
+   * @param strip Scan strip to be completed.
+   * @param nb Count of required scans.
+   */
+  virtual int nextOnRight (ScanStrip &strip, int nb) = 0;
+
   /**
    * \brief Gets next skipped scan to the left in a vector.
    * Adds points of next left scan to given vector and returns its new size.
@@ -117,6 +145,12 @@ public:
    */
   inline void releaseClearance () { clearance = false; }
 
+  /**
+   * \brief Declares the line pattern as provided by the caller.
+   * The pattern is then not deleted with the scanner.
+   */
+  inline void borrowSteps () { ownsteps = false; }
+
 
 protected:
 
@@ -143,6 +177,8 @@ protected:
   bool *steps;
   /** Pointer to the end of discrete line pattern. */
   bool *fs;
+  /** Discrete line pattern ownership (deleted with the scanner). */
+  bool ownsteps;
 
   /** X-start position of central scan (still used in locate (Pt2i)). */
   int ccx;
@@ -170,7 +206,7 @@ protected:
   /**
    * \brief Creates an empty directional scanner.
    */
-  DirectionalScanner () { }
+  DirectionalScanner () : ownsteps (false) { }
 
   /**
    * \brief Creates an incremental directional scanner.
@@ -189,18 +225,19 @@ protected:
   DirectionalScanner (int xmini, int ymini, int xmaxi, int ymaxi,
                       int nb, bool* st, int sx, int sy)
              : xmin (xmini), ymin (ymini), xmax (xmaxi), ymax (ymaxi),
-               nbs (nb), steps (st),
+               nbs (nb), steps (st), ownsteps (true),
                ccx (sx), ccy (sy), lcx (sx), lcy (sy), rcx (sx), rcy (sy),
                clearance (true) { }
 
   /**
    * \brief Creates a copy of given directional scanner.
+   * The copy shares the line pattern of the source scanner.
    * @param ds Source directional scanner.
    */
   DirectionalScanner (DirectionalScanner *ds)
          : xmin (ds->xmin), ymin (ds->ymin), xmax (ds->xmax), ymax (ds->ymax),
            dla (ds->dla), dlb (ds->dlb), dlc2 (ds->dlc2),
-           nbs (ds->nbs), steps (ds->steps), fs (ds->fs),
+           nbs (ds->nbs), steps (ds->steps), fs (ds->fs), ownsteps (false),
            ccx (ds->ccx), ccy (ds->ccy),
            lcx (ds->lcx), lcy (ds->lcy), rcx (ds->rcx), rcy (ds->rcy),
            lst2 (ds->lst2), rst2 (ds->rst2), clearance (ds->clearance) { }
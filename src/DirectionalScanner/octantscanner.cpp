@@ -0,0 +1,590 @@
+/*  Copyright 2021 Philippe Even and Phuc Ngo,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "octantscanner.h"
+#include "scannerholder.h"
+
+
+template <int OCTANT, ScanPolicy POLICY>
+OctantScanner<OCTANT, POLICY>::OctantScanner (
+                          int xmin, int ymin, int xmax, int ymax,
+                          int a, int b, int c,
+                          int nbs, bool *steps, int sx, int sy)
+                    : DirectionalScanner (xmin, ymin, xmax, ymax,
+                                          nbs, steps, sx, sy)
+{
+  this->dla = a;
+  this->dlb = b;
+  this->dlc2 = c;
+  this->dlc1 = a * sx + b * sy;
+
+  templ_a = a;
+  templ_b = b;
+  templ_nu = (DECREASING ? dlc1 - dlc2 : dlc2 - dlc1);
+
+  lst1 = steps;
+  rst1 = steps;
+  lst2 = steps;
+  rst2 = steps;
+  fs = steps + nbs;
+  lstop = false;
+  rstop = false;
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+OctantScanner<OCTANT, POLICY>::OctantScanner (
+                          int xmin, int ymin, int xmax, int ymax,
+                          int a, int b, int c1, int c2,
+                          int nbs, bool *steps, int cx, int cy)
+                    : DirectionalScanner (xmin, ymin, xmax, ymax,
+                                          nbs, steps, cx, cy)
+{
+  this->dla = a;
+  this->dlb = b;
+  if (DECREASING ? c2 > c1 : c2 < c1)
+  {
+    this->dlc1 = c2;
+    this->dlc2 = c1;
+    c1 = c2;
+  }
+  else
+  {
+    this->dlc1 = c1;
+    this->dlc2 = c2;
+  }
+
+  templ_a = a;
+  templ_b = b;
+  templ_nu = (DECREASING ? dlc1 - dlc2 : dlc2 - dlc1);
+  fs = steps + nbs;
+
+  // Looking for the central scan start position
+  bool *st = fs;
+  do backwards (lcx, lcy, st);
+  while (behind (lcx, lcy, c1));
+  lst2 = (POLICY == SCAN_ALIGNED ? steps : st);
+  rst2 = lst2;
+
+  rcx = lcx;
+  rcy = lcy;
+  if (POLICY == SCAN_STRIP)
+  {
+    ccx = lcx;
+    ccy = lcy;
+  }
+  lst1 = steps;
+  rst1 = steps;
+  lstop = false;
+  rstop = false;
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+OctantScanner<OCTANT, POLICY>::OctantScanner (
+                          int xmin, int ymin, int xmax, int ymax,
+                          int a, int b, int nbs, bool *steps,
+                          int cx, int cy, int length)
+                    : DirectionalScanner (xmin, ymin, xmax, ymax,
+                                          nbs, steps, cx, cy)
+{
+  this->dla = a;
+  this->dlb = b;
+  fs = steps + nbs;
+  int w_2 = (length + 1) / 2;
+
+  // Looking for the central scan start position
+  bool *st = fs;
+  for (int i = 0; i < w_2; i++) backwards (lcx, lcy, st);
+  dlc1 = dla * lcx + dlb * lcy;
+  lst2 = (POLICY == SCAN_ALIGNED ? steps : st);
+  rst2 = lst2;
+
+  // Looking for the upper leaning line
+  st = steps;
+  while (w_2-- > 0) forwards (cx, cy, st);
+  dlc2 = dla * cx + dlb * cy;
+
+  templ_a = a;
+  templ_b = b;
+  templ_nu = (DECREASING ? dlc1 - dlc2 : dlc2 - dlc1);
+
+  rcx = lcx;
+  rcy = lcy;
+  if (POLICY == SCAN_STRIP)
+  {
+    ccx = lcx;
+    ccy = lcy;
+  }
+  lst1 = steps;
+  rst1 = steps;
+  lstop = false;
+  rstop = false;
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+OctantScanner<OCTANT, POLICY>::OctantScanner (OctantScanner *ds)
+                             : DirectionalScanner (ds)
+{
+  lst1 = ds->lst1;
+  rst1 = ds->rst1;
+  lstop = ds->lstop;
+  rstop = ds->rstop;
+  templ_a = ds->templ_a;
+  templ_b = ds->templ_b;
+  templ_nu = ds->templ_nu;
+  dlc1 = ds->dlc1;
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+DirectionalScanner *OctantScanner<OCTANT, POLICY>::getCopy ()
+{
+  return (new OctantScanner (this));
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+DirectionalScanner *OctantScanner<OCTANT, POLICY>::getCopy (
+                                                      ScannerHolder &holder)
+{
+  return (holder.hold (new (holder.place ()) OctantScanner (this)));
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+inline bool OctantScanner<OCTANT, POLICY>::majorIn (int val, int dir) const
+{
+  return (dir > 0 ? val < (MAJOR_Y ? ymax : xmax)
+                  : val >= (MAJOR_Y ? ymin : xmin));
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+inline bool OctantScanner<OCTANT, POLICY>::minorIn (int val, int dir) const
+{
+  return (dir > 0 ? val < (MAJOR_Y ? xmax : ymax)
+                  : val >= (MAJOR_Y ? xmin : ymin));
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+inline bool OctantScanner<OCTANT, POLICY>::majorBefore (int val,
+                                                        int dir) const
+{
+  return (dir > 0 ? val < (MAJOR_Y ? ymin : xmin)
+                  : val >= (MAJOR_Y ? ymax : xmax));
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+inline bool OctantScanner<OCTANT, POLICY>::minorBefore (int val,
+                                                        int dir) const
+{
+  return (dir > 0 ? val < (MAJOR_Y ? xmin : ymin)
+                  : val >= (MAJOR_Y ? xmax : ymax));
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+inline bool OctantScanner<OCTANT, POLICY>::majorMovable (int val,
+                                                         int dir) const
+{
+  return (dir > 0 ? val < (MAJOR_Y ? ymax : xmax) - 1
+                  : val > (MAJOR_Y ? ymin : xmin));
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+inline bool OctantScanner<OCTANT, POLICY>::before (int x, int y,
+                                                   int c) const
+{
+  return (DECREASING ? dla * x + dlb * y > c : dla * x + dlb * y < c);
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+inline bool OctantScanner<OCTANT, POLICY>::behind (int x, int y,
+                                                   int c) const
+{
+  return (DECREASING ? dla * x + dlb * y < c : dla * x + dlb * y > c);
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+inline void OctantScanner<OCTANT, POLICY>::forwards (int &x, int &y,
+                                                     bool *&st) const
+{
+  if constexpr (POLICY != SCAN_ALIGNED)
+  {
+    if (*st) sideCoord (x, y) += MINOR_DIR;
+    if (++st >= fs) st = steps;
+  }
+  mainCoord (x, y) += MAJOR_DIR;
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+inline void OctantScanner<OCTANT, POLICY>::backwards (int &x, int &y,
+                                                      bool *&st) const
+{
+  if constexpr (POLICY != SCAN_ALIGNED)
+  {
+    if (--st < steps) st = fs - 1;
+    if (*st) sideCoord (x, y) -= MINOR_DIR;
+  }
+  mainCoord (x, y) -= MAJOR_DIR;
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+inline int OctantScanner<OCTANT, POLICY>::scanFrom (
+                            int x, int y, bool *nst,
+                            std::vector<Pt2i> &scan) const
+{
+  int &u = mainCoord (x, y);
+  if constexpr (POLICY == SCAN_ALIGNED)
+  {
+    while (majorBefore (u, MAJOR_DIR) && ! behind (x, y, dlc2))
+      u += MAJOR_DIR;
+    while (! behind (x, y, dlc2) && majorIn (u, MAJOR_DIR))
+    {
+      scan.push_back (Pt2i (x, y));
+      u += MAJOR_DIR;
+    }
+  }
+  else
+  {
+    int &v = sideCoord (x, y);
+    while ((minorBefore (v, MINOR_DIR) || majorBefore (u, MAJOR_DIR))
+           && ! behind (x, y, dlc2))
+      forwards (x, y, nst);
+    while (! behind (x, y, dlc2)
+           && minorIn (v, MINOR_DIR) && majorIn (u, MAJOR_DIR))
+    {
+      scan.push_back (Pt2i (x, y));
+      forwards (x, y, nst);
+    }
+  }
+  return ((int) (scan.size ()));
+}
+
+
+template <int OCTANT, ScanPolicy POLICY> template <bool LEFT>
+inline void OctantScanner<OCTANT, POLICY>::advance (
+                            int &x, int &y, bool *&st1, bool *&st2,
+                            bool &stop) const
+{
+  int &u = mainCoord (x, y);
+  int &v = sideCoord (x, y);
+  if (LEFT == LEFT_MINOR)
+  {
+    // Side of the secondary scan direction
+    if (stop)
+    {
+      u -= MAJOR_DIR;
+      if (--st2 < steps) st2 = fs - 1;
+      stop = false;
+    }
+    else
+    {
+      if (LEFT && --st1 < steps) st1 = fs - 1;
+      v += MINOR_DIR;
+      if (*st1)
+      {
+        if (--st2 < steps) st2 = fs - 1;
+        if (*st2)
+        {
+          if (++st2 >= fs) st2 = steps;
+          stop = true;
+        }
+        else u -= MAJOR_DIR;
+      }
+      if (! LEFT && ++st1 >= fs) st1 = steps;
+    }
+  }
+  else
+  {
+    // Side opposite to the secondary scan direction
+    v -= MINOR_DIR;
+    if (stop) stop = false;
+    else
+    {
+      if (LEFT && --st1 < steps) st1 = fs - 1;
+      if (*st1)
+      {
+        if (*st2)
+        {
+          v += MINOR_DIR;
+          stop = true;
+        }
+        u += MAJOR_DIR;
+        if (++st2 >= fs) st2 = steps;
+      }
+      if (! LEFT && ++st1 >= fs) st1 = steps;
+    }
+  }
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+inline void OctantScanner<OCTANT, POLICY>::realign (int &x, int &y,
+                                                    bool *&st) const
+{
+  int &u = mainCoord (x, y);
+  int &v = sideCoord (x, y);
+  while (majorMovable (u, MAJOR_DIR)
+         && (POLICY == SCAN_ALIGNED || minorIn (v, MINOR_DIR))
+         && before (x, y, dlc1))
+    forwards (x, y, st);
+  while (majorMovable (u, - MAJOR_DIR)
+         && (POLICY == SCAN_ALIGNED || minorIn (v, - MINOR_DIR))
+         && behind (x, y, dlc1))
+    backwards (x, y, st);
+}
+
+
+template <int OCTANT, ScanPolicy POLICY> template <bool LEFT>
+inline bool OctantScanner<OCTANT, POLICY>::moveOn (int skip)
+{
+  int &x = (LEFT ? lcx : rcx);
+  int &y = (LEFT ? lcy : rcy);
+  bool *&st2 = (LEFT ? lst2 : rst2);
+  if constexpr (POLICY == SCAN_STRIP)
+  {
+    while (skip-- > 0)
+      advance<LEFT> (x, y, LEFT ? lst1 : rst1, st2, LEFT ? lstop : rstop);
+  }
+  else
+  {
+    int dir = (LEFT ? LEFT_DIR : - LEFT_DIR);
+    sideCoord (x, y) += dir * skip;
+    if (POLICY == SCAN_ALIGNED && ! minorIn (sideCoord (x, y), dir))
+      return false;
+    // Whenever the control corridor changed
+    realign (x, y, st2);
+  }
+  return true;
+}
+
+
+template <int OCTANT, ScanPolicy POLICY> template <bool LEFT>
+inline int OctantScanner<OCTANT, POLICY>::next (std::vector<Pt2i> &scan,
+                                                int skip)
+{
+  if (clearance) scan.clear ();
+  if (! moveOn<LEFT> (skip)) return 0;
+  return (scanFrom (LEFT ? lcx : rcx, LEFT ? lcy : rcy,
+                    LEFT ? lst2 : rst2, scan));
+}
+
+
+template <int OCTANT, ScanPolicy POLICY> template <bool LEFT>
+inline int OctantScanner<OCTANT, POLICY>::nextScans (ScanStrip &strip,
+                                                     int nb)
+{
+  std::vector<Pt2i> &pix = strip.buffer ();
+  int count = 0;
+  while (count < nb && moveOn<LEFT> (1)
+         && scanFrom (LEFT ? lcx : rcx, LEFT ? lcy : rcy,
+                      LEFT ? lst2 : rst2, pix) != 0)
+  {
+    strip.closeScan ();
+    count ++;
+  }
+  return count;
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+int OctantScanner<OCTANT, POLICY>::first (std::vector<Pt2i> &scan) const
+{
+  return (scanFrom (lcx, lcy, lst2, scan));
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+int OctantScanner<OCTANT, POLICY>::nextOnLeft (std::vector<Pt2i> &scan)
+{
+  return (next<true> (scan, 1));
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+int OctantScanner<OCTANT, POLICY>::nextOnRight (std::vector<Pt2i> &scan)
+{
+  return (next<false> (scan, 1));
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+int OctantScanner<OCTANT, POLICY>::nextOnLeft (ScanStrip &strip, int nb)
+{
+  return (nextScans<true> (strip, nb));
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+int OctantScanner<OCTANT, POLICY>::nextOnRight (ScanStrip &strip, int nb)
+{
+  return (nextScans<false> (strip, nb));
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+int OctantScanner<OCTANT, POLICY>::skipLeft (std::vector<Pt2i> &scan,
+                                             int skip)
+{
+  return (next<true> (scan, skip));
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+int OctantScanner<OCTANT, POLICY>::skipRight (std::vector<Pt2i> &scan,
+                                              int skip)
+{
+  return (next<false> (scan, skip));
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+void OctantScanner<OCTANT, POLICY>::skipLeft (int skip)
+{
+  if constexpr (POLICY == SCAN_STRIP)
+  {
+    while (--skip > 0) advance<true> (lcx, lcy, lst1, lst2, lstop);
+  }
+  else sideCoord (lcx, lcy) += LEFT_DIR * (skip - 1);
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+void OctantScanner<OCTANT, POLICY>::skipRight (int skip)
+{
+  if constexpr (POLICY == SCAN_STRIP)
+  {
+    while (--skip > 0) advance<false> (rcx, rcy, rst1, rst2, rstop);
+  }
+  else sideCoord (rcx, rcy) -= LEFT_DIR * (skip - 1);
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+void OctantScanner<OCTANT, POLICY>::bindTo (int a, int b, int c)
+{
+  if constexpr (POLICY == SCAN_STRIP)
+  {
+    DirectionalScanner::bindTo (a, b, c);
+  }
+  else
+  {
+    if (a < 0)
+    {
+      dla = -a;
+      dlb = -b;
+      c = -c;
+    }
+    else
+    {
+      dla = a;
+      dlb = b;
+    }
+    int old_b = (templ_b < 0 ? -templ_b : templ_b);
+    int old_n1 = templ_a + old_b;
+    int old_ninf = (old_b > templ_a ? old_b : templ_a);
+    int new_a = (a < 0 ? -a : a);
+    int new_b = (b < 0 ? -b : b);
+    int new_n1 = new_a + new_b;
+    int new_ninf = (new_b > new_a ? new_b : new_a);
+    int nu;
+    if (new_n1 * old_ninf > old_n1 * new_ninf)
+      nu = (templ_nu * new_n1) / old_n1;
+    else
+      nu = (templ_nu * new_ninf) / old_ninf;
+    // For vertical scans, dlb sign is kept to avoid the direction change
+    //   of the support line inequations.
+    if (MAJOR_Y && (DECREASING ? dlb > 0 : dlb < 0))
+    {
+      dla = -dla;
+      dlb = -dlb;
+      c = -c;
+    }
+    dlc1 = (DECREASING ? c + nu / 2 : c - nu / 2);
+    dlc2 = (DECREASING ? c - nu / 2 : c + nu / 2);
+  }
+}
+
+
+template <int OCTANT, ScanPolicy POLICY>
+Pt2i OctantScanner<OCTANT, POLICY>::locate (const Pt2i &pt) const
+{
+  if constexpr (POLICY != SCAN_STRIP)
+  {
+    return (DirectionalScanner::locate (pt));
+  }
+  else
+  {
+    int x = ccx, y = ccy;      // Current position coordinates
+    bool *nst = steps;         // Current step in scan direction
+    int &u = mainCoord (x, y);
+    int pu = (MAJOR_Y ? pt.y () : pt.x ());
+    int pv = (MAJOR_Y ? pt.x () : pt.y ());
+
+    // Climbs the first scan up or down to the point
+    if ((pu - u) * MAJOR_DIR >= 0)
+      while (u != pu) forwards (x, y, nst);
+    else
+      while (u != pu) backwards (x, y, nst);
+    int cs = (pv - sideCoord (x, y)) * (LEFT_MINOR ? - MINOR_DIR : MINOR_DIR);
+
+    // Comes back to scan origin and jumps along scan bound
+    x = ccx;
+    y = ccy;
+    bool *st1 = steps;
+    bool *st2 = steps;
+    bool trans = false;
+    for (int ns = (cs < 0 ? - cs : cs); ns != 0; ns --)
+    {
+      if (cs < 0) advance<true> (x, y, st1, st2, trans);
+      else advance<false> (x, y, st1, st2, trans);
+    }
+    return (Pt2i (cs, (pu - u) * MAJOR_DIR));
+  }
+}
+
+
+template class OctantScanner<1, SCAN_STRIP>;
+template class OctantScanner<2, SCAN_STRIP>;
+template class OctantScanner<7, SCAN_STRIP>;
+template class OctantScanner<8, SCAN_STRIP>;
+template class OctantScanner<1, SCAN_ADAPTIVE>;
+template class OctantScanner<2, SCAN_ADAPTIVE>;
+template class OctantScanner<7, SCAN_ADAPTIVE>;
+template class OctantScanner<8, SCAN_ADAPTIVE>;
+template class OctantScanner<1, SCAN_ALIGNED>;
+template class OctantScanner<2, SCAN_ALIGNED>;
+template class OctantScanner<7, SCAN_ALIGNED>;
+template class OctantScanner<8, SCAN_ALIGNED>;
@@ -0,0 +1,421 @@
+/*  Copyright 2021 Philippe Even and Phuc Ngo,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OCTANT_SCANNER_H
+#define OCTANT_SCANNER_H
+
+#include "directionalscanner.h"
+
+
+/**
+ * \brief Scanning policies of octant scanners.
+ */
+enum ScanPolicy
+{
+  /** Parallel scans of a fixed strip. */
+  SCAN_STRIP,
+  /** Scans bound to a movable control corridor. */
+  SCAN_ADAPTIVE,
+  /** Adaptive scans aligned to main directions (vertical or horizontal). */
+  SCAN_ALIGNED
+};
+
+
+/** 
+ * @class OctantScanner octantscanner.h
+ * \brief Incremental directional scanner specialised for one octant.
+ * Scan stepping is resolved at compile time from the octant and the
+ *   scanning policy, so that pixel emission is an inlined loop.
+ * Octant 1 and 8 scans go upwards (1 leftwards, 8 rightwards),
+ *   octant 2 scans go leftwards and octant 7 scans go rightwards
+ *   (both upwards).
+ * Instances are provided by ScannerProvider.
+ */
+template <int OCTANT, ScanPolicy POLICY>
+class OctantScanner : public DirectionalScanner
+{
+public:
+  
+  /**
+   * \brief Creates a directional scanner from pattern, start and upper bound.
+   * The scan strip is composed of parallel scan lines, the first one being
+   *   defined by a start point, a line pattern, and an upper bound.
+   * @param xmin Left border of the scan area.
+   * @param ymin Bottom border of the scan area.
+   * @param xmax Right border of the scan area.
+   * @param ymax Top border of the scan area.
+   * @param a Value of parameter 'a' of the discrete support line.
+   * @param b Value of parameter 'b' of the discrete support line.
+   * @param c Value of parameter 'c' of the upper bounding line.
+   * @param nbs Size of the support line pattern.
+   * @param steps Support line pattern.
+   * @param sx X-coordinate of the central scan start point.
+   * @param sy Y-coordinate of the central scan start point.
+   */
+  OctantScanner (int xmin, int ymin, int xmax, int ymax,
+                 int a, int b, int c,
+                 int nbs, bool *steps, int sx, int sy);
+
+  /**
+   * \brief Creates a directional scanner from pattern, center and bounds.
+   * The scan strip is composed of parallel scan lines, the first one being
+   *   defined by a center, a line pattern, upper and lower bounds.
+   * @param xmin Left border of the scan area.
+   * @param ymin Bottom border of the scan area.
+   * @param xmax Right border of the scan area.
+   * @param ymax Top border of the scan area.
+   * @param a Value of parameter 'a' of the discrete support line.
+   * @param b Value of parameter 'b' of the discrete support line.
+   * @param c1 Value of parameter 'c' of one of the support lines.
+   * @param c2 Value of parameter 'c' of the other support line.
+   * @param nbs Size of the support line pattern.
+   * @param steps Support line pattern.
+   * @param cx X-coordinate of the central scan center.
+   * @param cy Y-coordinate of the central scan center.
+   */ 
+  OctantScanner (int xmin, int ymin, int xmax, int ymax,
+                 int a, int b, int c1, int c2,
+                 int nbs, bool *steps, int cx, int cy);
+
+  /**
+   * \brief Creates a directional scanner from pattern, center and length.
+   * The scan strip is composed of parallel scan lines, the first one being
+   *   defined by a center, a line pattern, and a length value.
+   * @param xmin Left border of the scan area.
+   * @param ymin Bottom border of the scan area.
+   * @param xmax Right border of the scan area.
+   * @param ymax Top border of the scan area.
+   * @param a Value of parameter 'a' of the discrete support line.
+   * @param b Value of parameter 'b' of the discrete support line.
+   * @param nbs Size of the support line pattern.
+   * @param steps Support line pattern.
+   * @param cx X-coordinate of the central scan center.
+   * @param cy Y-coordinate of the central scan center.
+   * @param length Length of a scan strip.
+   */
+  OctantScanner (int xmin, int ymin, int xmax, int ymax,
+                 int a, int b, int nbs, bool *steps,
+                 int cx, int cy, int length);
+
+  /**
+   * \brief Returns a copy of the directional scanner.
+   */
+  DirectionalScanner *getCopy ();
+
+  /**
+   * \brief Returns a copy of the directional scanner built in given holder.
+   * @param holder Scanner holder used as copy storage.
+   */
+  DirectionalScanner *getCopy (ScannerHolder &holder);
+
+  /**
+   * \brief Gets the central scan in a vector.
+   * Adds central scan points to given vector and returns its new size.
+   * @param scan Vector of points to be completed.
+   */
+  int first (std::vector<Pt2i> &scan) const;
+
+  /**
+   * \brief Gets the next scan on the left in a vector.
+   * Adds points of next left scan to given vector and returns its new size.
+   * @param scan Vector of points to be completed.
+   */
+  int nextOnLeft (std::vector<Pt2i> &scan);
+
+  /**
+   * \brief Gets the next scan on the right in a vector.
+   * Adds points of next right scan to given vector and returns its new size.
+   * @param scan Vector of points to be completed.
+   */
+  int nextOnRight (std::vector<Pt2i> &scan);
+
+  /**
+   * \brief Appends next scans on the left to a scan strip.
+   * Stops when the strip still gets no pixel (out of scan area).
+   * Returns the count of appended scans.
+   * @param strip Scan strip to be completed.
+   * @param nb Count of required scans.
+   */
+  int nextOnLeft (ScanStrip &strip, int nb);
+
+  /**
+   * \brief Appends next scans on the right to a scan strip.
+   * Stops when the strip still gets no pixel (out of scan area).
+   * Returns the count of appended scans.
+   * @param strip Scan strip to be completed.
+   * @param nb Count of required scans.
+   */
+  int nextOnRight (ScanStrip &strip, int nb);
+
+  /**
+   * \brief Gets next skipped scan to the left in a vector.
+   * Adds points of next left scan to given vector and returns its new size.
+   * @param scan Vector of points to be completed.
+   * @param skip Skip length.
+   */
+  int skipLeft (std::vector<Pt2i> &scan, int skip);
+
+  /**
+   * \brief Gets next skipped scan to the right in a vector.
+   * Adds points of next right scan to given vector and returns its new size.
+   * @param scan Vector of points to be completed.
+   * @param skip Skip length.
+   */
+  int skipRight (std::vector<Pt2i> &scan, int skip);
+
+  /**
+   * \brief Skips scans to the left.
+   * @param skip Skip length.
+   */
+  void skipLeft (int skip);
+
+  /**
+   * \brief Skips scans to the right.
+   * @param skip Skip length.
+   */
+  void skipRight (int skip);
+
+  /**
+   * \brief Binds the scan strip to wrap the given digital line.
+   * Resets bounding lines parameters to center the scan strip on given line.
+   * Has no effect on fixed strip scanners.
+   * @param a Parameter 'a' of given digital line.
+   * @param b Parameter 'b' of given digital line.
+   * @param c Parameter 'c' of given digital line.
+   */
+  void bindTo (int a, int b, int c);
+
+  /**
+   * \brief Returns the scanner coordinates of given point.
+   * Scanner coordinates are the scan index and the position in the scan.
+   * Only fixed strip scanners locate points, others return the point.
+   * @param pt Image coordinates of the point.
+   */
+  Pt2i locate (const Pt2i &pt) const;
+
+
+private:
+
+  /** Scans go along Y axis (octants 1 and 8), or along X axis. */
+  static const bool MAJOR_Y = (OCTANT == 1 || OCTANT == 8);
+  /** Scan direction on its main axis. */
+  static const int MAJOR_DIR = (OCTANT == 2 ? -1 : 1);
+  /** Scan direction on its secondary axis. */
+  static const int MINOR_DIR = (OCTANT == 1 ? -1 : 1);
+  /** Support line value decreases along scans (octants 1 and 2). */
+  static const bool DECREASING = (OCTANT == 1 || OCTANT == 2);
+  /** Left scans are found in secondary scan direction (octants 1 and 7). */
+  static const bool LEFT_MINOR = (OCTANT == 1 || OCTANT == 7);
+  /** Shift of left scans on the secondary scan axis. */
+  static const int LEFT_DIR = (LEFT_MINOR ? MINOR_DIR : - MINOR_DIR);
+
+  /** Current pattern step in strip direction on left side. */
+  bool *lst1;
+  /** Current pattern step in strip direction on right side. */
+  bool *rst1;
+  /** Status indicating no move in strip direction on next left scan. */
+  bool lstop;
+  /** Status indicating no move in strip direction on next right scan. */
+  bool rstop;
+
+  /** Parameter 'a' of template support discrete line template. */
+  int templ_a;
+  /** Parameter 'b' of template support discrete line template. */
+  int templ_b;
+  /** Parameter 'nu' of template support discrete line template. */
+  int templ_nu;
+  /** Shift parameter of the control support discrete line. */
+  int dlc1;
+
+
+  /**
+   * \brief Creates a copy of given directional scanner.
+   * @param ds Source directional scanner.
+   */
+  OctantScanner (OctantScanner *ds);
+
+  /**
+   * \brief Returns the main axis coordinate of a position.
+   * @param x Position X-coordinate.
+   * @param y Position Y-coordinate.
+   */
+  static inline int &mainCoord (int &x, int &y) { return (MAJOR_Y ? y : x); }
+
+  /**
+   * \brief Returns the secondary axis coordinate of a position.
+   * @param x Position X-coordinate.
+   * @param y Position Y-coordinate.
+   */
+  static inline int &sideCoord (int &x, int &y) { return (MAJOR_Y ? x : y); }
+
+  /**
+   * \brief Checks if a main axis coordinate lies in the scan area.
+   * @param val Coordinate value.
+   * @param dir Coordinate move direction.
+   */
+  inline bool majorIn (int val, int dir) const;
+
+  /**
+   * \brief Checks if a secondary axis coordinate lies in the scan area.
+   * @param val Coordinate value.
+   * @param dir Coordinate move direction.
+   */
+  inline bool minorIn (int val, int dir) const;
+
+  /**
+   * \brief Checks if a main axis coordinate is before the scan area.
+   * @param val Coordinate value.
+   * @param dir Coordinate move direction.
+   */
+  inline bool majorBefore (int val, int dir) const;
+
+  /**
+   * \brief Checks if a secondary axis coordinate is before the scan area.
+   * @param val Coordinate value.
+   * @param dir Coordinate move direction.
+   */
+  inline bool minorBefore (int val, int dir) const;
+
+  /**
+   * \brief Checks if a main axis coordinate can move without leaving the area.
+   * @param val Coordinate value.
+   * @param dir Coordinate move direction.
+   */
+  inline bool majorMovable (int val, int dir) const;
+
+  /**
+   * \brief Checks if a position is still before the given bounding line.
+   * @param x Position X-coordinate.
+   * @param y Position Y-coordinate.
+   * @param c Parameter 'c' of the bounding line.
+   */
+  inline bool before (int x, int y, int c) const;
+
+  /**
+   * \brief Checks if a position is behind the given bounding line.
+   * @param x Position X-coordinate.
+   * @param y Position Y-coordinate.
+   * @param c Parameter 'c' of the bounding line.
+   */
+  inline bool behind (int x, int y, int c) const;
+
+  /**
+   * \brief Moves a position one pixel forwards along the scan direction.
+   * @param x Position X-coordinate.
+   * @param y Position Y-coordinate.
+   * @param st Current pattern step.
+   */
+  inline void forwards (int &x, int &y, bool *&st) const;
+
+  /**
+   * \brief Moves a position one pixel backwards along the scan direction.
+   * @param x Position X-coordinate.
+   * @param y Position Y-coordinate.
+   * @param st Current pattern step.
+   */
+  inline void backwards (int &x, int &y, bool *&st) const;
+
+  /**
+   * \brief Adds the points of the scan starting at given position.
+   * Returns the new size of the scan vector.
+   * @param x Start position X-coordinate.
+   * @param y Start position Y-coordinate.
+   * @param nst Pattern step at start position.
+   * @param scan Vector of points to be completed.
+   */
+  inline int scanFrom (int x, int y, bool *nst,
+                       std::vector<Pt2i> &scan) const;
+
+  /**
+   * \brief Moves a fixed strip scan start to the next scan on one side.
+   * @param x Scan start X-coordinate.
+   * @param y Scan start Y-coordinate.
+   * @param st1 Current pattern step in strip direction.
+   * @param st2 Current pattern step in scan direction.
+   * @param stop Status indicating no move in strip direction on next scan.
+   */
+  template <bool LEFT>
+  inline void advance (int &x, int &y, bool *&st1, bool *&st2,
+                       bool &stop) const;
+
+  /**
+   * \brief Moves an adaptive scan start back on the control support line.
+   * @param x Scan start X-coordinate.
+   * @param y Scan start Y-coordinate.
+   * @param st Pattern step at scan start.
+   */
+  inline void realign (int &x, int &y, bool *&st) const;
+
+  /**
+   * \brief Moves the scan start of one side to the next skipped scan.
+   * Returns false if the scan is out of the scan area.
+   * @param skip Skip length.
+   */
+  template <bool LEFT> inline bool moveOn (int skip);
+
+  /**
+   * \brief Gets next skipped scan on one side in a vector.
+   * Adds points of next scan to given vector and returns its new size.
+   * @param scan Vector of points to be completed.
+   * @param skip Skip length.
+   */
+  template <bool LEFT> inline int next (std::vector<Pt2i> &scan, int skip);
+
+  /**
+   * \brief Appends next scans on one side to a scan strip.
+   * Returns the count of appended scans.
+   * @param strip Scan strip to be completed.
+   * @param nb Count of required scans.
+   */
+  template <bool LEFT> inline int nextScans (ScanStrip &strip, int nb);
+};
+
+
+/** Directional scanner for the 1st octant. */
+typedef OctantScanner<1, SCAN_STRIP> DirectionalScannerO1;
+/** Directional scanner for the 2nd octant. */
+typedef OctantScanner<2, SCAN_STRIP> DirectionalScannerO2;
+/** Directional scanner for the 7th octant. */
+typedef OctantScanner<7, SCAN_STRIP> DirectionalScannerO7;
+/** Directional scanner for the 8th octant. */
+typedef OctantScanner<8, SCAN_STRIP> DirectionalScannerO8;
+/** Adaptive directional scanner for the 1st octant. */
+typedef OctantScanner<1, SCAN_ADAPTIVE> AdaptiveScannerO1;
+/** Adaptive directional scanner for the 2nd octant. */
+typedef OctantScanner<2, SCAN_ADAPTIVE> AdaptiveScannerO2;
+/** Adaptive directional scanner for the 7th octant. */
+typedef OctantScanner<7, SCAN_ADAPTIVE> AdaptiveScannerO7;
+/** Adaptive directional scanner for the 8th octant. */
+typedef OctantScanner<8, SCAN_ADAPTIVE> AdaptiveScannerO8;
+/** Vertical adaptive directional scanner for the 1st octant. */
+typedef OctantScanner<1, SCAN_ALIGNED> VHScannerO1;
+/** Horizontal adaptive directional scanner for the 2nd octant. */
+typedef OctantScanner<2, SCAN_ALIGNED> VHScannerO2;
+/** Horizontal adaptive directional scanner for the 7th octant. */
+typedef OctantScanner<7, SCAN_ALIGNED> VHScannerO7;
+/** Vertical adaptive directional scanner for the 8th octant. */
+typedef OctantScanner<8, SCAN_ALIGNED> VHScannerO8;
+
+#endif
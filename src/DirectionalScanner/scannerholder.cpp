@@ -0,0 +1,75 @@
+/*  Copyright 2021 Philippe Even and Phuc Ngo,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "scannerholder.h"
+#include "directionalscanner.h"
+
+
+ScannerHolder::ScannerHolder ()
+{
+  ds = NULL;
+  stps = NULL;
+  stnb = 0;
+}
+
+
+ScannerHolder::~ScannerHolder ()
+{
+  release ();
+  if (stps != NULL) delete [] stps;
+}
+
+
+void ScannerHolder::release ()
+{
+  if (ds != NULL) ds->~DirectionalScanner ();
+  ds = NULL;
+}
+
+
+void *ScannerHolder::place ()
+{
+  release ();
+  return (store);
+}
+
+
+DirectionalScanner *ScannerHolder::hold (DirectionalScanner *scanner)
+{
+  ds = scanner;
+  return (ds);
+}
+
+
+bool *ScannerHolder::steps (int nb)
+{
+  if (nb > stnb)
+  {
+    if (stps != NULL) delete [] stps;
+    stnb = (nb < 2 * stnb ? 2 * stnb : nb);
+    stps = new bool[stnb];
+  }
+  return (stps);
+}
@@ -0,0 +1,114 @@
+/*  Copyright 2021 Philippe Even and Phuc Ngo,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SCANNER_HOLDER_H
+#define SCANNER_HOLDER_H
+
+#include <cstddef>
+#include <new>
+
+class DirectionalScanner;
+
+
+/** 
+ * @class ScannerHolder scannerholder.h
+ * \brief Reusable storage for one directional scanner and its line pattern.
+ * A scanner built in the holder is deleted when another one is built
+ *   in its place, or when the holder is released or deleted.
+ * Storage is kept from one scanner to the next, so that scanners can be
+ *   got again without any heap allocation once the pattern size is reached.
+ */
+class ScannerHolder
+{
+public:
+
+  /** Storage size for any directional scanner. */
+  static const int STORAGE_SIZE = 192;
+
+
+  /**
+   * \brief Creates an empty scanner holder.
+   */
+  ScannerHolder ();
+
+  /**
+   * \brief Deletes the scanner holder and its held scanner.
+   */
+  ~ScannerHolder ();
+
+  /**
+   * \brief Returns the held directional scanner (or NULL).
+   */
+  inline DirectionalScanner *scanner () const { return ds; }
+
+  /**
+   * \brief Deletes the held directional scanner.
+   * Storage is kept for further use.
+   */
+  void release ();
+
+  /**
+   * \brief Returns storage for a new directional scanner.
+   * Formerly held scanner is deleted.
+   */
+  void *place ();
+
+  /**
+   * \brief Holds given directional scanner built in the holder storage.
+   * Returns the held scanner.
+   * @param scanner Directional scanner built with place ().
+   */
+  DirectionalScanner *hold (DirectionalScanner *scanner);
+
+  /**
+   * \brief Returns line pattern storage of at least given size.
+   * @param nb Required count of steps.
+   */
+  bool *steps (int nb);
+
+
+private:
+
+  /** Directional scanner storage. */
+  alignas (std::max_align_t) char store[STORAGE_SIZE];
+  /** Held directional scanner (built in store, or NULL). */
+  DirectionalScanner *ds;
+  /** Line pattern storage. */
+  bool *stps;
+  /** Line pattern storage size. */
+  int stnb;
+
+
+  /**
+   * \brief Forbids holder copy.
+   */
+  ScannerHolder (const ScannerHolder &);
+
+  /**
+   * \brief Forbids holder assignment.
+   */
+  ScannerHolder &operator= (const ScannerHolder &);
+};
+#endif
@@ -23,18 +23,64 @@
 */
 
 #include "scannerprovider.h"
-#include "directionalscannero2.h"
-#include "directionalscannero7.h"
-#include "directionalscannero1.h"
-#include "directionalscannero8.h"
-#include "vhscannero2.h"
-#include "vhscannero7.h"
-#include "vhscannero1.h"
-#include "vhscannero8.h"
+#include "octantscanner.h"
+#include "scannerholder.h"
+
+
+/**
+ * \brief Builds a scanner in given storage, or in the heap if NULL.
+ * @param mem Scanner storage.
+ * @param args Scanner constructor arguments.
+ */
+template <class T, class... Args>
+static DirectionalScanner *make (void *mem, Args... args)
+{
+  return (mem == NULL ? new T (args...) : new (mem) T (args...));
+}
+
+// All octant scanners share the same layout.
+static_assert (sizeof (DirectionalScannerO1) <= ScannerHolder::STORAGE_SIZE,
+               "ScannerHolder storage too small");
 
 
 DirectionalScanner *ScannerProvider::getScanner (Pt2i p1, Pt2i p2,
                                                  bool adaptive)
+{
+  return (buildScanner (NULL, p1, p2, adaptive));
+}
+
+
+DirectionalScanner *ScannerProvider::getScanner (ScannerHolder &holder,
+                                                 Pt2i p1, Pt2i p2,
+                                                 bool adaptive)
+{
+  DirectionalScanner *ds = buildScanner (&holder, p1, p2, adaptive);
+  ds->borrowSteps ();
+  return (holder.hold (ds));
+}
+
+
+DirectionalScanner *ScannerProvider::getScanner (Pt2i centre, Vr2i normal,
+                                                 int length, bool adaptive)
+{
+  return (buildScanner (NULL, centre, normal, length, adaptive));
+}
+
+
+DirectionalScanner *ScannerProvider::getScanner (ScannerHolder &holder,
+                                                 Pt2i centre, Vr2i normal,
+                                                 int length, bool adaptive)
+{
+  DirectionalScanner *ds = buildScanner (&holder, centre, normal,
+                                         length, adaptive);
+  ds->borrowSteps ();
+  return (holder.hold (ds));
+}
+
+
+DirectionalScanner *ScannerProvider::buildScanner (ScannerHolder *holder,
+                                                   Pt2i p1, Pt2i p2,
+                                                   bool adaptive)
 {
   // Enforces P1 to be lower than P2
   // or to left of P2 in case of equality
@@ -49,7 +95,15 @@ DirectionalScanner *ScannerProvider::getScanner (Pt2i p1, Pt2i p2,
 
   // Computes the steps position array
   int nbs = 0;
-  bool *steps = p1.stepsTo (p2, &nbs);
+  bool *steps = NULL;
+  void *mem = NULL;
+  if (holder == NULL) steps = p1.stepsTo (p2, &nbs);
+  else
+  {
+    steps = holder->steps (p1.stepCount (p2));
+    nbs = p1.stepsTo (p2, steps);
+    mem = holder->place ();
+  }
 
   // Equation of the strip support lines : ax + by = c
   int a = p2.x () - p1.x ();
@@ -70,15 +124,17 @@ DirectionalScanner *ScannerProvider::getScanner (Pt2i p1, Pt2i p2,
         int repx = (p1.x () + p2.x ()) / 2;    // central scan start
         int repy = p1.y () - (int) ((p1.x () - repx) * (p1.x () - p2.x ())
                                     / (p2.y () - p1.y ()));
-        return (new VHScannerO1 (xmin, ymin, xmax, ymax,
-                                 a, b, c2, nbs, steps, repx, repy));
+        return (make<VHScannerO1> (mem, xmin, ymin, xmax, ymax,
+                                   a, b, c2, nbs, steps, repx, repy));
       }
       else return (adaptive ?
                    (DirectionalScanner *)
-                   new AdaptiveScannerO1 (xmin, ymin, xmax, ymax,
-                          a, b, c2, nbs, steps, p1.x (), p1.y ()) :
-                   new DirectionalScannerO1 (xmin, ymin, xmax, ymax,
-                          a, b, c2, nbs, steps, p1.x (), p1.y ()));
+                   make<AdaptiveScannerO1> (mem, xmin, ymin, xmax, ymax,
+                                            a, b, c2, nbs, steps,
+                                            p1.x (), p1.y ()) :
+                   make<DirectionalScannerO1> (mem, xmin, ymin, xmax, ymax,
+                                               a, b, c2, nbs, steps,
+                                               p1.x (), p1.y ()));
     }
     else
     {
@@ -87,15 +143,17 @@ DirectionalScanner *ScannerProvider::getScanner (Pt2i p1, Pt2i p2,
         int repy = (p1.y () + p2.y ()) / 2;    // central scan start
         int repx = p1.x () + (int) ((repy - p1.y ()) * (p2.y () - p1.y ())
                                     / (p1.x () - p2.x ()));
-        return (new VHScannerO2 (xmin, ymin, xmax, ymax,
-                                 a, b, c2, nbs, steps, repx, repy));
+        return (make<VHScannerO2> (mem, xmin, ymin, xmax, ymax,
+                                   a, b, c2, nbs, steps, repx, repy));
       }
       else return (adaptive ?
                    (DirectionalScanner *)
-                   new AdaptiveScannerO2 (xmin, ymin, xmax, ymax,
-                          a, b, c2, nbs, steps, p1.x (), p1.y ()) :
-                   new DirectionalScannerO2 (xmin, ymin, xmax, ymax,
-                          a, b, c2, nbs, steps, p1.x (), p1.y ()));
+                   make<AdaptiveScannerO2> (mem, xmin, ymin, xmax, ymax,
+                                            a, b, c2, nbs, steps,
+                                            p1.x (), p1.y ()) :
+                   make<DirectionalScannerO2> (mem, xmin, ymin, xmax, ymax,
+                                               a, b, c2, nbs, steps,
+                                               p1.x (), p1.y ()));
     }
   else
     if (b > a)
@@ -105,15 +163,17 @@ DirectionalScanner *ScannerProvider::getScanner (Pt2i p1, Pt2i p2,
         int repx = (p1.x () + p2.x ()) / 2;    // central scan start
         int repy = p1.y () - (int) ((repx - p1.x ()) * (p2.x () - p1.x ())
                                     / (p2.y () - p1.y ()));
-        return (new VHScannerO8 (xmin, ymin, xmax, ymax,
-                                 a, b, c2, nbs, steps, repx, repy));
+        return (make<VHScannerO8> (mem, xmin, ymin, xmax, ymax,
+                                   a, b, c2, nbs, steps, repx, repy));
       }
       else return (adaptive ?
                    (DirectionalScanner *)
-                   new AdaptiveScannerO8 (xmin, ymin, xmax, ymax,
-                          a, b, c2, nbs, steps, p1.x (), p1.y ()) :
-                   new DirectionalScannerO8 (xmin, ymin, xmax, ymax,
-                          a, b, c2, nbs, steps, p1.x (), p1.y ()));
+                   make<AdaptiveScannerO8> (mem, xmin, ymin, xmax, ymax,
+                                            a, b, c2, nbs, steps,
+                                            p1.x (), p1.y ()) :
+                   make<DirectionalScannerO8> (mem, xmin, ymin, xmax, ymax,
+                                               a, b, c2, nbs, steps,
+                                               p1.x (), p1.y ()));
     }
     else
     {
@@ -122,26 +182,37 @@ DirectionalScanner *ScannerProvider::getScanner (Pt2i p1, Pt2i p2,
         int repy = (p1.y () + p2.y ()) / 2;    // central scan start
         int repx = p1.x () - (int) ((repy - p1.y ()) * (p2.y () - p1.y ())
                                     / (p2.x () - p1.x ()));
-        return (new VHScannerO7 (xmin, ymin, xmax, ymax,
-                                 a, b, c2, nbs, steps, repx, repy));
+        return (make<VHScannerO7> (mem, xmin, ymin, xmax, ymax,
+                                   a, b, c2, nbs, steps, repx, repy));
       }
       else return (adaptive ?
                    (DirectionalScanner *)
-                   new AdaptiveScannerO7 (xmin, ymin, xmax, ymax,
-                          a, b, c2, nbs, steps, p1.x (), p1.y ()) :
-                   new DirectionalScannerO7 (xmin, ymin, xmax, ymax,
-                          a, b, c2, nbs, steps, p1.x (), p1.y ()));
+                   make<AdaptiveScannerO7> (mem, xmin, ymin, xmax, ymax,
+                                            a, b, c2, nbs, steps,
+                                            p1.x (), p1.y ()) :
+                   make<DirectionalScannerO7> (mem, xmin, ymin, xmax, ymax,
+                                               a, b, c2, nbs, steps,
+                                               p1.x (), p1.y ()));
     }
 }
 
 
-DirectionalScanner *ScannerProvider::getScanner (Pt2i centre, Vr2i normal,
-                                                 int length, bool adaptive)
+DirectionalScanner *ScannerProvider::buildScanner (ScannerHolder *holder,
+                                                   Pt2i centre, Vr2i normal,
+                                                   int length, bool adaptive)
 {
   // Gets the steps position array
   int nbs = 0;
-  bool *steps = centre.stepsTo (Pt2i (centre.x () + normal.x (),
-                                      centre.y () + normal.y ()), &nbs);
+  bool *steps = NULL;
+  void *mem = NULL;
+  Pt2i tip (centre.x () + normal.x (), centre.y () + normal.y ());
+  if (holder == NULL) steps = centre.stepsTo (tip, &nbs);
+  else
+  {
+    steps = holder->steps (centre.stepCount (tip));
+    nbs = centre.stepsTo (tip, steps);
+    mem = holder->place ();
+  }
 
   // Orients rightwards
   int a = normal.x ();
@@ -159,63 +230,63 @@ DirectionalScanner *ScannerProvider::getScanner (Pt2i centre, Vr2i normal,
       return (adaptive ?
               (isOrtho ?
                (DirectionalScanner *)
-               new VHScannerO1 (xmin, ymin, xmax, ymax,
-                                a, b, nbs, steps,
-                                centre.x (), centre.y (), length) :
+               make<VHScannerO1> (mem, xmin, ymin, xmax, ymax,
+                                  a, b, nbs, steps,
+                                  centre.x (), centre.y (), length) :
                (DirectionalScanner *)
-               new AdaptiveScannerO1 (xmin, ymin, xmax, ymax,
-                                      a, b, nbs, steps,
-                                      centre.x (), centre.y (), length)) :
-              (DirectionalScanner *)
-              new DirectionalScannerO1 (xmin, ymin, xmax, ymax,
+               make<AdaptiveScannerO1> (mem, xmin, ymin, xmax, ymax,
                                         a, b, nbs, steps,
-                                        centre.x (), centre.y (), length));
+                                        centre.x (), centre.y (), length)) :
+              (DirectionalScanner *)
+              make<DirectionalScannerO1> (mem, xmin, ymin, xmax, ymax,
+                                          a, b, nbs, steps,
+                                          centre.x (), centre.y (), length));
     else
       return (adaptive ?
               (isOrtho ?
                (DirectionalScanner *)
-               new VHScannerO2 (xmin, ymin, xmax, ymax,
-                                a, b, nbs, steps,
-                                centre.x (), centre.y (), length) :
+               make<VHScannerO2> (mem, xmin, ymin, xmax, ymax,
+                                  a, b, nbs, steps,
+                                  centre.x (), centre.y (), length) :
                (DirectionalScanner *)
-               new AdaptiveScannerO2 (xmin, ymin, xmax, ymax,
-                                      a, b, nbs, steps,
-                                      centre.x (), centre.y (), length)) :
-              (DirectionalScanner *)
-              new DirectionalScannerO2 (xmin, ymin, xmax, ymax,
+               make<AdaptiveScannerO2> (mem, xmin, ymin, xmax, ymax,
                                         a, b, nbs, steps,
-                                        centre.x (), centre.y (), length));
+                                        centre.x (), centre.y (), length)) :
+              (DirectionalScanner *)
+              make<DirectionalScannerO2> (mem, xmin, ymin, xmax, ymax,
+                                          a, b, nbs, steps,
+                                          centre.x (), centre.y (), length));
   else
     if (b > a)
       return (adaptive ?
               (isOrtho ?
                (DirectionalScanner *)
-               new VHScannerO8 (xmin, ymin, xmax, ymax,
-                                a, b, nbs, steps,
-                                centre.x (), centre.y (), length) :
+               make<VHScannerO8> (mem, xmin, ymin, xmax, ymax,
+                                  a, b, nbs, steps,
+                                  centre.x (), centre.y (), length) :
                (DirectionalScanner *)
-               new AdaptiveScannerO8 (xmin, ymin, xmax, ymax,
-                                      a, b, nbs, steps,
-                                      centre.x (), centre.y (), length)) :
-              (DirectionalScanner *)
-              new DirectionalScannerO8 (xmin, ymin, xmax, ymax,
+               make<AdaptiveScannerO8> (mem, xmin, ymin, xmax, ymax,
                                         a, b, nbs, steps,
-                                        centre.x (), centre.y (), length));
+                                        centre.x (), centre.y (), length)) :
+              (DirectionalScanner *)
+              make<DirectionalScannerO8> (mem, xmin, ymin, xmax, ymax,
+                                          a, b, nbs, steps,
+                                          centre.x (), centre.y (), length));
     else
       return (adaptive ?
               (isOrtho ?
                (DirectionalScanner *)
-               new VHScannerO7 (xmin, ymin, xmax, ymax,
-                                a, b, nbs, steps,
-                                centre.x (), centre.y (), length) :
+               make<VHScannerO7> (mem, xmin, ymin, xmax, ymax,
+                                  a, b, nbs, steps,
+                                  centre.x (), centre.y (), length) :
                (DirectionalScanner *)
-               new AdaptiveScannerO7 (xmin, ymin, xmax, ymax,
-                                      a, b, nbs, steps,
-                                      centre.x (), centre.y (), length)) :
-              (DirectionalScanner *)
-              new DirectionalScannerO7 (xmin, ymin, xmax, ymax,
+               make<AdaptiveScannerO7> (mem, xmin, ymin, xmax, ymax,
                                         a, b, nbs, steps,
-                                        centre.x (), centre.y (), length));
+                                        centre.x (), centre.y (), length)) :
+              (DirectionalScanner *)
+              make<DirectionalScannerO7> (mem, xmin, ymin, xmax, ymax,
+                                          a, b, nbs, steps,
+                                          centre.x (), centre.y (), length));
 }
 
 
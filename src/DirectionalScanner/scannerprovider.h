@@ -26,6 +26,7 @@
 #define SCANNER_PROVIDER_H
 
 #include "directionalscanner.h"
+#include "scannerholder.h"
 
 
 /** 
@@ -72,6 +73,18 @@ public:
    * @param adaptive Directional scanner adaption modality.
    */
   DirectionalScanner *getScanner (Pt2i p1, Pt2i p2, bool adaptive = false);
+
+  /**
+   * \brief Returns a directional scanner built in given holder.
+   * The scanner and its line pattern are built in holder storage,
+   *   the former scanner of the holder being deleted.
+   * @param holder Scanner holder.
+   * @param p1 Initial scan start point.
+   * @param p2 Initial scan end point.
+   * @param adaptive Directional scanner adaption modality.
+   */
+  DirectionalScanner *getScanner (ScannerHolder &holder,
+                                  Pt2i p1, Pt2i p2, bool adaptive = false);
   
   /**
    * \brief Returns a directional scanner from scan center, vector and length.
@@ -85,6 +98,20 @@ public:
   DirectionalScanner *getScanner (Pt2i centre, Vr2i normal,
                                   int length, bool adaptive = false);
 
+  /**
+   * \brief Returns a directional scanner built in given holder.
+   * The scanner and its line pattern are built in holder storage,
+   *   the former scanner of the holder being deleted.
+   * @param holder Scanner holder.
+   * @param centre Initial scan center.
+   * @param normal Initial scan director vector.
+   * @param length Initial scan length.
+   * @param adaptive Directional scanner adaption modality.
+   */
+  DirectionalScanner *getScanner (ScannerHolder &holder,
+                                  Pt2i centre, Vr2i normal,
+                                  int length, bool adaptive = false);
+
   /**
    * \brief Returns whether the input vector (P1P2 or normal) has been reversed.
    */
@@ -119,5 +146,28 @@ private:
   /** Scan area highest y coordinate. */
   int ymax;
 
+
+  /**
+   * \brief Builds a directional scanner from initial scan end points.
+   * @param holder Scanner holder (scanner built in the heap if NULL).
+   * @param p1 Initial scan start point.
+   * @param p2 Initial scan end point.
+   * @param adaptive Directional scanner adaption modality.
+   */
+  DirectionalScanner *buildScanner (ScannerHolder *holder,
+                                    Pt2i p1, Pt2i p2, bool adaptive);
+
+  /**
+   * \brief Builds a directional scanner from scan center, vector and length.
+   * @param holder Scanner holder (scanner built in the heap if NULL).
+   * @param centre Initial scan center.
+   * @param normal Initial scan director vector.
+   * @param length Initial scan length.
+   * @param adaptive Directional scanner adaption modality.
+   */
+  DirectionalScanner *buildScanner (ScannerHolder *holder,
+                                    Pt2i centre, Vr2i normal,
+                                    int length, bool adaptive);
+
 };
 #endif
@@ -0,0 +1,115 @@
+/*  Copyright 2021 Philippe Even and Phuc Ngo,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef SCAN_STRIP_H
+#define SCAN_STRIP_H
+
+#include <vector>
+#include "pt2i.h"
+
+
+/** 
+ * @class ScanStrip scanstrip.h
+ * \brief Sequence of consecutive scans stored in a flat pixel buffer.
+ * Scan pixels are stored one scan after the other in a single vector,
+ *   scan bounds being given by an offsets array (compressed row layout).
+ * Clearing the strip keeps its storage for the next scans.
+ */
+class ScanStrip
+{
+public:
+
+  /**
+   * \brief Creates an empty scan strip.
+   */
+  ScanStrip ();
+
+  /**
+   * \brief Removes all the scans of the strip.
+   * Allocated storage is kept.
+   */
+  void clear ();
+
+  /**
+   * \brief Returns the count of scans in the strip.
+   */
+  inline int size () const { return ((int) (offsets.size ()) - 1); }
+
+  /**
+   * \brief Returns whether the strip has no pixel.
+   */
+  inline bool empty () const { return (pix.empty ()); }
+
+  /**
+   * \brief Returns the count of pixels of the strip.
+   */
+  inline int pixelCount () const { return ((int) (pix.size ())); }
+
+  /**
+   * \brief Returns all the pixels of the strip, scan after scan.
+   */
+  inline const std::vector<Pt2i> &pixels () const { return pix; }
+
+  /**
+   * \brief Returns the index of the first pixel of a scan in the strip.
+   * @param num Scan index in the strip.
+   */
+  inline int scanStart (int num) const { return (offsets[num]); }
+
+  /**
+   * \brief Returns the pixel count of a scan of the strip.
+   * @param num Scan index in the strip.
+   */
+  inline int scanSize (int num) const {
+    return (offsets[num + 1] - offsets[num]); }
+
+  /**
+   * \brief Returns the first pixel of a scan of the strip.
+   * @param num Scan index in the strip.
+   */
+  inline const Pt2i *scan (int num) const {
+    return (pix.data () + offsets[num]); }
+
+  /**
+   * \brief Returns the pixel buffer to be completed by a scanner.
+   * Pixels appended after the last closed scan form the next scan.
+   */
+  inline std::vector<Pt2i> &buffer () { return pix; }
+
+  /**
+   * \brief Closes the scan formed by the pixels appended to the buffer.
+   */
+  inline void closeScan () { offsets.push_back ((int) (pix.size ())); }
+
+
+private:
+
+  /** Pixels of the strip, scan after scan. */
+  std::vector<Pt2i> pix;
+  /** Index of each scan first pixel, followed by the pixel count. */
+  std::vector<int> offsets;
+};
+#endif
@@ -121,6 +121,25 @@ bool ASImage::mouseToTexture(GLWindow* drawWindow, ASCanvasPos& result) const
 	return viewportToTexture(drawWindow, ASCanvasPos((uint32_t)posX, (uint32_t)posY), result);
 }
 
+void ASImage::visibleArea(ASCanvasPos& areaMin, ASCanvasPos& areaMax) const
+{
+	// Same layout as in Draw
+	double resX = (double)ImGui::GetWindowSize().x;
+	double resY = (double)ImGui::GetWindowSize().y;
+
+	double sizeMult = (zoom + 1) > 0 ? (zoom + 1) : -1.0 / (zoom - 1);
+
+	double minX = (double)imageSize.x / 2 - displayPositionX - resX / (2 * sizeMult);
+	double minY = (double)imageSize.y / 2 - displayPositionY - resY / (2 * sizeMult);
+	double maxX = minX + resX / sizeMult + 1;
+	double maxY = minY + resY / sizeMult + 1;
+
+	areaMin.x = (uint32_t)(minX < 0 ? 0 : (minX > imageSize.x ? imageSize.x : minX));
+	areaMin.y = (uint32_t)(minY < 0 ? 0 : (minY > imageSize.y ? imageSize.y : minY));
+	areaMax.x = (uint32_t)(maxX < 0 ? 0 : (maxX > imageSize.x ? imageSize.x : maxX));
+	areaMax.y = (uint32_t)(maxY < 0 ? 0 : (maxY > imageSize.y ? imageSize.y : maxY));
+}
+
 bool ASImage::viewportToTexture(GLWindow* drawWindow, const ASCanvasPos& viewportPosition, ASCanvasPos& result) const
 {
 	int resX, resY;
@@ -212,6 +231,30 @@ void ASImage::setPixelGrayscale(const uint32_t& posX, const uint32_t& posY, cons
 	bIsTextureDirty = true;
 }
 
+void ASImage::setGrayscale(const uint8_t* greyScales)
+{
+	uint32_t* pixel = textureData;
+	uint32_t* pixelEnd = textureData + imageSize.x * imageSize.y;
+	while (pixel != pixelEnd)
+	{
+		*pixel++ = *greyScales++ * 0x010101u + 0xff000000u;
+	}
+	bIsTextureDirty = true;
+}
+
+void ASImage::setGrayscaleArea(const ASCanvasPos& position, const ASCanvasPos& areaSize, const uint8_t* greyScales)
+{
+	for (uint32_t j = 0; j < areaSize.y; j++)
+	{
+		uint32_t* pixel = textureData + PosToPixelIndex(position.x, position.y + j);
+		for (uint32_t i = 0; i < areaSize.x; i++)
+		{
+			*pixel++ = *greyScales++ * 0x010101u + 0xff000000u;
+		}
+	}
+	bIsTextureDirty = true;
+}
+
 void ASImage::setPixelColor(const ASCanvasPos& position, const ASColor& color)
 {
 	textureData[PosToPixelIndex(position.x, position.y)] = color.asInt();
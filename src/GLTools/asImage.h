@@ -72,6 +72,16 @@ public:
 	*/
 	void setPixelGrayscale(const uint32_t& posX, const uint32_t& posY, const uint8_t& greyScale);
 
+	/**
+	 * @brief Set all pixel values from a greyScale map (row after row, uint8)
+	*/
+	void setGrayscale(const uint8_t* greyScales);
+
+	/**
+	 * @brief Set pixel values of a rectangular area from a greyScale map (row after row, uint8)
+	*/
+	void setGrayscaleArea(const ASCanvasPos& position, const ASCanvasPos& areaSize, const uint8_t* greyScales);
+
 	/**
 	 * @brief Set given pixel value using ASColor
 	*/
@@ -157,6 +167,11 @@ public:
 	*/
 	bool viewportToTexture(GLWindow* drawWindow, const ASCanvasPos& viewportPosition, ASCanvasPos& result) const;
 
+	/**
+	 * @brief get texture area displayed in current imgui window (upper bounds excluded)
+	*/
+	void visibleArea(ASCanvasPos& areaMin, ASCanvasPos& areaMax) const;
+
 	/**
 	 * @brief checks if blue component is not null
 	*/
@@ -28,6 +28,7 @@
 #include "directionalscanner.h"
 #include "asImage.h"
 #include "asPainter.h"
+#include "terrainmap.h"
 
 const int ILSDCrossProfileItem::POS_PRED = 30;
 const int ILSDCrossProfileItem::POS_EST = 25;
@@ -44,7 +45,7 @@ ILSDCrossProfileItem::ILSDCrossProfileItem (ILSDItemControl *item_ctrl)
   scan_area_margin = 5;
   resetControls ();
 
-  image = NULL;
+  dtm = NULL;
   imageWidth = 0;
   imageHeight = 0;
   ptset = NULL;
@@ -95,11 +96,11 @@ std::vector<Pt2i> *ILSDCrossProfileItem::getCurrentScan ()
 }
 
 
-void ILSDCrossProfileItem::setData (ASImage* image, IPtTileSet* pdata)
+void ILSDCrossProfileItem::setData (TerrainMap* map, IPtTileSet* pdata)
 {
-  this->image = image;
-  imageWidth = image->width ();
-  imageHeight = image->height ();
+  dtm = map;
+  imageWidth = map->width ();
+  imageHeight = map->height ();
   ptset = pdata;
   iratio = imageWidth / ptset->xmSpread ();  // (1/csize)
   ctrl->resetScan ();
@@ -163,8 +164,7 @@ void ILSDCrossProfileItem::paintScans ()
         it --;
         if (cx >= alti_area_width + scan_area_margin)
           painter.fillRect (cx, cy, scan_res, scan_res,
-                ASBrush (image->GetPixelColor ((*it).x (),
-                                               imageHeight - 1 - (*it).y ())));
+                ASBrush (pixelColor (*it)));
           cx += scan_res;
       }
       while (cx < w_width - scan_area_margin - scan_res
@@ -179,8 +179,7 @@ void ILSDCrossProfileItem::paintScans ()
     {
       if (cx >= alti_area_width + scan_area_margin)
         painter.fillRect (cx, cy, scan_res, scan_res,
-              ASBrush (image->GetPixelColor ((*it).x (),
-                                             imageHeight - 1 - (*it).y ())));
+              ASBrush (pixelColor (*it)));
       it ++;
       cx += scan_res;
     }
@@ -212,12 +211,10 @@ void ILSDCrossProfileItem::paintScans ()
             if (cx >= alti_area_width + scan_area_margin)
             {
               if (num == 0) painter.fillRect (cx, cy, scan_res, scan_res,
-                   ASBrush (ASColor (image->GetPixelColor ((*it).x (),
-                                        imageHeight - 1 - (*it).y ())).asInt ()
+                   ASBrush (pixelColor (*it).asInt ()
                             & (ASColor::alphaMask | ASColor::greenMask)));
               else painter.fillRect (cx, cy, scan_res, scan_res,
-                   ASBrush (image->GetPixelColor ((*it).x (),
-                                        imageHeight - 1 - (*it).y ())));
+                   ASBrush (pixelColor (*it)));
             }
             cx += scan_res;
           }
@@ -234,12 +231,10 @@ void ILSDCrossProfileItem::paintScans ()
           if (cx >= alti_area_width + scan_area_margin)
           {
             if (num == 0) painter.fillRect (cx, cy, scan_res, scan_res,
-                 ASBrush (ASColor (image->GetPixelColor ((*it).x (),
-                                      imageHeight - 1 - (*it).y ())).asInt ()
+                 ASBrush (pixelColor (*it).asInt ()
                           & (ASColor::alphaMask | ASColor::greenMask)));
             else painter.fillRect (cx, cy, scan_res, scan_res,
-                 ASBrush (image->GetPixelColor ((*it).x (),
-                                      imageHeight - 1 - (*it).y ())));
+                 ASBrush (pixelColor (*it)));
           }
           it ++;
           cx += scan_res;
@@ -276,12 +271,10 @@ void ILSDCrossProfileItem::paintScans ()
             if (cx >= alti_area_width + scan_area_margin)
             {
               if (num == 0) painter.fillRect (cx, cy, scan_res, scan_res,
-                   ASBrush (ASColor (image->GetPixelColor ((*it).x (),
-                                        imageHeight - 1 - (*it).y ())).asInt ()
+                   ASBrush (pixelColor (*it).asInt ()
                             & (ASColor::alphaMask | ASColor::greenMask)));
               else painter.fillRect (cx, cy, scan_res, scan_res,
-                   ASBrush (image->GetPixelColor ((*it).x (),
-                                        imageHeight - 1 - (*it).y ())));
+                   ASBrush (pixelColor (*it)));
             }
             cx += scan_res;
           }
@@ -298,12 +291,10 @@ void ILSDCrossProfileItem::paintScans ()
           if (cx >= alti_area_width + scan_area_margin)
           {
             if (num == 0) painter.fillRect (cx, cy, scan_res, scan_res,
-                 ASBrush (ASColor (image->GetPixelColor ((*it).x (),
-                                      imageHeight - 1 - (*it).y ())).asInt ()
+                 ASBrush (pixelColor (*it).asInt ()
                           & (ASColor::alphaMask | ASColor::greenMask)));
             else painter.fillRect (cx, cy, scan_res, scan_res,
-                 ASBrush (image->GetPixelColor ((*it).x (),
-                                      imageHeight - 1 - (*it).y ())));
+                 ASBrush (pixelColor (*it)));
           }
           it ++;
           cx += scan_res;
@@ -349,11 +340,9 @@ void ILSDCrossProfileItem::paintAlignedScans ()
       {
         if (ctrl->scan () == 0)
           painter.fillRect (cx, cy, scan_res, scan_res,
-               ASBrush (image->GetPixelColor ((*it).x (),
-                                    imageHeight - 1 - (*it).y ())));
+               ASBrush (pixelColor (*it)));
         else painter.fillRect (cx, cy, scan_res, scan_res,
-               ASBrush (ASColor (image->GetPixelColor ((*it).x (),
-                                    imageHeight - 1 - (*it).y ())).asInt ()
+               ASBrush (pixelColor (*it).asInt ()
                         & (ASColor::alphaMask | ASColor::greenMask)));
       }
       cx += scan_res;
@@ -371,11 +360,9 @@ void ILSDCrossProfileItem::paintAlignedScans ()
       {
         if (ctrl->scan () == 0)
           painter.fillRect (cx, cy, scan_res, scan_res,
-               ASBrush (image->GetPixelColor ((*it).x (),
-                                    imageHeight - 1 - (*it).y ())));
+               ASBrush (pixelColor (*it)));
         else painter.fillRect (cx, cy, scan_res, scan_res,
-               ASBrush (ASColor (image->GetPixelColor ((*it).x (),
-                                    imageHeight - 1 - (*it).y ())).asInt ()
+               ASBrush (pixelColor (*it).asInt ()
                         & (ASColor::alphaMask | ASColor::greenMask)));
       }
       it ++;
@@ -408,8 +395,7 @@ void ILSDCrossProfileItem::paintAlignedScans ()
         it --;
         if (cx >= alti_area_width + scan_area_margin)
           painter.fillRect (cx, cy, scan_res, scan_res,
-                            ASBrush (image->GetPixelColor ((*it).x (),
-                                        imageHeight - 1 - (*it).y ())));
+                            ASBrush (pixelColor (*it)));
         cx += scan_res;
       }
       while (cx < w_width - scan_area_margin - scan_res
@@ -423,8 +409,7 @@ void ILSDCrossProfileItem::paintAlignedScans ()
       {
         if (cx >= alti_area_width + scan_area_margin)
           painter.fillRect (cx, cy, scan_res, scan_res,
-                            ASBrush (image->GetPixelColor ((*it).x (),
-                                        imageHeight - 1 - (*it).y ())));
+                            ASBrush (pixelColor (*it)));
         it ++;
         cx += scan_res;
       }
@@ -457,8 +442,7 @@ void ILSDCrossProfileItem::paintAlignedScans ()
         it --;
         if (cx >= alti_area_width + scan_area_margin)
           painter.fillRect (cx, cy, scan_res, scan_res,
-                            ASBrush (image->GetPixelColor ((*it).x (),
-                                        imageHeight - 1 - (*it).y ())));
+                            ASBrush (pixelColor (*it)));
         cx += scan_res;
       }
       while (cx < w_width - scan_area_margin - scan_res
@@ -472,8 +456,7 @@ void ILSDCrossProfileItem::paintAlignedScans ()
       {
         if (cx >= alti_area_width + scan_area_margin)
           painter.fillRect (cx, cy, scan_res, scan_res,
-                            ASBrush (image->GetPixelColor ((*it).x (),
-                                        imageHeight - 1 - (*it).y ())));
+                            ASBrush (pixelColor (*it)));
         it ++;
         cx += scan_res;
       }
@@ -689,3 +672,11 @@ std::string ILSDCrossProfileItem::format (float val) const
   }
   return s;
 }
+
+
+ASColor ILSDCrossProfileItem::pixelColor (const Pt2i &p) const
+{
+  // Read from the map as background image blocks may not be shaded yet
+  uint8_t val = (uint8_t) (dtm->get (p.x (), imageHeight - 1 - p.y ()));
+  return (ASColor (val, val, val, 255));
+}
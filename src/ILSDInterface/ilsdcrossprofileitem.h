@@ -31,7 +31,9 @@
 #include "pt2f.h"
 
 class ASImage;
+class ASColor;
 class GLWindow;
+class TerrainMap;
 class ASPainter;
 struct ASCanvasPos;
 
@@ -57,10 +59,10 @@ public:
 
   /**
    * \brief Declares data to be analysed.
-   * @param image Reference to DTM view.
+   * @param map Reference to DTM normal map.
    * @param pdata Reference to point cloud.
    */
-  virtual void setData (ASImage* image, IPtTileSet* pdata);
+  virtual void setData (TerrainMap* map, IPtTileSet* pdata);
 
   /**
    * \brief Resets the viewer parameters after control changes.
@@ -205,8 +207,8 @@ protected:
   /** Item display controls */
   ILSDItemControl *ctrl;
 
-  /** Analysed image. */
-  ASImage* image;
+  /** Analysed DTM normal map. */
+  TerrainMap* dtm;
   /** Rendered image. */
   ASImage* structImage;
   /* Analysed image width. */
@@ -299,6 +301,12 @@ protected:
    */
   virtual void paintStatus () = 0;
 
+  /**
+   * \brief Returns the DTM shading color of a scan pixel.
+   * @param p Scan pixel.
+   */
+  ASColor pixelColor (const Pt2i &p) const;
+
   /**
    * \brief Draws a clipped line.
    * @param painter Reference to GL context;
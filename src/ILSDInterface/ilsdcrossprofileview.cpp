@@ -81,9 +81,9 @@ ILSDCrossProfileView::~ILSDCrossProfileView ()
 }
 
 
-void ILSDCrossProfileView::setData (ASImage* image, IPtTileSet* pdata)
+void ILSDCrossProfileView::setData (TerrainMap* map, IPtTileSet* pdata)
 {
-  item->setData (image, pdata);
+  item->setData (map, pdata);
 }
 
 
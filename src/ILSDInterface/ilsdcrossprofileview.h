@@ -91,10 +91,10 @@ public:
 
   /**
    * \brief Declares data to be analysed.
-   * @param image DTM map.
+   * @param map DTM normal map.
    * @param pdata Point cloud.
    */
-  void setData (ASImage* image, IPtTileSet* pdata);
+  void setData (TerrainMap* map, IPtTileSet* pdata);
 
   /**
    * \brief Resets the viewer for a new display.
@@ -72,12 +72,15 @@ const int ILSDDetectionWidget::SELECT_TOL = 5;
 
 const int ILSDDetectionWidget::SUBDIV = 5;
 const int ILSDDetectionWidget::MOVE_SHIFT = 10;
+const int ILSDDetectionWidget::SHADE_BLOCK = 256;
+const int ILSDDetectionWidget::MAX_SHADE_LEVEL = 3;
 
 
 ILSDDetectionWidget::ILSDDetectionWidget ()
 {
   // Sets default user inputs parameters
   cloud_access = IPtTile::ECO;
+  tile_budget = 0;
   det_mode = MODE_RIDGE;
   tiles_loaded = false;
   picking = false;
@@ -127,6 +130,7 @@ ILSDDetectionWidget::ILSDDetectionWidget ()
   xShift = 0;
   yShift = 0;
   zoom = 0;
+  block_cols = 0;
 
   string defload = DEFAULT_SETTING_DIR
                    + DEFAULT_SETTING_FILE + string (".ini");
@@ -165,6 +169,12 @@ void ILSDDetectionWidget::saveSettings (const std::string& path)
 void ILSDDetectionWidget::saveSettings (IniLoader *iload)
 {
   iload->SetPropertyAsInt("ASD", "CloudAccess", cloud_access);
+  iload->SetPropertyAsBool("ASD", "MemoryMapping", ptset.memoryMapping ());
+  iload->SetPropertyAsBool("ASD", "PackedTiles", ptset.packedFormat ());
+  iload->SetPropertyAsBool("ASD", "TilePrefetching", ptset.prefetching ());
+  iload->SetPropertyAsInt("ASD", "TileCacheBudget", tile_budget);
+  iload->SetPropertyAsBool("ASD", "PackedNormalMaps",
+                           dtm_map.packedFormat ());
   iload->SetPropertyAsInt("ASD", "DetectionMode", det_mode);
 
   if (cp_view != NULL)
@@ -214,6 +224,17 @@ void ILSDDetectionWidget::loadSettings (IniLoader *iload)
 {
   int access = iload->GetPropertyAsInt ("ASD", "CloudAccess", cloud_access);
   if (access != cloud_access) setCloudAccess (access);
+  ptset.setMemoryMapping (iload->GetPropertyAsBool ("ASD", "MemoryMapping",
+                                                    ptset.memoryMapping ()));
+  ptset.setPackedFormat (iload->GetPropertyAsBool ("ASD", "PackedTiles",
+                                                   ptset.packedFormat ()));
+  ptset.setPrefetching (iload->GetPropertyAsBool ("ASD", "TilePrefetching",
+                                                 ptset.prefetching ()));
+  tile_budget = iload->GetPropertyAsInt ("ASD", "TileCacheBudget",
+                                         tile_budget);
+  if (tile_budget > 0) ptset.setCacheBudget (((int64_t) tile_budget) << 20);
+  dtm_map.setPackedFormat (iload->GetPropertyAsBool ("ASD",
+                          "PackedNormalMaps", dtm_map.packedFormat ()));
 
   int mode = iload->GetPropertyAsInt ("ASD", "DetectionMode", det_mode);
   if (mode != det_mode)
@@ -818,6 +839,7 @@ void ILSDDetectionWidget::saveGroundTruth (const std::string& path)
 
 void ILSDDetectionWidget::saveScreen (const std::string& path)
 {
+  if (completeShading ()) displayDetectionResult ();
   augmentedImage.save (path.c_str ());
 }
 
@@ -877,7 +899,8 @@ void ILSDDetectionWidget::loadTiles (const std::string& path)
         nvmfile += sval + TerrainMap::NVM_SUFFIX;
         bool tl = dtm_map.addNormalMapFile (nvmfile);
         if (tl) tiles_loaded = ptset.addTile (TIL_DIR, std::string (sval),
-                                              cloud_access) || tiles_loaded;
+                                   cloud_access, tile_budget <= 0)
+                               || tiles_loaded;
       }
     }
   }
@@ -904,15 +927,10 @@ void ILSDDetectionWidget::createMap ()
     iratio = width / ptset.xmSpread ();
 
     loadedImage = ASImage (ASCanvasPos (width, height));
-    for (int j = 0; j < height; j++)
-      for (int i = 0; i < width; i++)
-      {
-        int val = dtm_map.get (i, j);
-        loadedImage.setPixelGrayscale (i, j, val);
-      }
+    rebuildImage ();
     augmentedImage = loadedImage;
 
-    if (cp_view != NULL) cp_view->setData (&loadedImage, &ptset);
+    if (cp_view != NULL) cp_view->setData (&dtm_map, &ptset);
     if (lp_view != NULL) lp_view->setData (&loadedImage, &ptset);
 
     xMaxShift = (width > maxWidth ? maxWidth - width : 0);
@@ -929,13 +947,71 @@ ASCanvasPos ILSDDetectionWidget::widgetSize ()
 
 void ILSDDetectionWidget::rebuildImage ()
 {
-  for (int j = 0; j < height; j++)
-    for (int i = 0; i < width; i++)
+  block_cols = (width + SHADE_BLOCK - 1) / SHADE_BLOCK;
+  block_levels.assign (block_cols * ((height + SHADE_BLOCK - 1) / SHADE_BLOCK),
+                       -1);
+}
+
+
+bool ILSDDetectionWidget::shadeVisibleBlocks ()
+{
+  ASCanvasPos vmin, vmax;
+  augmentedImage.visibleArea (vmin, vmax);
+  int level = 0;
+  for (int f = 1 - zoom; f > 1 && level < MAX_SHADE_LEVEL; f /= 2) level ++;
+  bool shaded = false;
+  for (int bj = vmin.y / SHADE_BLOCK; bj * SHADE_BLOCK < (int) vmax.y; bj ++)
+    for (int bi = vmin.x / SHADE_BLOCK; bi * SHADE_BLOCK < (int) vmax.x; bi ++)
     {
-      int val = dtm_map.get (i, j);
-      loadedImage.setPixelGrayscale (i, j, (char) val);
+      int &blev = block_levels[bj * block_cols + bi];
+      if (blev == -1 || blev > level)
+      {
+        shadeBlock (bi, bj, level);
+        blev = level;
+        shaded = true;
+      }
+    }
+  return shaded;
+}
+
+
+bool ILSDDetectionWidget::completeShading ()
+{
+  bool shaded = false;
+  for (int k = 0; k < (int) (block_levels.size ()); k ++)
+    if (block_levels[k] != 0)
+    {
+      shadeBlock (k % block_cols, k / block_cols, 0);
+      block_levels[k] = 0;
+      shaded = true;
     }
-  augmentedImage = loadedImage;
+  return shaded;
+}
+
+
+void ILSDDetectionWidget::shadeBlock (int bi, int bj, int level)
+{
+  int imin = bi * SHADE_BLOCK, jmin = bj * SHADE_BLOCK;
+  int bw = (imin + SHADE_BLOCK > width ? width - imin : SHADE_BLOCK);
+  int bh = (jmin + SHADE_BLOCK > height ? height - jmin : SHADE_BLOCK);
+  unsigned char *gmap = new unsigned char[bw * bh];
+  if (level == 0) dtm_map.shade (gmap, imin, jmin, bw, bh);
+  else
+  {
+    // Blocks start on pyramid pixels, each replicated on the block
+    if (dtm_map.pyramidLevels () < level) dtm_map.buildPyramid (level);
+    int lw = ((imin + bw - 1) >> level) - (imin >> level) + 1;
+    int lh = ((jmin + bh - 1) >> level) - (jmin >> level) + 1;
+    unsigned char *lmap = new unsigned char[lw * lh];
+    dtm_map.shade (lmap, imin >> level, jmin >> level, lw, lh, level);
+    for (int j = 0; j < bh; j ++)
+      for (int i = 0; i < bw; i ++)
+        gmap[j * bw + i] = lmap[(j >> level) * lw + (i >> level)];
+    delete [] lmap;
+  }
+  loadedImage.setGrayscaleArea (ASCanvasPos (imin, jmin),
+                                ASCanvasPos (bw, bh), gmap);
+  delete [] gmap;
 }
 
 
@@ -995,6 +1071,7 @@ void ILSDDetectionWidget::incZoom (int dir)
 bool ILSDDetectionWidget::saveAugmentedImage (const string& fileName,
                                               const char* fileFormat)
 {
+  if (completeShading ()) displayDetectionResult ();
   ASImage aImage = augmentedImage;
   return (aImage.save (fileName.data (), fileFormat));
 }
@@ -1097,8 +1174,8 @@ void ILSDDetectionWidget::addToGroundTruth ()
       {
         ASPainter painter (gtImage);
         if (ctrack_style != CTRACK_DISP_SCANS)
-          displayConnectedTrack (painter, ASColor::WHITE);
-        else displayCarriageTrack (painter, ASColor::WHITE);
+          displayConnectedTrack (painter, tdetector, ASColor::WHITE);
+        else displayCarriageTrack (painter, tdetector, ASColor::WHITE);
         tdetector.clear ();
       }
     }
@@ -1109,8 +1186,8 @@ void ILSDDetectionWidget::addToGroundTruth ()
       {
         ASPainter painter (gtImage);
         if (ridge_style != RIDGE_DISP_SCANS)
-          displayConnectedRidge (painter, ASColor::WHITE);
-        else displayRidge (painter, ASColor::WHITE);
+          displayConnectedRidge (painter, rdetector, ASColor::WHITE);
+        else displayRidge (painter, rdetector, ASColor::WHITE);
         rdetector.clear ();
       }
     }
@@ -1130,6 +1207,8 @@ void ILSDDetectionWidget::loadSelection (const std::vector<std::string>& paths)
     savstroke.clear ();
     augmentedImage.clear (ASColor::WHITE);
     ASPainter painter (&augmentedImage);
+    sbatch.clear ();
+    std::vector<Pt2i> sels;
     strk >> x1;
     while (! strk.eof ())
     {
@@ -1147,26 +1226,31 @@ void ILSDDetectionWidget::loadSelection (const std::vector<std::string>& paths)
           && pi2.x () >= 0 && pi2.y () >= 0
           && pi2.x () < width && pi2.y () < height)
       {
-        drawSelection (painter, pi1, pi2);
-        if (det_mode == MODE_CTRACK)
-        {
-          tdetector.detect (pi1, pi2);
-          if (ctrack_style != CTRACK_DISP_SCANS)
-            displayConnectedTrack (painter, ASColor::BLACK);
-          else
-            displayCarriageTrack (painter, ASColor::BLACK);
-        }
-        else if (det_mode & MODE_RIDGE_OR_HOLLOW)
-        {
-          rdetector.detect (pi1, pi2);
-          if (ridge_style != RIDGE_DISP_SCANS)
-            displayConnectedRidge (painter, ASColor::BLACK);
-          else displayRidge (painter, ASColor::BLACK);
-        }
+        sels.push_back (pi1);
+        sels.push_back (pi2);
+        sbatch.addStroke (pi1, pi2);
       }
       strk >> x1;
     }
     strk.close ();
+
+    // Strokes are detected concurrently, and displayed in stroke order
+    if (det_mode == MODE_CTRACK)
+      sbatch.detectTracks (tdetector, [&] (int i, CTrackDetector &det) {
+        drawSelection (painter, sels[2 * i], sels[2 * i + 1]);
+        if (ctrack_style != CTRACK_DISP_SCANS)
+          displayConnectedTrack (painter, det, ASColor::BLACK);
+        else displayCarriageTrack (painter, det, ASColor::BLACK); });
+    else if (det_mode & MODE_RIDGE_OR_HOLLOW)
+      sbatch.detectRidges (rdetector, [&] (int i, RidgeDetector &det) {
+        drawSelection (painter, sels[2 * i], sels[2 * i + 1]);
+        if (ridge_style != RIDGE_DISP_SCANS)
+          displayConnectedRidge (painter, det, ASColor::BLACK);
+        else displayRidge (painter, det, ASColor::BLACK); });
+    else
+      for (int i = 0; i < (int) (sels.size ()); i += 2)
+        drawSelection (painter, sels[i], sels[i + 1]);
+    sbatch.clear ();
     if (det_mode == MODE_CTRACK) tdetector.clear ();
     else if (det_mode & MODE_RIDGE_OR_HOLLOW) rdetector.clear ();
     for (int j = 0; j < height; j++)
@@ -1234,11 +1318,12 @@ void ILSDDetectionWidget::paintEvent (GLWindow* drawWindow)
                       | ImGuiWindowFlags_NoDecoration
                       | ImGuiWindowFlags_NoInputs))
     {
+      augmentedImage.setZoom (zoom);
+      augmentedImage.setDisplayPosition (xShift, yShift);
+      if (shadeVisibleBlocks ()) to_update = true;
 //      with_aux_update = false;
       if (to_update) displayDetectionResult ();
 //      with_aux_update = true;
-      augmentedImage.setZoom (zoom);
-      augmentedImage.setDisplayPosition (xShift, yShift);
       augmentedImage.Draw (drawWindow);
       ImGui::End ();
     }
@@ -1347,7 +1432,7 @@ void ILSDDetectionWidget::switchCrossProfileAnalyzer ()
     }
     else cp_view = new ILSDCrossProfileView (GLWindow::getMainWindow (), exists,
                                              pos, SUBDIV, &ictrl, this);
-    cp_view->setData (&loadedImage, &ptset);
+    cp_view->setData (&dtm_map, &ptset);
     cp_view->buildScans (p1, p2);
     cp_view->update ();
   }
@@ -1660,6 +1745,7 @@ void ILSDDetectionWidget::setBlackLevel (int val)
 
 void ILSDDetectionWidget::capture (string fname)
 {
+  if (completeShading ()) displayDetectionResult ();
   augmentedImage.save (fname.c_str ());
 }
 
@@ -1751,14 +1837,14 @@ void ILSDDetectionWidget::displayDetectionResult ()
     if (det_mode == MODE_CTRACK)
     {
       if (ctrack_style != CTRACK_DISP_SCANS)
-        displayConnectedTrack (painter, structure_color);
-      else displayCarriageTrack (painter, structure_color);
+        displayConnectedTrack (painter, tdetector, structure_color);
+      else displayCarriageTrack (painter, tdetector, structure_color);
     }
     else if (det_mode & MODE_RIDGE_OR_HOLLOW)
     {
       if (ridge_style != RIDGE_DISP_SCANS)
-        displayConnectedRidge (painter, structure_color);
-      else displayRidge (painter, structure_color);
+        displayConnectedRidge (painter, rdetector, structure_color);
+      else displayRidge (painter, rdetector, structure_color);
     }
     else if (cp_view != NULL && udef && ! p1.equals (p2))
       displayStraightStrip (painter, p1, p2);
@@ -1869,9 +1955,11 @@ void ILSDDetectionWidget::displayAnalyzedScan (ASPainter& painter)
 }
 
 
-void ILSDDetectionWidget::displayCarriageTrack (ASPainter& painter, ASColor col)
+void ILSDDetectionWidget::displayCarriageTrack (ASPainter& painter,
+                                                CTrackDetector& det,
+                                                ASColor col)
 {
-  CarriageTrack* ct = tdetector.getCarriageTrack ();
+  CarriageTrack* ct = det.getCarriageTrack ();
   if (ct != NULL)
   {
     painter.setPen (ASPen (col, THIN_PEN));
@@ -1885,9 +1973,10 @@ void ILSDDetectionWidget::displayCarriageTrack (ASPainter& painter, ASColor col)
 
 
 void ILSDDetectionWidget::displayConnectedTrack (ASPainter& painter,
+                                                 CTrackDetector& det,
                                                  ASColor col)
 {
-  CarriageTrack* ct = tdetector.getCarriageTrack ();
+  CarriageTrack* ct = det.getCarriageTrack ();
   if (ct != NULL)
   {
     Plateau* pl = ct->plateau (0);
@@ -1897,7 +1986,7 @@ void ILSDDetectionWidget::displayConnectedTrack (ASPainter& painter,
       painter.setPen (ASPen (col));
 
       Pt2i pp1, pp2;
-      tdetector.getInputStroke (pp1, pp2);
+      det.getInputStroke (pp1, pp2);
       Vr2i p12 = pp1.vectorTo (pp2);
       float l12 = (float) (sqrt (p12.norm2 ()));
       int mini = -ct->getRightScanCount ();
@@ -2024,9 +2113,10 @@ void ILSDDetectionWidget::displayConnectedPlateau (ASPainter& painter,
 }
 
 
-void ILSDDetectionWidget::displayRidge (ASPainter& painter, ASColor col)
+void ILSDDetectionWidget::displayRidge (ASPainter& painter,
+                                        RidgeDetector& det, ASColor col)
 {
-  Ridge* ridge = rdetector.getRidge ();
+  Ridge* ridge = det.getRidge ();
   if (ridge != NULL)
   {
     Bump* bump = ridge->bump (0);
@@ -2035,7 +2125,7 @@ void ILSDDetectionWidget::displayRidge (ASPainter& painter, ASColor col)
       painter.setPen (ASPen (col, THIN_PEN));
 
       Pt2i pp1, pp2;
-      rdetector.getInputStroke (pp1, pp2);
+      det.getInputStroke (pp1, pp2);
       Vr2i p12 = pp1.vectorTo (pp2);
       float l12 = (float) (sqrt (p12.norm2 ()));
       int mini = - ridge->getRightScanCount ();
@@ -2065,9 +2155,10 @@ void ILSDDetectionWidget::displayRidge (ASPainter& painter, ASColor col)
 
 
 void ILSDDetectionWidget::displayConnectedRidge (ASPainter& painter,
+                                                 RidgeDetector& det,
                                                  ASColor col)
 {
-  Ridge* rdg = rdetector.getRidge ();
+  Ridge* rdg = det.getRidge ();
   if (rdg != NULL)
   {
     Bump* bmp = rdg->bump (0);
@@ -2081,7 +2172,7 @@ void ILSDDetectionWidget::displayConnectedRidge (ASPainter& painter,
       else painter.setPen (ASPen (col, THICK_PEN));
 
       Pt2i pp1, pp2;
-      rdetector.getInputStroke (pp1, pp2);
+      det.getInputStroke (pp1, pp2);
       Vr2i p12 = pp1.vectorTo (pp2);
       float l12 = (float) (sqrt (p12.norm2 ()));
       int mini = - rdg->getRightScanCount ();
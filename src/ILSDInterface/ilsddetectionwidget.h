@@ -26,6 +26,7 @@
 #include "ipttileset.h"
 #include "ctrackdetector.h"
 #include "ridgedetector.h"
+#include "strokebatch.h"
 #include "ilsdcrossprofileview.h"
 #include "ilsdlongprofileview.h"
 #include "terrainmap.h"
@@ -387,6 +388,7 @@ public:
 
   /**
    * \brief Rebuilds the background image after lighting modification.
+   * Only displayed blocks of the image are shaded, at next repaint.
    */
   void rebuildImage ();
 
@@ -730,6 +732,10 @@ private:
   static const int SUBDIV;
   /** DTM map move increment. */
   static const int MOVE_SHIFT;
+  /** Size of lazily shaded blocks of the background image. */
+  static const int SHADE_BLOCK;
+  /** Highest normal map pyramid level used for zoomed out views. */
+  static const int MAX_SHADE_LEVEL;
 
 
   /** Initial scan start point. */
@@ -797,6 +803,9 @@ private:
   float cellsize;
   /** Cloud access speed level. */
   int cloud_access;
+  /** Memory budget of tiles loaded on demand (in MB), none if not positive.
+   *  Tile points are all loaded with tile set creation if no budget is set. */
+  int tile_budget;
 
   /** Maximal window width. */
   int maxWidth;
@@ -815,6 +824,10 @@ private:
 
   /** DTM normal map. */
   TerrainMap dtm_map;
+  /** Shading level of background image blocks (-1 if not yet shaded). */
+  std::vector<int> block_levels;
+  /** Count of columns of background image blocks. */
+  int block_cols;
   /** Detector mode. */
   int det_mode;
   /** Flag indicating if the window title should change. */
@@ -823,6 +836,8 @@ private:
   CTrackDetector tdetector;
   /** Ridge structure detector. */
   RidgeDetector rdetector;
+  /** Concurrent detection contexts of loaded stroke lists. */
+  StrokeBatch sbatch;
   /** Cross profile view. */
   ILSDCrossProfileView* cp_view;
   /** Longitudinal profile view. */
@@ -950,6 +965,27 @@ private:
    */
   void drawGroundTruth (ASPainter &painter);
 
+  /**
+   * \brief Shades the background image blocks displayed in the window.
+   * Zoomed out views are shaded from the normal map pyramid.
+   * Returns whether some block was shaded.
+   */
+  bool shadeVisibleBlocks ();
+
+  /**
+   * \brief Shades all the background image blocks at full resolution.
+   * Returns whether some block was shaded.
+   */
+  bool completeShading ();
+
+  /**
+   * \brief Shades a block of the background image.
+   * @param bi Block column.
+   * @param bj Block row.
+   * @param level Normal map pyramid level.
+   */
+  void shadeBlock (int bi, int bj, int level);
+
   /**
    * \brief Lighten the image according to the black level set.
    * @param im Image to lighten.
@@ -1022,30 +1058,38 @@ private:
   /**
    * \brief Displays plateaux of detected carriage track.
    * @param painter Display support.
+   * @param det Carriage track detector holding the result.
    * @param col Displayed track color.
    */
-  void displayCarriageTrack (ASPainter& painter, ASColor col = ASColor::GREEN);
+  void displayCarriageTrack (ASPainter& painter, CTrackDetector& det,
+                             ASColor col = ASColor::GREEN);
 
   /**
    * \brief Displays connected plateaux of detected carriage track.
    * @param painter Display support.
+   * @param det Carriage track detector holding the result.
    * @param col Detected track display color.
    */
-  void displayConnectedTrack (ASPainter& painter, ASColor col = ASColor::GREEN);
+  void displayConnectedTrack (ASPainter& painter, CTrackDetector& det,
+                              ASColor col = ASColor::GREEN);
 
   /**
    * \brief Displays the detected ridge.
    * @param painter Display support.
+   * @param det Ridge detector holding the result.
    * @param col Detected ridge display color.
    */
-  void displayRidge (ASPainter& painter, ASColor col = ASColor::GREEN);
+  void displayRidge (ASPainter& painter, RidgeDetector& det,
+                     ASColor col = ASColor::GREEN);
 
   /**
    * \brief Displays connected bumps of detected ridge.
    * @param painter Display support.
+   * @param det Ridge detector holding the result.
    * @param col Detected ridge display color.
    */
-  void displayConnectedRidge (ASPainter& painter, ASColor col = ASColor::GREEN);
+  void displayConnectedRidge (ASPainter& painter, RidgeDetector& det,
+                              ASColor col = ASColor::GREEN);
 
   /**
    * \brief Selects a detection stroke.
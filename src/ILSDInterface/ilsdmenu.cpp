@@ -68,6 +68,7 @@ ILSDMenu::ILSDMenu ()
   rdetector = NULL;
   showDemoWindow = false;
   import_parent = NULL;
+  import_ground = false;
 }
 
 
@@ -136,16 +137,18 @@ bool ILSDMenu::drawFileMenu (GLWindow* parent)
       explo->OnCancelExplorer.Add (det_widget, &ILSDDetectionWidget::noAction);
       explo->OnDestroy.Add (det_widget, &ILSDDetectionWidget::enableKeys);
     }
-    if (ImGui::MenuItem ("Import XYZ/ASC tile"))
+    if (ImGui::MenuItem ("Import XYZ/LAS/ASC tile"))
     {
       import_parent = parent;
       det_widget->disableKeys ();
-      FileExplorer* explo = new FileExplorer (parent, "Select XYZ point tile",
+      FileExplorer* explo = new FileExplorer (parent,
+                                              "Select XYZ or LAS point tile",
                                               ".");
       explo->OnApplyPath.Add (this, &ILSDMenu::importPointTile);
       explo->OnCancelExplorer.Add (det_widget, &ILSDDetectionWidget::noAction);
       explo->OnDestroy.Add (det_widget, &ILSDDetectionWidget::enableKeys);
     }
+    ImGui::Checkbox ("LAS ground points only", &import_ground);
     ImGui::Separator();
 
     if (det_widget->tilesLoaded ())
@@ -1652,6 +1655,7 @@ void ILSDMenu::importDTMTiles (const std::vector<std::string>& paths)
 {
   // Prepares the new NVM file
   TerrainMap mappy;
+  mappy.setPackedFormat (dtm_map->packedFormat ());
   if (! mappy.addDtmFile (paths[0]))
   {
     std::cout << "Problem with file " << paths[0] << std::endl;
@@ -1693,12 +1697,12 @@ void ILSDMenu::importDTMTiles (const std::vector<std::string>& paths)
       }
     }
   }
-  if (! mappy.createMapFromDtm ())
+  std::vector<std::string> nvmnames (1, nvmfile);
+  if (! mappy.saveNormalMapsFromDtm (nvmnames))
   {
-    std::cout << "DTM fusion failed" << std::endl;
+    std::cout << "DTM conversion failed" << std::endl;
     return;
   }
-  mappy.saveFirstNormalMap (nvmfile);
 
   // Creates the new TIL tile
   std::string tilfile = TIL_DIR;
@@ -1714,7 +1718,20 @@ void ILSDMenu::importDTMTiles (const std::vector<std::string>& paths)
                 (tilwidth * subdiv) / det_widget->cloudAccess ());
   tile.setArea (tilxmin, tilymin, (int64_t) 0,
                 (int) ((tilcs * det_widget->cloudAccess ()) / subdiv + 0.5));
-  tile.loadXYZFile (import_tile, det_widget->cloudAccess ());
+  size_t lsuf = import_tile.length () - IPtTile::LAS_SUFFIX.length ();
+  if (import_tile.length () > IPtTile::LAS_SUFFIX.length ()
+      && (import_tile.compare (lsuf, std::string::npos,
+                               IPtTile::LAS_SUFFIX) == 0
+          || import_tile.compare (lsuf, std::string::npos, ".LAS") == 0))
+  {
+    if (! tile.loadLASFile (import_tile, det_widget->cloudAccess (),
+                            import_ground))
+    {
+      std::cout << "Problem with file " << import_tile << std::endl;
+      return;
+    }
+  }
+  else tile.loadXYZFile (import_tile, det_widget->cloudAccess ());
   tile.save (tilfile);
   std::vector<std::string> outnames;
   outnames.push_back (paths[0]);
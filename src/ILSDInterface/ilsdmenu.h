@@ -82,6 +82,8 @@ private:
   GLWindow* import_parent;
   /** Import point tile name. */
   std::string import_tile;
+  /** Ground points only import modality of LAS tiles. */
+  bool import_ground;
 
 
   /**
@@ -153,7 +155,7 @@ private:
   void drawSelectionInfo (GLWindow* parent, int sy);
 
   /**
-   * \brief Imports a point tile from xyz format to local til format.
+   * \brief Imports a point tile from xyz or las format to local til format.
    * @param path Names of selected files.
    */
   void importPointTile (const std::vector<std::string>& paths);
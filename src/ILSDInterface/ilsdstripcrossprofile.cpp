@@ -47,9 +47,9 @@ std::string ILSDStripCrossProfile::profileName () const
 }
 
 
-void ILSDStripCrossProfile::setData (ASImage* image, IPtTileSet* pdata)
+void ILSDStripCrossProfile::setData (TerrainMap* map, IPtTileSet* pdata)
 {
-  ILSDCrossProfileItem::setData (image, pdata);
+  ILSDCrossProfileItem::setData (map, pdata);
   scanp.setSize (subdiv * imageWidth, subdiv * imageHeight);
   scani.setSize (imageWidth, imageHeight);
 }
@@ -209,39 +209,32 @@ void ILSDStripCrossProfile::updateProfile ()
 
     bool initialized = false;
     int lastscan = (ctrl->scan () + 1) * subdiv - subdiv / 2;
+    std::vector<Pt3f> pts;
     for (int curscan = lastscan - subdiv;
          curscan < lastscan; curscan ++)
     {
-      std::vector<Pt2i> scan;
-      if (curscan >= 0) scan = leftscan.at (curscan);
-      else scan = rightscan.at (- curscan - 1);
-
-      std::vector<Pt2i>::iterator it = scan.begin ();
-      while (it != scan.end ())
+      pts.clear ();
+      if (curscan >= 0) ptset->collectScanPoints (pts, leftscan.at (curscan));
+      else ptset->collectScanPoints (pts, rightscan.at (- curscan - 1));
+      std::vector<Pt3f>::iterator pit = pts.begin ();
+      while (pit != pts.end ())
       {
-        std::vector<Pt3f> pts;
-        ptset->collectPoints (pts, it->x (), it->y ());
-        std::vector<Pt3f>::iterator pit = pts.begin ();
-        while (pit != pts.end ())
+        if (initialized)
+        {
+          if (pit->z () < minz) minz = pit->z ();
+          if (pit->z () > maxz) maxz = pit->z ();
+        }
+        else
         {
-          if (initialized)
-          {
-            if (pit->z () < minz) minz = pit->z ();
-            if (pit->z () > maxz) maxz = pit->z ();
-          }
-          else
-          {
-            minz = pit->z ();
-            maxz = pit->z ();
-            initialized = true;
-          }
-          double vx = pit->x () * iratio - np1.x () - 0.5;
-          double vy = pit->y () * iratio - np1.y () - 0.5;
-          current_points.push_back (
-            Pt2f ((float) ((vx * scanx + vy * scany) / iratio), pit->z ()));
-          pit ++;
+          minz = pit->z ();
+          maxz = pit->z ();
+          initialized = true;
         }
-        it ++;
+        double vx = pit->x () * iratio - np1.x () - 0.5;
+        double vy = pit->y () * iratio - np1.y () - 0.5;
+        current_points.push_back (
+          Pt2f ((float) ((vx * scanx + vy * scany) / iratio), pit->z ()));
+        pit ++;
       }
     }
     hrefc = (minz + maxz) / 2;
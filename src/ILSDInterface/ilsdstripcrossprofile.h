@@ -54,10 +54,10 @@ public:
 
   /**
    * \brief Declares data to be analysed.
-   * @param image Reference to DTM view.
+   * @param map Reference to DTM normal map.
    * @param pdata Reference to point cloud.
    */
-  void setData (ASImage* image, IPtTileSet* pdata);
+  void setData (TerrainMap* map, IPtTileSet* pdata);
 
   /**
    * \brief Sets the image scan area from an initial scan.
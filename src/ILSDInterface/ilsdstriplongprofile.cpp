@@ -24,6 +24,7 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <algorithm>
 #include "ilsdstriplongprofile.h"
 #include "directionalscanner.h"
 #include "asImage.h"
@@ -70,174 +71,70 @@ void ILSDStripLongProfile::buildProfile (Pt2i pt1, Pt2i pt2)
   float dist = (float) (sqrt (scanx2 + scany2) / iratio);
   reversed = (pt1.x () > pt2.x ());
 
+  // Gets the scanned cells, and the subcells averaged for each one
+  std::vector<Pt2i> scan;
+  int rad = 0, mul = 1;
   if (ctrl->isThinLongStrip ())
   {
     Pt2i spt (pt1.x () * subdiv + subdiv / 2, pt1.y () * subdiv + subdiv / 2);
     Pt2i ept (pt2.x () * subdiv + subdiv / 2, pt2.y () * subdiv + subdiv / 2);
-    std::vector<Pt2i> scan;
     spt.draw (scan, ept);
-    dist /= (int) (scan.size ());
-    int pos = 0;
-    bool heightToFix = true;
-    if (reversed)
-    {
-      std::vector<Pt2i>::iterator it = scan.end ();
-      while (it != scan.begin ())
-      {
-        it --;
-        std::vector<Pt3f> pts;
-        ptset->collectPoints (pts, it->x (), it->y ());
-        if (! pts.empty ())
-        {
-          float hm = 0.0f;
-          std::vector<Pt3f>::iterator pit = pts.begin ();
-          while (pit != pts.end ())
-          {
-            hm += pit->z ();
-            pit ++;
-          }
-          hm /= (int) (pts.size ());   // average height
-          if (heightToFix)
-          {
-            zmin = hm;
-            zmax = hm;
-            heightToFix = false;
-          }
-          else
-          {
-            if (hm < zmin) zmin = hm;
-            else if (hm > zmax) zmax = hm;
-          }
-          profile.push_back (Pt2f (pos * dist, hm));
-          index.push_back (pos - ((int) (scan.size ())) / 2);
-        }
-        pos ++;
-      }
-    }
-    else
-    {
-      std::vector<Pt2i>::iterator it = scan.begin ();
-      while (it != scan.end ())
-      {
-        std::vector<Pt3f> pts;
-        ptset->collectPoints (pts, it->x (), it->y ());
-        if (! pts.empty ())
-        {
-          float hm = 0.0f;
-          std::vector<Pt3f>::iterator pit = pts.begin ();
-          while (pit != pts.end ())
-          {
-            hm += pit->z ();
-            pit ++;
-          }
-          hm /= (int) (pts.size ());   // average height
-          if (heightToFix)
-          {
-            zmin = hm;
-            zmax = hm;
-            heightToFix = false;
-          }
-          else
-          {
-            if (hm < zmin) zmin = hm;
-            else if (hm > zmax) zmax = hm;
-          }
-          profile.push_back (Pt2f (pos * dist, hm));
-          index.push_back (pos - ((int) (scan.size ())) / 2);
-        }
-        pos ++;
-        it ++;
-      }
-    }
-    profile_length = pos * dist;
   }
   else
   {
     Pt2i spt (pt1.x (), pt1.y ());
     Pt2i ept (pt2.x (), pt2.y ());
-    std::vector<Pt2i> scan;
     spt.draw (scan, ept);
-    dist /= (int) (scan.size ());
-    int pos = 0;
-    bool heightToFix = true;
-    if (reversed)
+    rad = subdiv / 2;
+    mul = subdiv;
+  }
+  if (reversed) std::reverse (scan.begin (), scan.end ());
+  dist /= (int) (scan.size ());
+  int nbsub = (2 * rad + 1) * (2 * rad + 1);
+  std::vector<Pt2i> subcells;
+  subcells.reserve (scan.size () * nbsub);
+  std::vector<Pt2i>::iterator it = scan.begin ();
+  while (it != scan.end ())
+  {
+    for (int j = - rad; j <= rad; j ++)
+      for (int i = - rad; i <= rad; i ++)
+        subcells.push_back (Pt2i (mul * it->x () + i, mul * it->y () + j));
+    it ++;
+  }
+
+  // Collects all the points at once, then averages them cell by cell
+  std::vector<Pt3f> pts;
+  std::vector<int> ends;
+  ptset->collectScanPoints (pts, subcells, &ends);
+  int pos = 0;
+  int start = 0;
+  bool heightToFix = true;
+  for (int k = 0; k < (int) (scan.size ()); k ++)
+  {
+    int end = ends[(k + 1) * nbsub - 1];
+    if (end != start)
     {
-      std::vector<Pt2i>::iterator it = scan.end ();
-      while (it != scan.begin ())
+      float hm = 0.0f;
+      for (int p = start; p < end; p ++) hm += pts[p].z ();
+      hm /= end - start;   // average height
+      if (heightToFix)
       {
-        it --;
-        std::vector<Pt3f> pts;
-        for (int j = - subdiv / 2; j <= subdiv / 2; j ++)
-          for (int i = - subdiv / 2; i <= subdiv / 2; i ++)
-            ptset->collectPoints (pts, subdiv * it->x () + i,
-                                       subdiv * it->y () + j);
-        if (! pts.empty ())
-        {
-          float hm = 0.0f;
-          std::vector<Pt3f>::iterator pit = pts.begin ();
-          while (pit != pts.end ())
-          {
-            hm += pit->z ();
-            pit ++;
-          }
-          hm /= (int) (pts.size ());   // average height
-          if (heightToFix)
-          {
-            zmin = hm;
-            zmax = hm;
-            heightToFix = false;
-          }
-          else
-          {
-            if (hm < zmin) zmin = hm;
-            else if (hm > zmax) zmax = hm;
-          }
-          profile.push_back (Pt2f (pos * dist, hm));
-          index.push_back (pos - ((int) (scan.size ())) / 2);
-        }
-        pos ++;
+        zmin = hm;
+        zmax = hm;
+        heightToFix = false;
       }
-    }
-    else
-    {
-      std::vector<Pt2i>::iterator it = scan.begin ();
-      while (it != scan.end ())
+      else
       {
-        std::vector<Pt3f> pts;
-        for (int j = - subdiv / 2; j <= subdiv / 2; j ++)
-          for (int i = - subdiv / 2; i <= subdiv / 2; i ++)
-            ptset->collectPoints (pts, subdiv * it->x () + i,
-                                       subdiv * it->y () + j);
-        if (! pts.empty ())
-        {
-          float hm = 0.0f;
-          std::vector<Pt3f>::iterator pit = pts.begin ();
-          while (pit != pts.end ())
-          {
-            hm += pit->z ();
-            pit ++;
-          }
-          hm /= (int) (pts.size ());   // average height
-          if (heightToFix)
-          {
-            zmin = hm;
-            zmax = hm;
-            heightToFix = false;
-          }
-          else
-          {
-            if (hm < zmin) zmin = hm;
-            else if (hm > zmax) zmax = hm;
-          }
-          profile.push_back (Pt2f (pos * dist, hm));
-          index.push_back (pos - ((int) (scan.size ())) / 2);
-        }
-        pos ++;
-        it ++;
+        if (hm < zmin) zmin = hm;
+        else if (hm > zmax) zmax = hm;
       }
+      profile.push_back (Pt2f (pos * dist, hm));
+      index.push_back (pos - ((int) (scan.size ())) / 2);
     }
-    profile_length = pos * dist;
+    start = end;
+    pos ++;
   }
+  profile_length = pos * dist;
   if (profile.empty ()) drawable = false;
   else setScale ();
 }
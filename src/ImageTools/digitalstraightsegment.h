@@ -27,6 +27,7 @@
 
 #include "digitalstraightline.h"
 #include "absrat.h"
+#include "objectarena.h"
 
 
 /** 
@@ -38,7 +39,7 @@
  *   vertical lines (min <= x <= max) if the segment is horizontal.
  * The bound points belong to the digital straight segment.
  */
-class DigitalStraightSegment : public DigitalStraightLine
+class DigitalStraightSegment : public DigitalStraightLine, public ArenaObject
 {
 public:
 
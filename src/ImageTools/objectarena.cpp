@@ -0,0 +1,152 @@
+/*  Copyright 2021 Philippe Even and Phuc Ngo,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <new>
+#include "objectarena.h"
+
+const size_t ObjectArena::BLOCK_SIZE = 65536;
+const size_t ObjectArena::HEADER_SIZE = alignof (std::max_align_t);
+
+/** Arena used by each thread. */
+static thread_local ObjectArena *current_arena = NULL;
+
+
+ObjectArena::ObjectArena ()
+{
+  region = new Region ();
+  used = 0;
+  last = -1;
+}
+
+
+ObjectArena::~ObjectArena ()
+{
+  reset ();
+  delete region;
+}
+
+
+bool ObjectArena::reset ()
+{
+  used = 0;
+  last = -1;
+  if (region->alive == 0)
+  {
+    region->release ();
+    return true;
+  }
+  // Remaining objects keep the region up to the last one release
+  region->detached = true;
+  region = new Region ();
+  return false;
+}
+
+
+size_t ObjectArena::footprint () const
+{
+  size_t size = 0;
+  std::vector<size_t>::const_iterator it = region->sizes.begin ();
+  while (it != region->sizes.end ()) size += *it++;
+  return size;
+}
+
+
+ObjectArena *ObjectArena::current ()
+{
+  return current_arena;
+}
+
+
+void *ObjectArena::allocate (size_t size)
+{
+  size = (size + HEADER_SIZE - 1) / HEADER_SIZE * HEADER_SIZE;
+  region->alive ++;
+  if (size > BLOCK_SIZE / 4)
+  {
+    // Large objects get their own block
+    region->blocks.push_back (new char[size]);
+    region->sizes.push_back (size);
+    return (region->blocks.back ());
+  }
+  if (last == -1 || used + size > BLOCK_SIZE)
+  {
+    region->blocks.push_back (new char[BLOCK_SIZE]);
+    region->sizes.push_back (BLOCK_SIZE);
+    last = (int) (region->blocks.size ()) - 1;
+    used = 0;
+  }
+  char *ptr = region->blocks[last] + used;
+  used += size;
+  return ptr;
+}
+
+
+void *ObjectArena::allocateObject (size_t size)
+{
+  // Header records the owner region (NULL for heap)
+  ObjectArena *arena = current_arena;
+  char *mem = (arena != NULL ?
+               static_cast<char *> (arena->allocate (size + HEADER_SIZE)) :
+               static_cast<char *> (::operator new (size + HEADER_SIZE)));
+  *(reinterpret_cast<Region **> (mem)) =
+    (arena != NULL ? arena->region : NULL);
+  return (mem + HEADER_SIZE);
+}
+
+
+void ObjectArena::releaseObject (void *ptr)
+{
+  if (ptr == NULL) return;
+  char *mem = static_cast<char *> (ptr) - HEADER_SIZE;
+  Region *reg = *(reinterpret_cast<Region **> (mem));
+  if (reg == NULL) ::operator delete (mem);
+  else if (-- reg->alive == 0 && reg->detached)
+  {
+    reg->release ();
+    delete reg;
+  }
+}
+
+
+void ObjectArena::Region::release ()
+{
+  std::vector<char *>::iterator it = blocks.begin ();
+  while (it != blocks.end ()) delete [] *it++;
+  blocks.clear ();
+  sizes.clear ();
+}
+
+
+ObjectArena::Scope::Scope (ObjectArena *arena)
+{
+  former = current_arena;
+  current_arena = arena;
+}
+
+
+ObjectArena::Scope::~Scope ()
+{
+  current_arena = former;
+}
@@ -0,0 +1,192 @@
+/*  Copyright 2021 Philippe Even and Phuc Ngo,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OBJECT_ARENA_H
+#define OBJECT_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+
+/** 
+ * @class ObjectArena objectarena.h
+ * \brief Monotonic memory arena for objects created during a detection.
+ * Objects deriving from ArenaObject are taken from the arena that is
+ *   current in the creating thread, or from the heap if none is set.
+ * Deleting them runs their destructor but only releases arena memory
+ *   all at once, when the arena is reset with no object left alive.
+ * Otherwise the memory is detached from the arena on reset, so that
+ *   remaining objects may outlive it, and released with the last of them.
+ * An arena must be used by one thread at a time.
+ */
+class ObjectArena
+{
+public:
+
+  /**
+   * \brief Creates an empty arena.
+   */
+  ObjectArena ();
+
+  /**
+   * \brief Deletes the arena.
+   * Memory blocks are detached if some arena object is still alive.
+   */
+  ~ObjectArena ();
+
+  /**
+   * \brief Releases all the arena memory in one shot.
+   * Returns false if some object is still alive : the memory is then
+   *   detached from the arena, and released when no object is left.
+   */
+  bool reset ();
+
+  /**
+   * \brief Returns the count of alive objects taken from the arena.
+   */
+  inline int aliveObjects () const { return region->alive; }
+
+  /**
+   * \brief Returns the arena memory size in bytes.
+   */
+  size_t footprint () const;
+
+  /**
+   * \brief Returns the arena used by current thread (or NULL).
+   */
+  static ObjectArena *current ();
+
+  /**
+   * \brief Allocates memory for an arena object.
+   * Memory is taken from current thread arena, or from the heap.
+   * @param size Object size.
+   */
+  static void *allocateObject (size_t size);
+
+  /**
+   * \brief Releases memory of an arena object.
+   * @param ptr Object memory.
+   */
+  static void releaseObject (void *ptr);
+
+
+  /**
+   * @class Scope objectarena.h
+   * \brief Sets the current thread arena while in scope.
+   */
+  class Scope
+  {
+  public:
+
+    /**
+     * \brief Sets current thread arena up to scope end.
+     * @param arena Arena to use.
+     */
+    Scope (ObjectArena *arena);
+
+    /**
+     * \brief Restores formerly used arena.
+     */
+    ~Scope ();
+
+  private:
+
+    /** Formerly used arena. */
+    ObjectArena *former;
+  };
+
+
+private:
+
+  /** Size of standard arena blocks. */
+  static const size_t BLOCK_SIZE;
+  /** Size of object header (keeps max alignment). */
+  static const size_t HEADER_SIZE;
+
+  /**
+   * @class Region objectarena.h
+   * \brief Memory blocks shared by the objects taken from them.
+   */
+  struct Region
+  {
+    /** Allocated blocks. */
+    std::vector<char *> blocks;
+    /** Sizes of allocated blocks. */
+    std::vector<size_t> sizes;
+    /** Count of alive objects. */
+    int alive;
+    /** Detachment status from the arena. */
+    bool detached;
+
+    /**
+     * \brief Creates an empty region.
+     */
+    Region () : alive (0), detached (false) { }
+
+    /**
+     * \brief Frees all the region blocks.
+     */
+    void release ();
+  };
+
+  /** Memory region in use. */
+  Region *region;
+  /** Used size in the last standard block. */
+  size_t used;
+  /** Index of the last standard block (-1 if none). */
+  int last;
+
+
+  /**
+   * \brief Takes memory in the arena.
+   * @param size Requested size.
+   */
+  void *allocate (size_t size);
+};
+
+
+/** 
+ * @class ArenaObject objectarena.h
+ * \brief Base of classes whose instances are taken from current arena.
+ */
+class ArenaObject
+{
+public:
+
+  /**
+   * \brief Allocates object memory in current arena (or heap).
+   * @param size Object size.
+   */
+  static void *operator new (size_t size) {
+    return ObjectArena::allocateObject (size); }
+
+  /**
+   * \brief Releases object memory.
+   * @param ptr Object memory.
+   */
+  static void operator delete (void *ptr) {
+    ObjectArena::releaseObject (ptr); }
+};
+#endif
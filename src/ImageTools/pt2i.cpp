@@ -574,6 +574,14 @@ Pt2i *Pt2i::pathTo (Pt2i p, int *n) const
 
 
 bool *Pt2i::stepsTo (Pt2i p, int *n) const
+{
+  bool *paliers = new bool[stepCount (p)];
+  *n = stepsTo (p, paliers);
+  return (paliers); 
+}
+
+
+int Pt2i::stepsTo (Pt2i p, bool *paliers) const
 {
   bool negx = p.xp < xp;
   bool negy = p.yp < yp;
@@ -593,8 +601,6 @@ bool *Pt2i::stepsTo (Pt2i p, int *n) const
   dy *= 2;
 
   int x = 0;
-  *n = x2;
-  bool *paliers = new bool[x2];
   while (x < x2)
   {
     e -= dy;
@@ -605,7 +611,7 @@ bool *Pt2i::stepsTo (Pt2i p, int *n) const
     }
     else paliers[x++] = false;
   }
-  return (paliers); 
+  return (x2); 
 }
 
 
@@ -200,6 +200,23 @@ public:
    */
   bool *stepsTo (Pt2i p, int *n) const;
 
+  /**
+   * \brief Fills steps location of the straight segment to given point.
+   * Returns the count of filled steps.
+   * @param p Given point.
+   * @param steps Provided array of at least stepCount (p) elements.
+   */
+  int stepsTo (Pt2i p, bool *steps) const;
+
+  /**
+   * \brief Returns the count of steps of the straight segment to given point.
+   * @param p Given point.
+   */
+  inline int stepCount (Pt2i p) const {
+    int dx = (xp > p.xp ? xp - p.xp : p.xp - xp);
+    int dy = (yp > p.yp ? yp - p.yp : p.yp - yp);
+    return (dx > dy ? dx : dy); }
+
   /**
    * \brief Returns an orthogonal segment to the segment to given point.
    * @param p2 Given point.
@@ -0,0 +1,121 @@
+/*  Copyright 2021 Philippe Even, Phuc Ngo and Pierre Even,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cstring>
+#include "ascreader.h"
+#include "decimalparser.h"
+
+const int AscReader::CHUNK_SIZE = 1 << 20;
+
+
+AscReader::AscReader ()
+{
+  buf = new char[CHUNK_SIZE];
+  start = 0;
+  end = 0;
+}
+
+
+AscReader::~AscReader ()
+{
+  delete [] buf;
+}
+
+
+bool AscReader::open (const std::string &name)
+{
+  ascf.open (name.c_str (), std::ios::in | std::ifstream::binary);
+  start = 0;
+  end = 0;
+  return ascf.is_open ();
+}
+
+
+void AscReader::close ()
+{
+  ascf.close ();
+}
+
+
+bool AscReader::skip (int nb)
+{
+  const char *word;
+  int len;
+  while (nb-- > 0) if (! nextWord (word, len)) return false;
+  return true;
+}
+
+
+bool AscReader::read (double *vals, int nb)
+{
+  const char *word;
+  int len;
+  for (int i = 0; i < nb; i ++)
+  {
+    if (! nextWord (word, len)) return false;
+    if (parseDecimal (word, word + len, vals[i]) == NULL) return false;
+  }
+  return true;
+}
+
+
+bool AscReader::nextWord (const char *&word, int &len)
+{
+  do
+  {
+    while (start != end && (unsigned char) buf[start] <= ' ') start ++;
+    if (start == end && ! refill ()) return false;
+  }
+  while (start == end || (unsigned char) buf[start] <= ' ');
+  int i = start;
+  while (true)
+  {
+    while (i != end && (unsigned char) buf[i] > ' ') i ++;
+    if (i != end) break;
+    // Word cut by the chunk end
+    i -= start;
+    if (! refill ()) break;
+    i += start;
+  }
+  word = buf + start;
+  len = i - start;
+  start = i;
+  return true;
+}
+
+
+bool AscReader::refill ()
+{
+  if (start != 0)
+  {
+    std::memmove (buf, buf + start, end - start);
+    end -= start;
+    start = 0;
+  }
+  if (end == CHUNK_SIZE || ! ascf) return false;
+  ascf.read (buf + end, CHUNK_SIZE - end);
+  int nb = (int) ascf.gcount ();
+  end += nb;
+  return (nb != 0);
+}
@@ -0,0 +1,109 @@
+/*  Copyright 2021 Philippe Even, Phuc Ngo and Pierre Even,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef ASC_READER_H
+#define ASC_READER_H
+
+#include <string>
+#include <fstream>
+
+
+/** 
+ * @class AscReader ascreader.h
+ * \brief Sequential reader of values of ESRI ASCII grid (ASC) files.
+ * The file is read by chunks and parsed in place, without stream formatting.
+ */
+class AscReader
+{
+public:
+
+  /**
+   * \brief Creates an ASC file reader.
+   */
+  AscReader ();
+
+  /**
+   * \brief Deletes the ASC file reader.
+   */
+  ~AscReader ();
+
+  /**
+   * \brief Opens an ASC file.
+   * Returns whether the file could be opened.
+   * @param name ASC file name.
+   */
+  bool open (const std::string &name);
+
+  /**
+   * \brief Closes the ASC file.
+   */
+  void close ();
+
+  /**
+   * \brief Skips next words of the file.
+   * Returns whether all the words were found.
+   * @param nb Count of words to skip.
+   */
+  bool skip (int nb);
+
+  /**
+   * \brief Reads next values of the file.
+   * Returns whether all the values were read.
+   * @param vals Array of values to fill in.
+   * @param nb Count of values to read.
+   */
+  bool read (double *vals, int nb);
+
+
+private:
+
+  /** Size of the read chunks. */
+  static const int CHUNK_SIZE;
+
+  /** Read file. */
+  std::ifstream ascf;
+  /** Chunk buffer. */
+  char *buf;
+  /** Position of the next character in the buffer. */
+  int start;
+  /** Count of characters in the buffer. */
+  int end;
+
+
+  /**
+   * \brief Finds the next word of the file.
+   * Returns whether a word was found.
+   * @param word Returned word start.
+   * @param len Returned word length.
+   */
+  bool nextWord (const char *&word, int &len);
+
+  /**
+   * \brief Loads next chunk, keeping remaining characters.
+   * Returns whether new characters were loaded.
+   */
+  bool refill ();
+};
+
+#endif
@@ -0,0 +1,64 @@
+/*  Copyright 2021 Philippe Even, Phuc Ngo and Pierre Even,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef DECIMAL_PARSER_H
+#define DECIMAL_PARSER_H
+
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+
+
+/**
+ * \brief Reads a decimal value at the start of a character range.
+ * A leading plus sign is accepted, but no leading space.
+ * Returns the end of the read value, or NULL if no value could be read.
+ * Floating-point std::from_chars is used when the standard library
+ *   provides it (not the case of older libc++ releases), otherwise
+ *   strtod on a bounded copy of the value, with the C numeric locale.
+ * @param start Range start.
+ * @param end Range end.
+ * @param val Read value.
+ */
+inline const char *parseDecimal (const char *start, const char *end,
+                                 double &val)
+{
+  if (start != end && *start == '+') start ++;
+#if defined (__cpp_lib_to_chars)
+  std::from_chars_result res = std::from_chars (start, end, val);
+  return (res.ec == std::errc () ? res.ptr : NULL);
+#else
+  char word[64];
+  int len = (int) (end - start);
+  if (len > 63) len = 63;
+  memcpy (word, start, len);
+  word[len] = '\0';
+  if (len == 0 || (unsigned char) word[0] <= ' ') return NULL;
+  char *wend = NULL;
+  val = strtod (word, &wend);
+  return (wend == word ? NULL : start + (wend - word));
+#endif
+}
+
+#endif
@@ -24,7 +24,51 @@
 
 #include <iostream>
 #include <fstream>
+#include <cstring>
+#include <climits>
 #include "ipttile.h"
+#include "decimalparser.h"
+#include "workerpool.h"
+
+
+/** Appends an unsigned value in variable length (7 bits per byte). */
+static inline void putVarint (std::vector<unsigned char> &buf, unsigned int val)
+{
+  while (val >= 0x80)
+  {
+    buf.push_back ((unsigned char) (val | 0x80));
+    val >>= 7;
+  }
+  buf.push_back ((unsigned char) val);
+}
+
+/** Reads an unsigned value in variable length and moves the read pointer. */
+static inline unsigned int getVarint (const unsigned char *&buf)
+{
+  unsigned int val = 0;
+  int shift = 0;
+  unsigned char byte;
+  do
+  {
+    byte = *buf++;
+    val |= ((unsigned int) (byte & 0x7f)) << shift;
+    shift += 7;
+  }
+  while (byte & 0x80);
+  return val;
+}
+
+/** Maps a signed value to an unsigned one, small in absolute value. */
+static inline unsigned int zigzag (int val)
+{
+  return ((((unsigned int) val) << 1) ^ (unsigned int) (val >> 31));
+}
+
+/** Maps back an unsigned value to the signed one. */
+static inline int unzigzag (unsigned int val)
+{
+  return ((int) (val >> 1) ^ - (int) (val & 1));
+}
 
 
 const int IPtTile::XYZ_UNIT = 1000; // assumed to be 1 meter
@@ -43,8 +87,17 @@ const std::string IPtTile::TIL_SUFFIX = std::string (".til");
 const std::string IPtTile::LAB_SUFFIX = std::string (".tpl");
 const std::string IPtTile::XYZ_SUFFIX = std::string (".xyz");
 const std::string IPtTile::XYZL_SUFFIX = std::string (".xyzl");
+const std::string IPtTile::LAS_SUFFIX = std::string (".las");
 
 const int IPtTile::R_OFF = 5;
+const int IPtTile::HEADER_SIZE = 4 * sizeof (int) + 3 * sizeof (int64_t);
+const int IPtTile::PACKED_TAG = -2;
+const int IPtTile::PACK_BLOCK = 16;
+const int IPtTile::XYZ_CHUNK_MIN = 1 << 20;
+const int IPtTile::SUBCELL_INDEX_MIN = 64;
+const int IPtTile::LAS_HEADER_MIN = 227;
+const int IPtTile::LAS_HEADER_MIN_14 = 375;
+const int IPtTile::LAS_GROUND = 2;
 
 
 IPtTile::IPtTile (int nbrows, int nbcols)
@@ -61,6 +114,15 @@ IPtTile::IPtTile (int nbrows, int nbcols)
   for (int i = 0; i < rows * cols + 1; i++) cells[i] = 0;
   points = NULL;
   labels = NULL;
+  mapping = NULL;
+  pdata = NULL;
+  pblocks = NULL;
+  pdone = NULL;
+  plock = NULL;
+  psize = 0;
+  sindex = NULL;
+  sstarts = NULL;
+  snb = 0;
 }
 
 
@@ -78,6 +140,15 @@ IPtTile::IPtTile (std::string name)
   cells = NULL;
   points = NULL;
   labels = NULL;
+  mapping = NULL;
+  pdata = NULL;
+  pblocks = NULL;
+  pdone = NULL;
+  plock = NULL;
+  psize = 0;
+  sindex = NULL;
+  sstarts = NULL;
+  snb = 0;
 }
 
 
@@ -98,14 +169,22 @@ IPtTile::IPtTile (const std::string &dir, const std::string &name, int acc)
   cells = NULL;
   points = NULL;
   labels = NULL;
+  mapping = NULL;
+  pdata = NULL;
+  pblocks = NULL;
+  pdone = NULL;
+  plock = NULL;
+  psize = 0;
+  sindex = NULL;
+  sstarts = NULL;
+  snb = 0;
 }
 
 
 IPtTile::~IPtTile ()
 {
-  if (points != NULL) delete [] points;
+  unload ();
   if (labels != NULL) delete [] labels;
-  if (cells != NULL) delete [] cells;
 }
 
 
@@ -172,6 +251,7 @@ void IPtTile::setData (std::vector<Pt3i> pts, std::vector<int> inds)
   int *cl = cells;
   std::vector<int>::iterator iit = inds.begin ();
   while (iit != inds.end ()) *cl++ = *iit++;
+  createSubcellIndex ();
 }
 
 
@@ -184,6 +264,7 @@ void IPtTile::setCountOfPoints (int nb)
 
 bool IPtTile::getPoints (std::vector<Pt3i> &pts, int i, int j) const
 {
+  if (pdata != NULL) unpackCell (j * cols + i);
   int k = cells[j * cols + i];
   Pt3i *pt = points + k;
   while (k++ < cells[j * cols + i + 1]) pts.push_back (*pt++);
@@ -193,6 +274,7 @@ bool IPtTile::getPoints (std::vector<Pt3i> &pts, int i, int j) const
 
 int IPtTile::collectCellPoints (std::vector<Pt3i> &pts, int i, int j) const
 {
+  if (pdata != NULL) unpackCell (j * cols + i);
   int k = cells[j * cols + i];
   Pt3i *pt = points + k;
   while (k++ < cells[j * cols + i + 1]) pts.push_back (*pt++);
@@ -205,10 +287,8 @@ int IPtTile::collectSubcellPoints (std::vector<Pt3i> &pts, int i, int j) const
   if (cellSize () == MIN_CELL_SIZE) return (collectCellPoints (pts, i, j));
   int nbpts = 0;
   int nbsub = cellSize () / MIN_CELL_SIZE;
-  Pt3i *pt = points + cells[(j / nbsub) * cols + (i / nbsub)];
-  Pt3i *ptfin = pt + cellSize (i / nbsub, j / nbsub);
-  while (pt->y () < j * MIN_CELL_SIZE && pt != ptfin) pt ++;
-  while (pt->x () < i * MIN_CELL_SIZE && pt != ptfin) pt ++;
+  Pt3i *pt = subcellStartPt (i, j);
+  Pt3i *ptfin = points + cells[(j / nbsub) * cols + (i / nbsub) + 1];
   while (pt->x () < (i + 1) * MIN_CELL_SIZE
          && pt->y () < (j + 1) * MIN_CELL_SIZE && pt != ptfin)
   {
@@ -226,6 +306,7 @@ void IPtTile::setPoints (int nb, const IPtTile &tin)
   points = new Pt3i[nb];
   cells = new int[rows * cols + 1];
   int div = tin.cellSize () / csize;
+  if (tin.pdata != NULL) tin.unpackAll ();
   int nbpts = 0;
   int *c = cells;
   Pt3i *pout = points;
@@ -253,6 +334,7 @@ void IPtTile::setPoints (int nb, const IPtTile &tin)
     std::cout << (xmin / 1000) << "_" << (ymin / 1000)
               << ": NB theorique = " << nb << " et NB found = " << nbpts
               << std::endl;
+  createSubcellIndex ();
 }
 
 
@@ -287,6 +369,17 @@ void IPtTile::setPoints (const IPtTile &tin)
       cumul += (int) (pts.size ());
       *c++ = cumul;
     }
+  createSubcellIndex ();
+}
+
+
+void IPtTile::convert (const IPtTile &tin, int acc)
+{
+  int inacc = tin.cellSize () / MIN_CELL_SIZE;
+  setSize ((tin.countOfColumns () * inacc) / acc,
+           (tin.countOfRows () * inacc) / acc);
+  setArea (tin.xref (), tin.yref (), tin.top (), MIN_CELL_SIZE * acc);
+  setPoints (tin);
 }
 
 
@@ -294,6 +387,7 @@ bool IPtTile::save (std::string name) const
 {
   std::ofstream fpts (name.c_str (), std::ios::out | std::ofstream::binary);
   if (! fpts.is_open ()) return false;
+  if (pdata != NULL) unpackAll ();
   fpts.write ((char *) (&cols), sizeof (int));
   fpts.write ((char *) (&rows), sizeof (int));
   fpts.write ((char *) (&xmin), sizeof (int64_t));
@@ -314,93 +408,343 @@ bool IPtTile::save () const
 }
 
 
-bool IPtTile::load (std::string name, bool all)
+bool IPtTile::savePacked (std::string name) const
 {
-  std::ifstream fpts (name.c_str (), std::ios::in | std::ifstream::binary);
+  std::ofstream fpts (name.c_str (), std::ios::out | std::ofstream::binary);
   if (! fpts.is_open ()) return false;
-  fpts.read ((char *) (&cols), sizeof (int));
-  fpts.read ((char *) (&rows), sizeof (int));
-  fpts.read ((char *) (&xmin), sizeof (int64_t));
-  fpts.read ((char *) (&ymin), sizeof (int64_t));
-  fpts.read ((char *) (&zmax), sizeof (int64_t));
-  fpts.read ((char *) (&csize), sizeof (int));
-  fpts.read ((char *) (&nb), sizeof (int));
-  if (all)
+  if (pdata != NULL) unpackAll ();
+
+  // Cell sizes
+  std::vector<unsigned char> cnts;
+  for (int c = 0; c < rows * cols; c++) putVarint (cnts, cells[c+1] - cells[c]);
+  while (cnts.size () % sizeof (int64_t) != 0) cnts.push_back (0);
+
+  // Points coded by difference to previous point in the cell
+  int nblocks = (rows * cols + PACK_BLOCK - 1) / PACK_BLOCK;
+  std::vector<int64_t> blocks;
+  std::vector<unsigned char> data;
+  data.reserve ((size_t) nb * 5);
+  for (int c = 0; c < rows * cols; c++)
   {
-    if (cells != NULL)
+    if (c % PACK_BLOCK == 0) blocks.push_back ((int64_t) (data.size ()));
+    int px = (c % cols) * csize, py = (c / cols) * csize, pz = 0;
+    const Pt3i *pt = points + cells[c];
+    for (int k = cells[c]; k < cells[c+1]; k++)
     {
-      delete cells;
-      cells = NULL;
+      putVarint (data, zigzag (pt->x () - px));
+      putVarint (data, zigzag (pt->y () - py));
+      putVarint (data, zigzag (pt->z () - pz));
+      px = pt->x ();
+      py = pt->y ();
+      pz = pt->z ();
+      pt ++;
     }
-    cells = new int[rows * cols + 1];
-    fpts.read ((char *) cells, sizeof (int) * (rows * cols + 1));
-    if (points == NULL) points = new Pt3i[nb];
-    fpts.read ((char *) points, sizeof (Pt3i) * (nb));
   }
+  blocks.push_back ((int64_t) (data.size ()));
+  int64_t cbytes = (int64_t) (cnts.size ());
+  int64_t dbytes = (int64_t) (data.size ());
+
+  fpts.write ((char *) (&PACKED_TAG), sizeof (int));
+  fpts.write ((char *) (&cols), sizeof (int));
+  fpts.write ((char *) (&rows), sizeof (int));
+  fpts.write ((char *) (&xmin), sizeof (int64_t));
+  fpts.write ((char *) (&ymin), sizeof (int64_t));
+  fpts.write ((char *) (&zmax), sizeof (int64_t));
+  fpts.write ((char *) (&csize), sizeof (int));
+  fpts.write ((char *) (&nb), sizeof (int));
+  fpts.write ((char *) (&cbytes), sizeof (int64_t));
+  fpts.write ((char *) (&dbytes), sizeof (int64_t));
+  fpts.write ((char *) cnts.data (), cbytes);
+  fpts.write ((char *) blocks.data (), sizeof (int64_t) * (nblocks + 1));
+  fpts.write ((char *) data.data (), dbytes);
   fpts.close ();
-  return (true);
+  return true;
 }
 
 
-bool IPtTile::load (bool all)
+bool IPtTile::savePacked () const
 {
-  std::ifstream fpts (fname.c_str (), std::ios::in | std::ifstream::binary);
-  if (! fpts.is_open ()) return false;
+  return (savePacked (fname));
+}
 
-  fpts.read ((char *) (&cols), sizeof (int));
+
+bool IPtTile::load (std::string name, bool all)
+{
+  std::ifstream fpts (name.c_str (), std::ios::in | std::ifstream::binary);
+  if (! fpts.is_open ()) return false;
+  int tag;
+  fpts.read ((char *) (&tag), sizeof (int));
+  if (tag == PACKED_TAG) fpts.read ((char *) (&cols), sizeof (int));
+  else cols = tag;
   fpts.read ((char *) (&rows), sizeof (int));
   fpts.read ((char *) (&xmin), sizeof (int64_t));
   fpts.read ((char *) (&ymin), sizeof (int64_t));
   fpts.read ((char *) (&zmax), sizeof (int64_t));
   fpts.read ((char *) (&csize), sizeof (int));
   fpts.read ((char *) (&nb), sizeof (int));
+  int64_t cbytes = 0;
+  psize = 0;
+  if (tag == PACKED_TAG)
+  {
+    fpts.read ((char *) (&cbytes), sizeof (int64_t));
+    fpts.read ((char *) (&psize), sizeof (int64_t));
+  }
   if (all)
   {
-    if (cells != NULL)
+    unload ();
+    if (tag == PACKED_TAG)
     {
-      delete cells;
-      cells = NULL;
+      std::vector<unsigned char> cnts (cbytes);
+      fpts.read ((char *) cnts.data (), cbytes);
+      createPackedIndex (cnts.data ());
+      fpts.read ((char *) pblocks,
+                 sizeof (int64_t) * ((rows * cols + PACK_BLOCK - 1) / PACK_BLOCK
+                                     + 1));
+      pdata = new unsigned char[psize];
+      fpts.read ((char *) pdata, psize);
+    }
+    else
+    {
+      cells = new int[rows * cols + 1];
+      fpts.read ((char *) cells, sizeof (int) * (rows * cols + 1));
+      points = new Pt3i[nb];
+      fpts.read ((char *) points, sizeof (Pt3i) * (nb));
+      createSubcellIndex ();
     }
-    cells = new int[rows * cols + 1];
-    fpts.read ((char *) cells, sizeof (int) * (rows * cols + 1));
-    if (points == NULL) points = new Pt3i[nb];
-    fpts.read ((char *) points, sizeof (Pt3i) * (nb));
   }
   fpts.close ();
   return (true);
 }
 
 
-bool IPtTile::loadPoints (int *ind, Pt3i *pts)
+bool IPtTile::load (bool all)
 {
-  std::ifstream fpts (fname.c_str (), std::ios::in | std::ifstream::binary);
-  if (! fpts.is_open ())
+  return (load (fname, all));
+}
+
+
+bool IPtTile::map ()
+{
+  unload ();
+  mapping = new MappedFile ();
+  if (! mapping->open (fname))
   {
-    std::cout << "Loading of " << fname << " failed" << std::endl;
+    delete mapping;
+    mapping = NULL;
     return false;
   }
-  fpts.read ((char *) (&cols), sizeof (int));
-  fpts.read ((char *) (&rows), sizeof (int));
-  fpts.read ((char *) (&xmin), sizeof (int64_t));
-  fpts.read ((char *) (&ymin), sizeof (int64_t));
-  fpts.read ((char *) (&zmax), sizeof (int64_t));
-  fpts.read ((char *) (&csize), sizeof (int));
-  fpts.read ((char *) (&nb), sizeof (int));
-  cells = ind;
-  fpts.read ((char *) cells, sizeof (int) * (rows * cols + 1));
-  points = pts;
-  fpts.read ((char *) points, sizeof (Pt3i) * (nb));
-  fpts.close ();
-  return (true);
+  const char *mem = mapping->address ();
+  int tag = 0;
+  if (mapping->size () >= sizeof (int)) memcpy (&tag, mem, sizeof (int));
+  if (tag == PACKED_TAG) mem += sizeof (int);
+  size_t hsize = HEADER_SIZE + (tag == PACKED_TAG ?
+                                sizeof (int) + 2 * sizeof (int64_t) : 0);
+  if (mapping->size () < hsize)
+  {
+    std::cout << "Mapping of " << fname << " failed (truncated file)"
+              << std::endl;
+    unload ();
+    return false;
+  }
+  memcpy (&cols, mem, sizeof (int));
+  memcpy (&rows, mem + sizeof (int), sizeof (int));
+  memcpy (&xmin, mem + 2 * sizeof (int), sizeof (int64_t));
+  memcpy (&ymin, mem + 2 * sizeof (int) + sizeof (int64_t), sizeof (int64_t));
+  memcpy (&zmax, mem + 2 * sizeof (int) + 2 * sizeof (int64_t),
+          sizeof (int64_t));
+  memcpy (&csize, mem + 2 * sizeof (int) + 3 * sizeof (int64_t), sizeof (int));
+  memcpy (&nb, mem + 3 * sizeof (int) + 3 * sizeof (int64_t), sizeof (int));
+  if (tag == PACKED_TAG)
+  {
+    // Points are decoded in memory, packed data is read from the mapping
+    int64_t cbytes;
+    memcpy (&cbytes, mem + HEADER_SIZE, sizeof (int64_t));
+    memcpy (&psize, mem + HEADER_SIZE + sizeof (int64_t), sizeof (int64_t));
+    size_t bsize = sizeof (int64_t)
+                   * ((rows * cols + PACK_BLOCK - 1) / PACK_BLOCK + 1);
+    if (mapping->size () < hsize + cbytes + bsize + psize)
+    {
+      std::cout << "Mapping of " << fname << " failed (truncated file)"
+                << std::endl;
+      unload ();
+      return false;
+    }
+    const char *cnts = mapping->address () + hsize;
+    createPackedIndex ((const unsigned char *) cnts);
+    memcpy (pblocks, cnts + cbytes, bsize);
+    pdata = (unsigned char *) (cnts + cbytes + bsize);
+    return true;
+  }
+  psize = 0;
+  size_t isize = sizeof (int) * ((size_t) rows * cols + 1);
+  if (mapping->size () < HEADER_SIZE + isize + sizeof (Pt3i) * nb)
+  {
+    std::cout << "Mapping of " << fname << " failed (truncated file)"
+              << std::endl;
+    unload ();
+    return false;
+  }
+  cells = (int *) (mapping->address () + HEADER_SIZE);
+  points = (Pt3i *) (mapping->address () + HEADER_SIZE + isize);
+  createSubcellIndex ();
+  return true;
 }
 
 
-void IPtTile::releasePoints ()
+void IPtTile::unload ()
 {
-  // Just to avoid point and index arrays to be freed, when padding
-  // Do not delete the data here !!!
-  cells = NULL;
+  if (mapping == NULL || pdata != NULL)
+  {
+    // Arrays are not in the mapping
+    if (points != NULL) delete [] points;
+    if (cells != NULL) delete [] cells;
+  }
+  if (pdata != NULL)
+  {
+    if (mapping == NULL) delete [] pdata;
+    delete [] pblocks;
+    delete [] pdone;
+    delete plock;
+    pdata = NULL;
+    pblocks = NULL;
+    pdone = NULL;
+    plock = NULL;
+  }
+  if (mapping != NULL)
+  {
+    delete mapping;
+    mapping = NULL;
+  }
+  deleteSubcellIndex ();
   points = NULL;
+  cells = NULL;
+}
+
+
+void IPtTile::createPackedIndex (const unsigned char *cnts)
+{
+  cells = new int[rows * cols + 1];
+  int *c = cells;
+  *c = 0;
+  for (int i = 0; i < rows * cols; i++)
+  {
+    *(c + 1) = *c + (int) getVarint (cnts);
+    c++;
+  }
+  int nblocks = (rows * cols + PACK_BLOCK - 1) / PACK_BLOCK;
+  pblocks = new int64_t[nblocks + 1];
+  pdone = new std::atomic<bool>[nblocks + 1];
+  for (int i = 0; i <= nblocks; i++) pdone[i].store (false);
+  plock = new std::mutex ();
+  points = new Pt3i[nb];
+  createSubcellIndex (false);
+}
+
+
+void IPtTile::createSubcellIndex (bool fill)
+{
+  deleteSubcellIndex ();
+  int nbsub = csize / MIN_CELL_SIZE;
+  if (nbsub == 1) return;
+  int nbind = 0;
+  sindex = new int[rows * cols];
+  for (int c = 0; c < rows * cols; c++)
+  {
+    int nbpts = cells[c + 1] - cells[c];
+    if (nbpts >= SUBCELL_INDEX_MIN && nbpts <= USHRT_MAX)
+    {
+      sindex[c] = nbind;
+      nbind += nbsub * nbsub;
+    }
+    else sindex[c] = -1;
+  }
+  if (nbind == 0)
+  {
+    deleteSubcellIndex ();
+    return;
+  }
+  sstarts = new unsigned short[nbind];
+  snb = nbind;
+  if (fill)
+    for (int c = 0; c < rows * cols; c++) indexSubcells (c);
+}
+
+
+void IPtTile::deleteSubcellIndex ()
+{
+  if (sindex != NULL) delete [] sindex;
+  if (sstarts != NULL) delete [] sstarts;
+  sindex = NULL;
+  sstarts = NULL;
+  snb = 0;
+}
+
+
+void IPtTile::indexSubcells (int c) const
+{
+  if (sindex[c] < 0) return;
+  int nbsub = csize / MIN_CELL_SIZE;
+  const Pt3i *pts = points + cells[c];
+  int nbpts = cells[c + 1] - cells[c];
+  unsigned short *st = sstarts + sindex[c];
+  int ystart = 0;
+  for (int j = 0; j < nbsub; j++)
+  {
+    // Same positions as found by linear search from the cell start
+    int ymin = (c / cols) * csize + j * MIN_CELL_SIZE;
+    while (ystart != nbpts && pts[ystart].y () < ymin) ystart ++;
+    int xstart = ystart;
+    for (int i = 0; i < nbsub; i++)
+    {
+      int xmin = (c % cols) * csize + i * MIN_CELL_SIZE;
+      while (xstart != nbpts && pts[xstart].x () < xmin) xstart ++;
+      *st++ = (unsigned short) xstart;
+    }
+  }
+}
+
+
+Pt3i *IPtTile::findSubcellStart (int i, int j) const
+{
+  int nbsub = csize / MIN_CELL_SIZE;
+  int c = (j / nbsub) * cols + i / nbsub;
+  Pt3i *pt = points + cells[c];
+  Pt3i *ptfin = points + cells[c + 1];
+  while (pt->y () < j * MIN_CELL_SIZE && pt != ptfin) pt ++;
+  while (pt->x () < i * MIN_CELL_SIZE && pt != ptfin) pt ++;
+  return pt;
+}
+
+
+void IPtTile::unpackBlock (int b) const
+{
+  std::lock_guard<std::mutex> lock (*plock);
+  if (pdone[b].load (std::memory_order_relaxed)) return;
+  const unsigned char *data = pdata + pblocks[b];
+  int cmax = (b + 1) * PACK_BLOCK;
+  if (cmax > rows * cols) cmax = rows * cols;
+  for (int c = b * PACK_BLOCK; c < cmax; c++)
+  {
+    int px = (c % cols) * csize, py = (c / cols) * csize, pz = 0;
+    Pt3i *pt = points + cells[c];
+    for (int k = cells[c]; k < cells[c+1]; k++)
+    {
+      px += unzigzag (getVarint (data));
+      py += unzigzag (getVarint (data));
+      pz += unzigzag (getVarint (data));
+      (pt++)->set (px, py, pz);
+    }
+    if (sindex != NULL) indexSubcells (c);
+  }
+  pdone[b].store (true, std::memory_order_release);
+}
+
+
+void IPtTile::unpackAll () const
+{
+  int nblocks = (rows * cols + PACK_BLOCK - 1) / PACK_BLOCK;
+  for (int b = 0; b < nblocks; b++)
+    if (! pdone[b].load (std::memory_order_acquire)) unpackBlock (b);
 }
 
 
@@ -518,6 +862,7 @@ void IPtTile::resetLabels ()
 
 bool IPtTile::isLabelled (int i, int j)
 {
+  if (pdata != NULL) unpackCell (j * cols + i);
   int nbpts = cells[j * cols + i + 1] - cells[j * cols + i];
   unsigned char *lab = labels + cells[j * cols + i];
   if (csize == MIN_CELL_SIZE)
@@ -562,6 +907,7 @@ void IPtTile::labelAsTrack (int plab)
 
 void IPtTile::unlabel (int i, int j)
 {
+  if (pdata != NULL) unpackCell (j * cols + i);
   int nbpts = cells[j * cols + i + 1] - cells[j * cols + i];
   unsigned char *lab = labels + cells[j * cols + i];
   if (csize == MIN_CELL_SIZE)
@@ -597,139 +943,442 @@ void IPtTile::unlabel (int i, int j)
 }
 
 
-bool IPtTile::loadXYZFile (std::string ptsfile, int subdiv, bool lab_in)
+/** Point out of the tile found in a point file. */
+struct PtOutlier
 {
-  // Opens XYZ file
-  bool labelled = (ptsfile.find (XYZL_SUFFIX) != std::string::npos);
-  lab_in = lab_in && labelled;
-  std::cout << "loading " << ptsfile << " ..." << std::endl;
-  std::ifstream fpts (ptsfile.c_str (), std::ios::in);
-  if (! fpts.is_open ()) return false;
-
-  // Load XYZ file points
-  nb = 0;
+  /** Point relative to tile origin. */
+  Pt3i pt;
+  /** Subcell column. */
+  int gx;
+  /** Subcell row. */
+  int gy;
+  /** Count of points of the chunk kept before the outlier. */
+  int rank;
+  /** File coordinates. */
   double x, y, z;
-  char lab;
-  int ix, iy, iz;
-  int lrow = rows * subdiv;
-  int lcol = cols * subdiv;
-  std::vector<Pt3i> outs;
-  std::vector<Pt3i> **xyzcells = new std::vector<Pt3i>*[lrow];
-  std::vector<unsigned char> **labcells
-         = (lab_in ? new std::vector<unsigned char>*[lrow] : NULL);
-  for (int i = 0; i < lrow; i++)
-  {
-    xyzcells[i] = new std::vector<Pt3i>[lcol];
-    if (lab_in) labcells[i] = new std::vector<unsigned char>[lcol];
-  }
-  fpts >> x;
-  for (int i = 0; ! fpts.eof (); i++)
-  {
-    fpts >> y;
-    fpts >> z;
-    if (labelled) fpts >> lab;
-    ix = (int) ((int64_t) (x * XYZ_UNIT + 0.5) - xmin);
-    iy = (int) ((int64_t) (y * XYZ_UNIT + 0.5) - ymin);
-    iz = (int) (z * XYZ_UNIT + 0.5);
-
-    int gx = (ix * subdiv) / csize;
-    int gy = (iy * subdiv) / csize;
-    if (gx < 0 || gy < 0 || gx >= lcol || gy >= lrow)
+};
+
+/** Points read in a part of a point file. */
+struct PtChunk
+{
+  /** Chunk start in the file. */
+  const char *start;
+  /** Chunk end in the file. */
+  const char *end;
+  /** Points relative to tile origin. */
+  std::vector<Pt3i> pts;
+  /** Point subcell ranks in tile cell order. */
+  std::vector<int> keys;
+  /** Point labels. */
+  std::vector<unsigned char> labs;
+  /** Reported points out of the tile. */
+  std::vector<PtOutlier> outs;
+  /** Count of points out of the tile. */
+  int nbouts;
+  /** Highest point height. */
+  int64_t zmax;
+  /** Reading failure status. */
+  bool failed;
+};
+
+/** Point record format of a LAS file. */
+struct LASFormat
+{
+  /** Point record length (in bytes). */
+  int reclen;
+  /** Classification byte position in the record. */
+  int classpos;
+  /** Classification bit mask. */
+  unsigned char classmask;
+  /** Coordinate scale factors. */
+  double scale[3];
+  /** Coordinate offsets. */
+  double offset[3];
+};
+
+/** Subcell statistics on a part of a tile. */
+struct PtCellStats
+{
+  PtCellStats () : cmax (0), cmin (INT_MAX), nz (0), nlab (0) { }
+  /** Count of points in the most populated subcell. */
+  int cmax;
+  /** Count of points in the less populated subcell. */
+  int cmin;
+  /** Count of empty subcells. */
+  int nz;
+  /** Count of labelled points. */
+  int nlab;
+};
+
+/** Skips white spaces and tells whether some character remains. */
+static inline bool skipXYZSpaces (const char *&c, const char *end)
+{
+  while (c != end && (*c == ' ' || *c == '\n' || *c == '\r' || *c == '\t'
+                      || *c == '\v' || *c == '\f')) c ++;
+  return (c != end);
+}
+
+/** Reads a decimal value (independently of the locale). */
+static inline bool readXYZValue (const char *&c, const char *end, double &val)
+{
+  if (! skipXYZSpaces (c, end)) return false;
+  const char *next = parseDecimal (c, end, val);
+  if (next == NULL) return false;
+  c = next;
+  return true;
+}
+
+/** Reads a little endian value in a binary file. */
+template <typename T> static inline T readLASValue (const char *buf)
+{
+  T val;
+  memcpy (&val, buf, sizeof (T));
+  return val;
+}
+
+
+void IPtTile::splitChunks (std::vector<PtChunk> &chunks,
+                           const char *start, const char *end, int reclen)
+{
+  int nbchunks = WorkerPool::common ().size ();
+  if (end - start < (int64_t) nbchunks * XYZ_CHUNK_MIN)
+    nbchunks = 1 + (int) ((end - start) / XYZ_CHUNK_MIN);
+  chunks.resize (nbchunks);
+  const char *cstart = start;
+  for (int k = 0; k < nbchunks; k++)
+  {
+    const char *cend = start + ((end - start) * (k + 1)) / nbchunks;
+    if (cend < cstart) cend = cstart;
+    if (reclen != 0) cend -= (cend - start) % reclen;
+    else
     {
-      outs.push_back (Pt3i (ix, iy, iz));
-      std::cout << "Out pt (" << ix << ", " << iy << ", " << iz << ") -> ("
-                << gx << ", " << gy << ")" << std::endl;
-      std::cout << "Origin " << nb << " : " << x << ", " << y << ", " << z
-                << ")" << std::endl;
+      while (cend != end && *cend != '\n') cend ++;
+      if (cend != end) cend ++;
     }
-    else
+    chunks[k].start = cstart;
+    chunks[k].end = cend;
+    chunks[k].nbouts = 0;
+    chunks[k].zmax = zmax;
+    chunks[k].failed = false;
+    cstart = cend;
+  }
+}
+
+
+inline void IPtTile::addPoint (PtChunk &chk, double x, double y, double z,
+                               int subdiv, bool report) const
+{
+  int ix = (int) ((int64_t) (x * XYZ_UNIT + 0.5) - xmin);
+  int iy = (int) ((int64_t) (y * XYZ_UNIT + 0.5) - ymin);
+  int iz = (int) (z * XYZ_UNIT + 0.5);
+
+  int gx = (ix * subdiv) / csize;
+  int gy = (iy * subdiv) / csize;
+  if (gx < 0 || gy < 0 || gx >= cols * subdiv || gy >= rows * subdiv)
+  {
+    if (report)
     {
-      xyzcells[gy][gx].push_back (Pt3i (ix, iy, iz));
-      if (lab_in) labcells[gy][gx].push_back (
-                      lab == 'P' ? (unsigned char) 1 : (unsigned char) 0);
-      nb ++;
-      if (iz > zmax) zmax = iz;
+      PtOutlier out = { Pt3i (ix, iy, iz), gx, gy,
+                        (int) (chk.pts.size ()), x, y, z };
+      chk.outs.push_back (out);
     }
-    fpts >> x;
+    chk.nbouts ++;
   }
-  fpts.close ();
+  else
+  {
+    chk.pts.push_back (Pt3i (ix, iy, iz));
+    chk.keys.push_back (((gy / subdiv) * cols + gx / subdiv) * subdiv * subdiv
+                        + (gy % subdiv) * subdiv + gx % subdiv);
+    if (iz > chk.zmax) chk.zmax = iz;
+  }
+}
 
-  // Displays statistics
-  std::cout << "Outliers size = " << outs.size () << std::endl;
-  int cmax = 0;
-  for (int j = 0; j < lrow; j++)
-    for (int i = 0; i < lcol; i++)
-      if ((int) xyzcells[j][i].size () > cmax)
-        cmax = (int) xyzcells[j][i].size ();
-  int cmin = cmax;
-  for (int j = 0; j < lrow; j++)
-    for (int i = 0; i < lcol; i++)
-      if ((int) xyzcells[j][i].size () < cmin)
-        cmin = (int) xyzcells[j][i].size ();
-  std::cout << "Max cell size = " << cmax << std::endl;
-  std::cout << "Min cell size = " << cmin << std::endl;
-  int nz = 0, nyny = 0, nlab = 0;
-  for (int j = 0; j < lrow; j++)
-    for (int i = 0; i < lcol; i++)
-      if (xyzcells[j][i].empty ()) nz ++;
-      else
+
+void IPtTile::parseXYZChunk (PtChunk &chk, int subdiv,
+                             bool labelled, bool lab_in) const
+{
+  double x, y, z;
+  char lab = ' ';
+  chk.pts.reserve ((chk.end - chk.start) / 24);
+  chk.keys.reserve ((chk.end - chk.start) / 24);
+  const char *c = chk.start;
+  while (readXYZValue (c, chk.end, x))
+  {
+    if (! (readXYZValue (c, chk.end, y) && readXYZValue (c, chk.end, z)))
+    {
+      chk.failed = true;
+      return;
+    }
+    if (labelled)
+    {
+      if (! skipXYZSpaces (c, chk.end))
       {
-        nyny ++;
-        if (lab_in)
-        {
-          std::vector<unsigned char>::iterator lit = labcells[j][i].begin ();
-          while (lit != labcells[j][i].end ())
-            if (*lit++ == (unsigned char) 1) nlab ++;
-        }
+        chk.failed = true;
+        return;
       }
-  std::cout << nz << " cellules vides" << std::endl;
-  std::cout << nyny << " cellules occupees" << std::endl;
-  if (lab_in) std::cout << nlab << " labelled points" << std::endl;
+      lab = *c++;
+    }
+    int nbin = (int) (chk.pts.size ());
+    addPoint (chk, x, y, z, subdiv, true);
+    if (lab_in && (int) (chk.pts.size ()) != nbin)
+      chk.labs.push_back (lab == 'P' ? (unsigned char) 1 : (unsigned char) 0);
+  }
+  if (skipXYZSpaces (c, chk.end)) chk.failed = true;
+}
+
 
-  // Sets IPtTile structure
+void IPtTile::parseLASChunk (PtChunk &chk, int subdiv,
+                             const LASFormat &fmt, bool ground) const
+{
+  chk.pts.reserve ((chk.end - chk.start) / fmt.reclen);
+  chk.keys.reserve ((chk.end - chk.start) / fmt.reclen);
+  for (const char *rec = chk.start; rec != chk.end; rec += fmt.reclen)
+  {
+    if (ground && (rec[fmt.classpos] & fmt.classmask) != LAS_GROUND) continue;
+    addPoint (chk,
+              readLASValue<int32_t> (rec) * fmt.scale[0] + fmt.offset[0],
+              readLASValue<int32_t> (rec + 4) * fmt.scale[1] + fmt.offset[1],
+              readLASValue<int32_t> (rec + 8) * fmt.scale[2] + fmt.offset[2],
+              subdiv, false);
+  }
+}
+
+
+void IPtTile::binPoints (std::vector<PtChunk> &chunks, int subdiv, bool lab_in)
+{
+  WorkerPool &pool = WorkerPool::common ();
+  int nbchunks = (int) (chunks.size ());
+  int ncells = rows * cols;
+  int nsub = subdiv * subdiv;
+
+  // Displays outliers and sets the count of points per cell and chunk
+  nb = 0;
+  int nbouts = 0;
+  std::vector<int> offsets ((size_t) ncells * nbchunks, 0);
+  for (int k = 0; k < nbchunks; k++)
+  {
+    std::vector<PtOutlier>::iterator it = chunks[k].outs.begin ();
+    while (it != chunks[k].outs.end ())
+    {
+      std::cout << "Out pt (" << it->pt.x () << ", " << it->pt.y () << ", "
+                << it->pt.z () << ") -> (" << it->gx << ", " << it->gy << ")"
+                << std::endl;
+      std::cout << "Origin " << (nb + it->rank) << " : " << it->x << ", "
+                << it->y << ", " << it->z << ")" << std::endl;
+      it ++;
+    }
+    nb += (int) (chunks[k].pts.size ());
+    nbouts += chunks[k].nbouts;
+    if (chunks[k].zmax > zmax) zmax = chunks[k].zmax;
+  }
+  pool.run (nbchunks, [&] (int k) {
+    int *cnt = offsets.data () + (size_t) ncells * k;
+    std::vector<int>::const_iterator it = chunks[k].keys.begin ();
+    while (it != chunks[k].keys.end ()) cnt[*it++ / nsub] ++; });
+
+  // Sets cell addresses, a cell gathering its points chunk after chunk
+  int *pcells = cells;
+  *pcells++ = 0;
+  int inb = 0;
+  for (int c = 0; c < ncells; c++)
+  {
+    for (int k = 0; k < nbchunks; k++)
+    {
+      int *off = &(offsets[(size_t) ncells * k + c]);
+      int cnt = *off;
+      *off = inb;
+      inb += cnt;
+    }
+    *pcells++ = inb;
+  }
+
+  // Scatters the points in their cells, in file order
   points = new Pt3i[nb];
   if (lab_in && ! labelling)
   {
     labels = new unsigned char[nb];
     labelling = true;
   }
-  Pt3i *ppoints = points;
-  unsigned char *plabs = labels;
-  int *pcells = cells;
-  *pcells++ = 0;
-  int inb = 0;
-  for (int j = 0; j < rows ; j++)
-    for (int i = 0; i < cols ; i++)
+  std::vector<unsigned short> subs (nsub == 1 ? 0 : nb);
+  pool.run (nbchunks, [&] (int k) {
+    int *off = offsets.data () + (size_t) ncells * k;
+    const PtChunk &chk = chunks[k];
+    for (size_t i = 0; i < chk.pts.size (); i++)
     {
-      for (int cj = 0; cj < subdiv; cj ++)
-        for (int ci = 0; ci < subdiv; ci ++)
+      int c = chk.keys[i] / nsub;
+      int pos = off[c]++;
+      points[pos].set (chk.pts[i].x () + R_OFF, chk.pts[i].y () + R_OFF,
+                       chk.pts[i].z ());
+      if (lab_in) labels[pos] = chk.labs[i];
+      if (nsub != 1) subs[pos] = (unsigned short) (chk.keys[i] % nsub);
+    }
+  });
+  chunks.clear ();
+  offsets.clear ();
+
+  // Orders the points of each cell by subcell, and gets statistics
+  int nbtasks = (rows < pool.size () ? rows : pool.size ());
+  std::vector<PtCellStats> stats (nbtasks);
+  pool.run (nbtasks, [&] (int t) {
+    PtCellStats &st = stats[t];
+    std::vector<int> subcnt (nsub);
+    std::vector<Pt3i> cpts;
+    std::vector<unsigned char> clabs;
+    for (int c = cols * ((rows * t) / nbtasks);
+         c < cols * ((rows * (t + 1)) / nbtasks); c++)
+    {
+      std::fill (subcnt.begin (), subcnt.end (), 0);
+      if (nsub == 1) subcnt[0] = cells[c + 1] - cells[c];
+      else
+      {
+        for (int i = cells[c]; i < cells[c + 1]; i++) subcnt[subs[i]] ++;
+        cpts.assign (points + cells[c], points + cells[c + 1]);
+        if (lab_in) clabs.assign (labels + cells[c], labels + cells[c + 1]);
+        int pos = cells[c];
+        for (int s = 0; s < nsub; s++)
         {
-          inb += (int) (xyzcells[j * subdiv + cj][i * subdiv + ci].size ());
-          const std::vector<Pt3i> *pts
-            = &(xyzcells[j * subdiv + cj][i * subdiv + ci]);
-          const std::vector<unsigned char> *labs = NULL;
-          if (lab_in) labs = &(labcells[j * subdiv + cj][i * subdiv + ci]);
-          std::vector<Pt3i>::const_iterator it = pts->begin ();
-          std::vector<unsigned char>::const_iterator lit;
-          if (lab_in) lit = labs->begin ();
-          while (it != pts->end ())
-          {
-            (ppoints++)->set (it->x () + R_OFF, it->y () + R_OFF, it->z ());
-            if (lab_in) *plabs++ = *lit++;
-            it ++;
-          }
+          int cnt = subcnt[s];
+          subcnt[s] = pos;
+          pos += cnt;
         }
-      *pcells++ = inb;
+        for (int i = cells[c]; i < cells[c + 1]; i++)
+        {
+          int p = subcnt[subs[i]]++;
+          points[p].set (cpts[i - cells[c]]);
+          if (lab_in) labels[p] = clabs[i - cells[c]];
+        }
+        for (int s = nsub - 1; s > 0; s--) subcnt[s] -= subcnt[s - 1];
+        subcnt[0] -= cells[c];
+      }
+      for (int s = 0; s < nsub; s++)
+      {
+        if (subcnt[s] > st.cmax) st.cmax = subcnt[s];
+        if (subcnt[s] < st.cmin) st.cmin = subcnt[s];
+        if (subcnt[s] == 0) st.nz ++;
+      }
+      if (lab_in)
+        for (int i = cells[c]; i < cells[c + 1]; i++)
+          if (labels[i] == (unsigned char) 1) st.nlab ++;
     }
+  });
+  PtCellStats total;
+  std::vector<PtCellStats>::iterator it = stats.begin ();
+  while (it != stats.end ())
+  {
+    if (it->cmax > total.cmax) total.cmax = it->cmax;
+    if (it->cmin < total.cmin) total.cmin = it->cmin;
+    total.nz += it->nz;
+    total.nlab += it->nlab;
+    it ++;
+  }
+  if (total.cmin > total.cmax) total.cmin = total.cmax;
 
-  // Temporary cloud memory release
-  for (int i = 0; i < lrow; i++) delete [] xyzcells[i];
-  delete [] xyzcells;
-  if (lab_in)
+  // Displays statistics
+  std::cout << "Outliers size = " << nbouts << std::endl;
+  std::cout << "Max cell size = " << total.cmax << std::endl;
+  std::cout << "Min cell size = " << total.cmin << std::endl;
+  std::cout << total.nz << " cellules vides" << std::endl;
+  std::cout << (ncells * nsub - total.nz) << " cellules occupees" << std::endl;
+  if (lab_in) std::cout << total.nlab << " labelled points" << std::endl;
+  createSubcellIndex ();
+}
+
+
+bool IPtTile::loadXYZFile (std::string ptsfile, int subdiv, bool lab_in)
+{
+  // Maps XYZ file
+  bool labelled = (ptsfile.find (XYZL_SUFFIX) != std::string::npos);
+  lab_in = lab_in && labelled;
+  std::cout << "loading " << ptsfile << " ..." << std::endl;
+  MappedFile xyzfile;
+  if (! xyzfile.open (ptsfile))
   {
-    for (int i = 0; i < lrow; i++) delete [] labcells[i];
-    delete [] labcells;
+    // Missing or empty file
+    std::ifstream fpts (ptsfile.c_str (), std::ios::in);
+    if (! fpts.is_open ()) return false;
+  }
+
+  // Parses parts of whole lines in parallel
+  std::vector<PtChunk> chunks;
+  splitChunks (chunks, xyzfile.address (),
+               xyzfile.address () + xyzfile.size (), 0);
+  WorkerPool::common ().run ((int) (chunks.size ()), [&] (int k) {
+    parseXYZChunk (chunks[k], subdiv, labelled, lab_in); });
+  std::vector<PtChunk>::iterator it = chunks.begin ();
+  while (it != chunks.end ())
+    if ((it++)->failed)
+      std::cout << "Unreadable point in " << ptsfile << std::endl;
+
+  binPoints (chunks, subdiv, lab_in);
+  return true;
+}
+
+
+bool IPtTile::loadLASFile (std::string ptsfile, int subdiv, bool ground)
+{
+  std::cout << "loading " << ptsfile << " ..." << std::endl;
+  MappedFile lasfile;
+  if (! lasfile.open (ptsfile)) return false;
+  const char *hd = lasfile.address ();
+  if (lasfile.size () < LAS_HEADER_MIN || strncmp (hd, "LASF", 4) != 0)
+  {
+    std::cout << ptsfile << " is not a LAS file" << std::endl;
+    return false;
   }
+
+  // Reads the header
+  int major = (int) (unsigned char) hd[24];
+  int minor = (int) (unsigned char) hd[25];
+  int hsize = (int) readLASValue<uint16_t> (hd + 94);
+  uint32_t ptstart = readLASValue<uint32_t> (hd + 96);
+  int ptformat = (int) (unsigned char) hd[104];
+  LASFormat fmt;
+  fmt.reclen = (int) readLASValue<uint16_t> (hd + 105);
+  uint64_t count = readLASValue<uint32_t> (hd + 107);
+  for (int i = 0; i < 3; i++)
+  {
+    fmt.scale[i] = readLASValue<double> (hd + 131 + i * sizeof (double));
+    fmt.offset[i] = readLASValue<double> (hd + 155 + i * sizeof (double));
+  }
+  if (major == 1 && minor >= 4 && hsize >= LAS_HEADER_MIN_14
+      && lasfile.size () >= (size_t) LAS_HEADER_MIN_14)
+  {
+    uint64_t count14 = readLASValue<uint64_t> (hd + 247);
+    if (count14 != 0) count = count14;
+  }
+  if (major != 1 || minor < 2 || minor > 4)
+    std::cout << "LAS version " << major << "." << minor
+              << " not expected" << std::endl;
+  if (ptformat > 10)
+  {
+    std::cout << "Unsupported LAS point format " << ptformat
+              << " (compressed file ?)" << std::endl;
+    return false;
+  }
+  static const int minlen[11] = {20, 28, 26, 34, 57, 63, 30, 36, 38, 59, 67};
+  if (fmt.reclen < minlen[ptformat])
+  {
+    std::cout << "Too short LAS point records in " << ptsfile << std::endl;
+    return false;
+  }
+  fmt.classpos = (ptformat < 6 ? 15 : 16);
+  fmt.classmask = (unsigned char) (ptformat < 6 ? 0x1f : 0xff);
+  if (ptstart > lasfile.size ()) count = 0;
+  else if (count > (lasfile.size () - ptstart) / fmt.reclen)
+  {
+    count = (lasfile.size () - ptstart) / fmt.reclen;
+    std::cout << "Truncated LAS file: only " << count << " points read"
+              << std::endl;
+  }
+
+  // Reads parts of the point records in parallel
+  std::vector<PtChunk> chunks;
+  splitChunks (chunks, hd + ptstart, hd + ptstart + count * fmt.reclen,
+               fmt.reclen);
+  WorkerPool::common ().run ((int) (chunks.size ()), [&] (int k) {
+    parseLASChunk (chunks[k], subdiv, fmt, ground); });
+
+  binPoints (chunks, subdiv, false);
   return true;
 }
 
@@ -769,6 +1418,7 @@ bool IPtTile::saveXYZFile (std::string name, bool lab_out) const
     std::cout << "Can't save tile in " << name << std::endl;
     return false;
   }
+  if (pdata != NULL) unpackAll ();
   Pt3i *ppt = points;
   int nbl = 0;
   unsigned char *lbs = labels;
@@ -814,6 +1464,7 @@ void IPtTile::check () const
   std::cout << "Xmin = " << xmin << ", Ymin = " << ymin
             << ", Csize = " << csize << std::endl;
   std::cout << nb << " points, Zmax = " << zmax << std::endl;
+  if (pdata != NULL) unpackAll ();
   if (cells != NULL)
     std::cout << "Cell[112] = " << cells[112] << " et Pt[112] = ("
               << points[112].x () << ", " << points[112].y () << ", "
@@ -28,8 +28,14 @@
 #include <vector>
 #include <string>
 #include <inttypes.h>
+#include <atomic>
+#include <mutex>
 #include "pt2i.h"
 #include "pt3i.h"
+#include "mappedfile.h"
+
+struct PtChunk;
+struct LASFormat;
 
 
 /** 
@@ -72,6 +78,8 @@ public:
   static const std::string XYZ_SUFFIX;
   /** Labelled point text file suffix. */
   static const std::string XYZL_SUFFIX;
+  /** Point binary file suffix. */
+  static const std::string LAS_SUFFIX;
 
 
   /**
@@ -239,14 +247,38 @@ public:
    */
   void setPoints (const IPtTile &tin);
 
+  /**
+   * \brief Fills the tile with the points of a tile of another access type.
+   * @param tin Provided tile.
+   * @param acc Access type of this tile.
+   */
+  void convert (const IPtTile &tin, int acc);
+
   /**
    * \brief Returns the first point of a tile cell.
    * @param i Tile cell column.
    * @param j Tile cell row.
    */
   inline Pt3i *cellStartPt (int i, int j) const {
+    if (pdata != NULL) unpackCell (j * cols + i);
     return (points + cells[j * cols + i]); }
 
+  /**
+   * \brief Returns the first point of a subcell (of MIN_CELL_SIZE side).
+   * Subcell points follow it, up to the first one out of the subcell.
+   * Dense cells are indexed, others are searched from the cell start.
+   * @param i Subcell column in the tile.
+   * @param j Subcell row in the tile.
+   */
+  inline Pt3i *subcellStartPt (int i, int j) const {
+    int nbsub = csize / MIN_CELL_SIZE;
+    int c = (j / nbsub) * cols + i / nbsub;
+    if (pdata != NULL) unpackCell (c);
+    if (sindex != NULL && sindex[c] >= 0)
+      return (points + cells[c] + sstarts[sindex[c]
+                                          + (j % nbsub) * nbsub + i % nbsub]);
+    return (findSubcellStart (i, j)); }
+
   /**
    * \brief Returns the label of the first point of a tile cell.
    * @param i Tile cell column.
@@ -257,7 +289,9 @@ public:
   /**
    * \brief Returns the points array.
    */
-  inline Pt3i *getPointsArray () { return points; }
+  inline Pt3i *getPointsArray () {
+    if (pdata != NULL) unpackAll ();
+    return points; }
 
   /**
    * \brief Returns the points array end (end iterator address).
@@ -287,6 +321,26 @@ public:
    */
   bool save () const;
 
+  /**
+   * \brief Saves the tile in a file with packed format.
+   * Points are coded by differences to previous point in their cell,
+   *   in variable length, and decoded on demand by blocks of cells.
+   * Returns whether saving succeeded.
+   * @param name Specific tile name.
+   */
+  bool savePacked (std::string name) const;
+
+  /**
+   * \brief Saves the tile in its file with packed format.
+   * Returns whether saving succeeded.
+   */
+  bool savePacked () const;
+
+  /**
+   * \brief Returns whether the tile was loaded from a packed file.
+   */
+  inline bool packed () const { return (pdata != NULL); }
+
   /**
    * \brief Loads the tile from a file.
    * Returns whether loading succeeded.
@@ -303,17 +357,33 @@ public:
   bool load (bool all = true);
 
   /**
-   * \brief Loads the tile data in given arrays.
-   * Returns whether loading succeeded.
-   * @param ind Index array.
-   * @param pts Point array.
+   * \brief Maps the tile file in memory instead of loading it.
+   * Cell index and point arrays then directly refer to the mapped file,
+   *   so that no copy is done and file pages are shared through OS cache.
+   * With packed files, only the packed points are kept in the mapping.
+   * Returns whether mapping succeeded.
+   */
+  bool map ();
+
+  /**
+   * \brief Returns whether the tile data is mapped from its file.
+   */
+  inline bool mapped () const { return (mapping != NULL); }
+
+  /**
+   * \brief Frees the tile index and point arrays, or unmaps them.
+   * Tile header and labels are kept.
    */
-  bool loadPoints (int *ind, Pt3i *pts);
+  void unload ();
 
   /**
-   * \brief Releases the tile data in given arrays.
+   * \brief Returns the memory size of tile index and point arrays (in bytes).
    */
-  void releasePoints ();
+  inline int64_t dataSize () const {
+    return ((int64_t) sizeof (Pt3i) * nb
+            + (int64_t) sizeof (int) * ((int64_t) rows * cols + 1) + psize
+            + (sindex == NULL ? 0 : (int64_t) sizeof (int) * rows * cols
+                                    + (int64_t) sizeof (unsigned short) * snb)); }
 
   /**
    * \brief Returns the count of points in the most populated cell.
@@ -377,6 +447,7 @@ public:
 
   /**
    * Loads the point tile from a XYZ or XYZL file.
+   * The file is mapped in memory and its parts are parsed in parallel.
    * Returns whether the XYZ file was found.
    * @params ptsfile XYZ points file name.
    * @params subdiv Tile structure resolution: number of grouped columns.
@@ -384,6 +455,16 @@ public:
    */
   bool loadXYZFile (std::string ptsfile, int subdiv, bool lab_in = true);
 
+  /**
+   * Loads the point tile from a LAS file (versions 1.2 to 1.4).
+   * Point records are read in parallel from the mapped file.
+   * Returns whether the LAS file was found and readable.
+   * @params ptsfile LAS points file name.
+   * @params subdiv Tile structure resolution: number of grouped columns.
+   * @params ground Ground points (class 2) only loading modality.
+   */
+  bool loadLASFile (std::string ptsfile, int subdiv, bool ground = false);
+
   /**
    * Saves the point tile into an XYZ or XYZL file.
    * Returns whether saving succeeded.
@@ -411,6 +492,22 @@ private:
    * Arbitrarily set to 5 mm to account for 10mm coordinate rounding.
    */
   static const int R_OFF;
+  /** Size of the tile file header (in bytes). */
+  static const int HEADER_SIZE;
+  /** Leading tag of packed tile files (first int of former ones is > 0). */
+  static const int PACKED_TAG;
+  /** Count of cells in a block of packed points decoded at once. */
+  static const int PACK_BLOCK;
+  /** Minimal count of points in a cell to index its subcells. */
+  static const int SUBCELL_INDEX_MIN;
+  /** Minimal size of point file parts read in parallel (in bytes). */
+  static const int XYZ_CHUNK_MIN;
+  /** Minimal size of LAS file header (in bytes). */
+  static const int LAS_HEADER_MIN;
+  /** Minimal size of LAS 1.4 file header (in bytes). */
+  static const int LAS_HEADER_MIN_14;
+  /** Ground class of LAS points. */
+  static const int LAS_GROUND;
 
 
   /** Count of rows. */
@@ -437,12 +534,130 @@ private:
   unsigned char *labels;
   /** Tile cell addresses in the point array. */
   int *cells;
+  /** Tile file mapping (NULL if tile data is not mapped). */
+  MappedFile *mapping;
+  /** Packed points (NULL if the tile was not loaded from a packed file). */
+  unsigned char *pdata;
+  /** Size of packed points (in bytes). */
+  int64_t psize;
+  /** Block start addresses in the packed points. */
+  int64_t *pblocks;
+  /** Block decoding status. */
+  std::atomic<bool> *pdone;
+  /** Lock on blocks decoding. */
+  std::mutex *plock;
+  /** Subcell start index of each cell (-1 if cell subcells not indexed). */
+  int *sindex;
+  /** Subcell starts (from their cell start) in indexed cells. */
+  unsigned short *sstarts;
+  /** Count of subcell starts. */
+  int snb;
 
 
   /**
    * \brief Returns the name of the tile from registered name.
    */
   std::string tileName () const;
+
+  /**
+   * \brief Splits a point file in parts to be read in parallel.
+   * @param chunks File parts to create.
+   * @param start File start.
+   * @param end File end.
+   * @param reclen Record length of binary files, 0 for text files.
+   */
+  void splitChunks (std::vector<PtChunk> &chunks,
+                    const char *start, const char *end, int reclen);
+
+  /**
+   * \brief Adds a point read in a file to a file part.
+   * @param chk File part.
+   * @param x Point X coordinate (in file unit).
+   * @param y Point Y coordinate (in file unit).
+   * @param z Point Z coordinate (in file unit).
+   * @param subdiv Tile structure resolution: number of grouped columns.
+   * @param report Outlier report modality.
+   */
+  void addPoint (PtChunk &chk, double x, double y, double z,
+                 int subdiv, bool report) const;
+
+  /**
+   * \brief Parses the points of a part of a XYZ file.
+   * @param chk Part of the XYZ file.
+   * @param subdiv Tile structure resolution: number of grouped columns.
+   * @param labelled Presence of point labels in the file.
+   * @param lab_in Point label loading modality.
+   */
+  void parseXYZChunk (PtChunk &chk, int subdiv,
+                      bool labelled, bool lab_in) const;
+
+  /**
+   * \brief Reads the points of a part of a LAS file.
+   * @param chk Part of the LAS file.
+   * @param subdiv Tile structure resolution: number of grouped columns.
+   * @param fmt LAS point record format.
+   * @param ground Ground points only loading modality.
+   */
+  void parseLASChunk (PtChunk &chk, int subdiv,
+                      const LASFormat &fmt, bool ground) const;
+
+  /**
+   * \brief Arranges the points read in file parts in the tile cells.
+   * Points of a subcell are kept in file order.
+   * @param chunks File parts.
+   * @param subdiv Tile structure resolution: number of grouped columns.
+   * @param lab_in Point label loading modality.
+   */
+  void binPoints (std::vector<PtChunk> &chunks, int subdiv, bool lab_in);
+
+  /**
+   * \brief Creates the cell index from packed cell sizes and packing arrays.
+   * @param cnts Packed cell sizes.
+   */
+  void createPackedIndex (const unsigned char *cnts);
+
+  /**
+   * \brief Creates the subcell index of dense cells.
+   * @param fill Subcells start setting modality (needs available points).
+   */
+  void createSubcellIndex (bool fill = true);
+
+  /**
+   * \brief Deletes the subcell index.
+   */
+  void deleteSubcellIndex ();
+
+  /**
+   * \brief Sets the subcell starts of an indexed cell.
+   * @param c Cell index.
+   */
+  void indexSubcells (int c) const;
+
+  /**
+   * \brief Searches the first point of a subcell from its cell start.
+   * @param i Subcell column in the tile.
+   * @param j Subcell row in the tile.
+   */
+  Pt3i *findSubcellStart (int i, int j) const;
+
+  /**
+   * \brief Decodes the block of packed points containing given cell.
+   * @param c Cell index.
+   */
+  inline void unpackCell (int c) const {
+    if (! pdone[c / PACK_BLOCK].load (std::memory_order_acquire))
+      unpackBlock (c / PACK_BLOCK); }
+
+  /**
+   * \brief Decodes a block of packed points.
+   * @param b Block index.
+   */
+  void unpackBlock (int b) const;
+
+  /**
+   * \brief Decodes all packed points.
+   */
+  void unpackAll () const;
 };
 
 #endif
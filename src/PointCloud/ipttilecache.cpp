@@ -0,0 +1,223 @@
+/*  Copyright 2021 Philippe Even, Phuc Ngo and Pierre Even,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "ipttilecache.h"
+
+const int64_t IPtTileCache::DEFAULT_BUDGET = ((int64_t) 1) << 30;  // 1 GB
+
+
+IPtTileCache::IPtTileCache ()
+{
+  tiles = NULL;
+  count = 0;
+  max_bytes = DEFAULT_BUDGET;
+  bytes = 0;
+  mapped = false;
+  loader = NULL;
+  pins = NULL;
+  pending = NULL;
+  cached = NULL;
+  charged = NULL;
+  stamps = NULL;
+  clock = 0;
+}
+
+
+IPtTileCache::~IPtTileCache ()
+{
+  awaitAll ();
+  if (loader != NULL) delete loader;
+  if (count != 0)
+  {
+    delete [] pins;
+    delete [] pending;
+    delete [] cached;
+    delete [] charged;
+    delete [] stamps;
+  }
+}
+
+
+void IPtTileCache::init (IPtTile **tiles, int count)
+{
+  awaitAll ();
+  if (this->count != 0)
+  {
+    delete [] pins;
+    delete [] pending;
+    delete [] cached;
+    delete [] charged;
+    delete [] stamps;
+  }
+  bytes = 0;
+  clock = 0;
+  this->tiles = tiles;
+  this->count = count;
+  if (count == 0) return;
+  pins = new int[count];
+  pending = new bool[count];
+  cached = new bool[count];
+  charged = new int64_t[count];
+  stamps = new int64_t[count];
+  for (int k = 0; k < count; k++)
+  {
+    pins[k] = 0;
+    pending[k] = false;
+    cached[k] = false;
+    charged[k] = 0;
+    stamps[k] = 0;
+  }
+}
+
+
+void IPtTileCache::clear ()
+{
+  awaitAll ();
+  if (count != 0)
+  {
+    for (int k = 0; k < count; k++)
+      if (cached[k]) tiles[k]->unload ();
+    delete [] pins;
+    delete [] pending;
+    delete [] cached;
+    delete [] charged;
+    delete [] stamps;
+  }
+  tiles = NULL;
+  count = 0;
+  bytes = 0;
+  clock = 0;
+}
+
+
+void IPtTileCache::setBudget (int64_t bytes)
+{
+  max_bytes = bytes;
+  if (count != 0) evict (-1);
+}
+
+
+void IPtTileCache::setPrefetching (bool status)
+{
+  if (status && loader == NULL) loader = new IPtTileLoader ();
+  else if (! status && loader != NULL)
+  {
+    awaitAll ();
+    delete loader;
+    loader = NULL;
+  }
+}
+
+
+void IPtTileCache::request (int k)
+{
+  if (tiles[k] == NULL || pending[k]) return;
+  stamps[k] = ++clock;
+  if (! tiles[k]->unloaded ()) return;
+  if (loader == NULL) fetch (k);
+  else
+  {
+    // Header based estimate, read before the loader writes the tile
+    charged[k] = tiles[k]->dataSize ();
+    bytes += charged[k];
+    cached[k] = true;
+    pending[k] = true;
+    loader->request (tiles[k], mapped);
+    evict (k);
+  }
+}
+
+
+void IPtTileCache::pin (int k)
+{
+  if (tiles[k] == NULL) return;
+  pins[k] ++;
+  request (k);
+}
+
+
+void IPtTileCache::unpin (int k)
+{
+  if (pins[k] > 0) pins[k] --;
+}
+
+
+void IPtTileCache::awaitAll ()
+{
+  if (loader != NULL && count != 0)
+  {
+    loader->waitAll ();
+    for (int k = 0; k < count; k++)
+      if (pending[k])
+      {
+        pending[k] = false;
+        charge (k);
+      }
+  }
+}
+
+
+void IPtTileCache::fetch (int k)
+{
+  if (! (mapped ? tiles[k]->map () : tiles[k]->load ())) return;
+  cached[k] = true;
+  charge (k);
+  evict (k);
+}
+
+
+void IPtTileCache::await (int k)
+{
+  loader->wait (tiles[k]);
+  pending[k] = false;
+  charge (k);
+}
+
+
+void IPtTileCache::charge (int k)
+{
+  int64_t size = 0;
+  if (tiles[k]->unloaded ()) cached[k] = false;
+  else size = tiles[k]->dataSize ();
+  bytes += size - charged[k];
+  charged[k] = size;
+}
+
+
+void IPtTileCache::evict (int keep)
+{
+  while (max_bytes > 0 && bytes > max_bytes)
+  {
+    int old = -1;
+    for (int k = 0; k < count; k++)
+      if (cached[k] && k != keep && pins[k] == 0
+          && (old == -1 || stamps[k] < stamps[old])) old = k;
+    if (old == -1) return;  // everything left is in use
+    if (pending[old]) await (old);
+    if (cached[old]) tiles[old]->unload ();
+    cached[old] = false;
+    bytes -= charged[old];
+    charged[old] = 0;
+  }
+}
@@ -0,0 +1,207 @@
+/*  Copyright 2021 Philippe Even, Phuc Ngo and Pierre Even,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef IPT_TILE_CACHE_H
+#define IPT_TILE_CACHE_H
+
+#include <inttypes.h>
+#include "ipttile.h"
+#include "ipttileloader.h"
+
+
+/** 
+ * @class IPtTileCache ipttilecache.h
+ * \brief Memory-budgeted cache of point tiles.
+ * Tiles are referred to by their index in the tile array of a tile set.
+ * Tiles loaded by the cache are evicted in least recently used order when
+ *   the memory budget is exceeded, unless they are pinned.
+ * Tiles already loaded when the cache is set up are left out of the budget
+ *   and never evicted.
+ */
+class IPtTileCache
+{
+public:
+
+  /** Default memory budget (in bytes). */
+  static const int64_t DEFAULT_BUDGET;
+
+
+  /**
+   * \brief Creates an empty tile cache.
+   */
+  IPtTileCache ();
+
+  /**
+   * \brief Deletes the tile cache.
+   * Loaded tiles are not unloaded.
+   */
+  ~IPtTileCache ();
+
+  /**
+   * \brief Sets up the cache on a tile array.
+   * Previously cached tiles are left as they are, and all tiles already
+   *   loaded are left out of the cache.
+   * @param tiles Tile array (NULL entries for missing tiles).
+   * @param count Size of the tile array.
+   */
+  void init (IPtTile **tiles, int count);
+
+  /**
+   * \brief Unloads cached tiles and forgets the tile array.
+   */
+  void clear ();
+
+  /**
+   * \brief Returns the memory budget (in bytes).
+   */
+  inline int64_t budget () const { return max_bytes; }
+
+  /**
+   * \brief Sets the memory budget, and evicts tiles if exceeded.
+   * @param bytes New memory budget (in bytes), no limit if not positive.
+   */
+  void setBudget (int64_t bytes);
+
+  /**
+   * \brief Returns the memory size of cached tiles (in bytes).
+   */
+  inline int64_t footprint () const { return bytes; }
+
+  /**
+   * \brief Returns whether tile files are memory mapped rather than loaded.
+   */
+  inline bool mapping () const { return mapped; }
+
+  /**
+   * \brief Sets the tile file memory mapping modality.
+   * @param status Memory mapping status.
+   */
+  inline void setMapping (bool status) { mapped = status; }
+
+  /**
+   * \brief Returns whether requested tiles are loaded in background.
+   */
+  inline bool prefetching () const { return (loader != NULL); }
+
+  /**
+   * \brief Sets the background loading modality of requested tiles.
+   * @param status Background loading status.
+   */
+  void setPrefetching (bool status);
+
+  /**
+   * \brief Prepares a tile for access.
+   * Waits for its requested loading, or loads it if missing, and marks it
+   *   as recently used.
+   * @param k Tile index.
+   */
+  inline void touch (int k) {
+    if (count != 0)
+    {
+      if (pending[k]) await (k);
+      stamps[k] = ++clock;
+      if (tiles[k] != NULL && tiles[k]->unloaded ()) fetch (k);
+    }
+  }
+
+  /**
+   * \brief Requests the loading of a tile (in background if prefetching).
+   * @param k Tile index.
+   */
+  void request (int k);
+
+  /**
+   * \brief Requests a tile and protects it from eviction.
+   * Pins are counted: a tile pinned twice must be unpinned twice.
+   * @param k Tile index.
+   */
+  void pin (int k);
+
+  /**
+   * \brief Releases a tile protection from eviction.
+   * @param k Tile index.
+   */
+  void unpin (int k);
+
+  /**
+   * \brief Waits for the completion of all background loading requests.
+   */
+  void awaitAll ();
+
+
+private:
+
+  /** Tile array. */
+  IPtTile **tiles;
+  /** Tile array size. */
+  int count;
+  /** Memory budget (no limit if not positive). */
+  int64_t max_bytes;
+  /** Memory size of cached tiles. */
+  int64_t bytes;
+  /** Tile file memory mapping modality. */
+  bool mapped;
+  /** Background tile loader (NULL if loading on demand). */
+  IPtTileLoader *loader;
+  /** Pin counts of tiles. */
+  int *pins;
+  /** Background loading requested and not yet checked for each tile. */
+  bool *pending;
+  /** Cache membership of each tile. */
+  bool *cached;
+  /** Memory size charged to the budget for each tile. */
+  int64_t *charged;
+  /** Last access time of each tile. */
+  int64_t *stamps;
+  /** Access time counter. */
+  int64_t clock;
+
+
+  /**
+   * \brief Synchronously loads a missing tile.
+   * @param k Tile index.
+   */
+  void fetch (int k);
+
+  /**
+   * \brief Waits for the background loading of a tile.
+   * @param k Tile index.
+   */
+  void await (int k);
+
+  /**
+   * \brief Updates the budget charge of a tile to its actual memory size.
+   * The tile leaves the cache if its loading failed.
+   * @param k Tile index.
+   */
+  void charge (int k);
+
+  /**
+   * \brief Evicts least recently used tiles until the budget is met.
+   * @param keep Index of a tile to keep in any case.
+   */
+  void evict (int keep);
+};
+
+#endif
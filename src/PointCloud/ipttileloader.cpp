@@ -0,0 +1,101 @@
+/*  Copyright 2021 Philippe Even, Phuc Ngo and Pierre Even,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "ipttileloader.h"
+
+
+IPtTileLoader::IPtTileLoader ()
+{
+  current = NULL;
+  stopping = false;
+  worker = std::thread (&IPtTileLoader::run, this);
+}
+
+
+IPtTileLoader::~IPtTileLoader ()
+{
+  {
+    std::lock_guard<std::mutex> lock (mtx);
+    stopping = true;
+  }
+  requested.notify_one ();
+  worker.join ();
+}
+
+
+void IPtTileLoader::request (IPtTile *tile, bool mapped)
+{
+  Request req;
+  req.tile = tile;
+  req.mapped = mapped;
+  {
+    std::lock_guard<std::mutex> lock (mtx);
+    requests.push_back (req);
+  }
+  requested.notify_one ();
+}
+
+
+void IPtTileLoader::wait (const IPtTile *tile)
+{
+  std::unique_lock<std::mutex> lock (mtx);
+  while (isPending (tile)) completed.wait (lock);
+}
+
+
+void IPtTileLoader::waitAll ()
+{
+  std::unique_lock<std::mutex> lock (mtx);
+  while (current != NULL || ! requests.empty ()) completed.wait (lock);
+}
+
+
+void IPtTileLoader::run ()
+{
+  std::unique_lock<std::mutex> lock (mtx);
+  while (true)
+  {
+    while (requests.empty () && ! stopping) requested.wait (lock);
+    if (requests.empty ()) return;  // stopping with no more request
+    Request req = requests.front ();
+    requests.pop_front ();
+    current = req.tile;
+    lock.unlock ();
+    if (req.mapped) req.tile->map ();
+    else req.tile->load ();
+    lock.lock ();
+    current = NULL;
+    completed.notify_all ();
+  }
+}
+
+
+bool IPtTileLoader::isPending (const IPtTile *tile) const
+{
+  if (current == tile) return true;
+  std::deque<Request>::const_iterator it = requests.begin ();
+  while (it != requests.end ())
+    if ((it++)->tile == tile) return true;
+  return false;
+}
@@ -0,0 +1,115 @@
+/*  Copyright 2021 Philippe Even, Phuc Ngo and Pierre Even,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef IPT_TILE_LOADER_H
+#define IPT_TILE_LOADER_H
+
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "ipttile.h"
+
+
+/** 
+ * @class IPtTileLoader ipttileloader.h
+ * \brief Background loader of point tiles.
+ * Tile loading requests are processed in order by a dedicated thread.
+ * A loaded tile must not be accessed before the completion of its request
+ *   has been checked with wait.
+ */
+class IPtTileLoader
+{
+public:
+
+  /**
+   * \brief Creates a tile loader and starts its loading thread.
+   */
+  IPtTileLoader ();
+
+  /**
+   * \brief Deletes the tile loader after pending requests completion.
+   */
+  ~IPtTileLoader ();
+
+  /**
+   * \brief Requests the loading of a tile.
+   * @param tile Tile to load.
+   * @param mapped Memory mapping modality of the tile file.
+   */
+  void request (IPtTile *tile, bool mapped = false);
+
+  /**
+   * \brief Waits for the completion of all requests about given tile.
+   * @param tile Requested tile.
+   */
+  void wait (const IPtTile *tile);
+
+  /**
+   * \brief Waits for the completion of all requests.
+   */
+  void waitAll ();
+
+
+private:
+
+  /** Tile loading request. */
+  struct Request
+  {
+    /** Tile to load. */
+    IPtTile *tile;
+    /** Memory mapping modality. */
+    bool mapped;
+  };
+
+  /** Pending requests. */
+  std::deque<Request> requests;
+  /** Tile currently loaded. */
+  const IPtTile *current;
+  /** Loading thread stop request. */
+  bool stopping;
+  /** Request queue lock. */
+  std::mutex mtx;
+  /** New request signal. */
+  std::condition_variable requested;
+  /** Request completion signal. */
+  std::condition_variable completed;
+  /** Loading thread. */
+  std::thread worker;
+
+
+  /**
+   * \brief Processes the requests until the loader is stopped.
+   */
+  void run ();
+
+  /**
+   * \brief Checks whether some request about given tile is not yet completed.
+   * Request queue lock is assumed to be held.
+   * @param tile Requested tile.
+   */
+  bool isPending (const IPtTile *tile) const;
+};
+
+#endif
@@ -23,52 +23,42 @@
 */
 
 #include <iostream>
+#include <type_traits>
+#if defined (__SSE2__) || defined (_M_X64)
+#include <immintrin.h>
+#endif
 #include "ipttileset.h"
 
-const int IPtTileSet::DEFAULT_BUF_SIZE = 3;
+const int IPtTileSet::SWEEP_RADIUS = 1;
 
 const float IPtTileSet::MM2M = 0.001f;
 
 
-IPtTileSet::IPtTileSet (int buffer_size)
+IPtTileSet::IPtTileSet ()
 {
   tiles = NULL;
   cdiv = 1;
   tcols = 0;
   trows = 0;
-
-  buf_size = buffer_size;
-  if (buf_size < 0 || buf_size % 2 == 0) buf_size = DEFAULT_BUF_SIZE;
-  buf_w = buf_size;
-  buf_h = buf_size;
-  buf_pts = NULL;
-  buf_ind = NULL;
-  buf_x = 0;
-  buf_y = 0;
-  buf_np = 0;
-  buf_ni = 0;
-  buf_step = 0;
+  mapped = false;
+  packed = false;
+  cache = new IPtTileCache ();
+  sweep_pos = -1;
 }
 
 
 IPtTileSet::~IPtTileSet ()
 {
   clear ();
+  delete cache;
 }
 
 
 void IPtTileSet::clear ()
 {
-  if (buf_pts != NULL)
-  {
-    delete [] buf_pts;
-    buf_pts = NULL;
-  }
-  if (buf_ind != NULL)
-  {
-    delete [] buf_ind;
-    buf_ind = NULL;
-  }
+  cache->clear ();
+  sweep.clear ();
+  sweep_pos = -1;
   if (tiles != NULL)
   {
     for (int i = 0; i < tcols * trows; i ++)
@@ -85,7 +75,7 @@ bool IPtTileSet::addTile (std::string name, bool all)
   if (tiles == NULL || ! all)
   {
     IPtTile *tile = new IPtTile (name);
-    if (tile->load (all))
+    if (all && mapped ? tile->map () : tile->load (all))
     {
       vectiles.push_back (tile);
       return true;
@@ -97,7 +87,7 @@ bool IPtTileSet::addTile (std::string name, bool all)
 
 
 bool IPtTileSet::addTile (const std::string &dir, const std::string &name,
-                          int access)
+                          int access, bool complete)
 {
   bool found = false;
   int acc[2];
@@ -108,7 +98,7 @@ bool IPtTileSet::addTile (const std::string &dir, const std::string &name,
   if (tiles == NULL)
   {
     IPtTile *tile = new IPtTile (dir, name, access);
-    if (tile->load ())
+    if (complete ? (mapped ? tile->map () : tile->load ()) : tile->load (false))
     {
       vectiles.push_back (tile);
       found = true;
@@ -120,12 +110,9 @@ bool IPtTileSet::addTile (const std::string &dir, const std::string &name,
         IPtTile *extile = new IPtTile (dir, name, acc[i]);
         if (extile->load ())
         {
-          tile->setSize ((extile->countOfColumns () * acc[i]) / access,
-                         (extile->countOfRows () * acc[i]) / access);
-          tile->setArea (extile->xref (), extile->yref (), extile->top (),
-                         IPtTile::MIN_CELL_SIZE * access);
-          tile->setPoints (*extile);
-          tile->save ();
+          tile->convert (*extile, access);
+          bool saved = (packed ? tile->savePacked () : tile->save ());
+          if (saved && ! complete) tile->unload ();
           vectiles.push_back (tile);
           found = true;
         }
@@ -158,8 +145,6 @@ bool IPtTileSet::create ()
   twidth = (*it)->countOfColumns ();
   theight = (*it)->countOfRows ();
   cdiv = (*it)->cellSize () / IPtTile::MIN_CELL_SIZE;
-  buf_ni = twidth * theight + 1;
-  buf_np = 0;
   nb = 0;
   while (it != vectiles.end ())
   {
@@ -169,7 +154,6 @@ bool IPtTileSet::create ()
     if ((*it)->yref () > ymax) ymax = (*it)->yref ();
     if ((*it)->top () > zmax) zmax = (*it)->top ();
     nb += (*it)->size ();
-    if ((*it)->size () > buf_np) buf_np = (*it)->size ();
     it ++;
   }
 
@@ -190,26 +174,39 @@ bool IPtTileSet::create ()
     while (it != vectiles.begin ());
   }
   vectiles.clear ();
+  cache->init (tiles, tcols * trows);
   return (true);
 }
 
 
 bool IPtTileSet::loadPoints ()
 {
+  awaitTiles ();
   for (int i = 0; i < tcols * trows; i ++)
-    if (tiles[i] != NULL && ! tiles[i]->load ()) return false;
+    if (tiles[i] != NULL && ! (mapped ? tiles[i]->map () : tiles[i]->load ()))
+      return false;
   return true;
 }
 
 
+void IPtTileSet::setMemoryMapping (bool status)
+{
+  mapped = status;
+  cache->setMapping (status);
+}
+
+
 void IPtTileSet::updateAccessType (int oldtype, int newtype,
                                    const std::string &prefix)
 {
+  awaitTiles ();
+  std::lock_guard<std::mutex> lock (cache_lock);
   for (int j = 0; j < trows; j++)
     for (int i = 0; i < tcols; i++)
       if (tiles[j * tcols + i] != NULL)
       {
         IPtTile *oldtile = tiles[j * tcols + i];
+        bool complete = ! oldtile->unloaded ();
         std::string tname = oldtile->getName ();
         size_t last = tname.find_last_of ('/');
         if (last == std::string::npos) last = tname.find_last_of ('\\');
@@ -220,18 +217,18 @@ void IPtTileSet::updateAccessType (int oldtype, int newtype,
         name += shortname.substr (last + 1, std::string::npos);
 
         IPtTile *tile = new IPtTile (name);
-        if (! tile->load ())
+        if (! (complete ? (mapped ? tile->map () : tile->load ())
+                        : tile->load (false)))
         {
-          tile->setSize ((oldtile->countOfColumns () * oldtype) / newtype,
-                         (oldtile->countOfRows () * oldtype) / newtype);
-          tile->setArea (oldtile->xref (), oldtile->yref (), oldtile->top (),
-                         IPtTile::MIN_CELL_SIZE * newtype);
-          tile->setPoints (*oldtile);
-          tile->save (name);
+          touch (j * tcols + i);
+          tile->convert (*oldtile, newtype);
+          bool saved = (packed ? tile->savePacked (name) : tile->save (name));
+          if (saved && ! complete) tile->unload ();
         }
         delete oldtile;
         tiles[j * tcols + i] = tile;
       }
+  cache->init (tiles, tcols * trows);
   twidth = (twidth * oldtype) / newtype;
   theight = (theight * oldtype) / newtype;
   cdiv = (cdiv * newtype) / oldtype;
@@ -240,41 +237,61 @@ void IPtTileSet::updateAccessType (int oldtype, int newtype,
 
 int IPtTileSet::cellSize (int i, int j) const
 {
-  IPtTile *tile = tiles[(j/theight)*tcols+(i/twidth)];
-  return (tile != NULL ? tile->cellSize (i % twidth, j % theight) : 0);
+  int ktile = (j/theight)*tcols+(i/twidth);
+  IPtTile *tile = holdTile (ktile);
+  int size = (tile != NULL ? tile->cellSize (i % twidth, j % theight) : 0);
+  releaseTile (ktile);
+  return size;
 }
 
 
 int IPtTileSet::heightOfFirstPointIn (std::vector<Pt2i> &scan) const
 {
+  int ktile = -1;
+  IPtTile *tile = NULL;
+  int height = 0;
   std::vector<Pt2i>::iterator it = scan.begin ();
   while (it != scan.end ())
   {
     int icell = it->x () / cdiv, jcell = it->y () / cdiv; // cdiv = 10 avec over
     int itile = icell / twidth, jtile = jcell / theight;
-    IPtTile *tile = tiles[jtile * tcols + itile];
+    if (jtile * tcols + itile != ktile)
+    {
+      if (ktile != -1) releaseTile (ktile);
+      ktile = jtile * tcols + itile;
+      tile = holdTile (ktile);
+    }
     if (tile != NULL && ! tile->unloaded ())
     {
       icell = icell - itile * tile->countOfColumns ();
       jcell = jcell - jtile * tile->countOfRows ();
       if (tile->cellSize (icell, jcell) != 0)
-        return (tile->cellStartPt(icell, jcell)->z ());
+      {
+        height = tile->cellStartPt(icell, jcell)->z ();
+        break;
+      }
     }
     it ++;
   }
-  return 0;
+  if (ktile != -1) releaseTile (ktile);
+  return height;
 }
 
 
-bool IPtTileSet::collectPoints (std::vector<Pt3i> &pts, int i, int j) // const
+bool IPtTileSet::collectPoints (std::vector<Pt3i> &pts, int i, int j) const
 {
   int icell = i / cdiv, jcell = j / cdiv;                // cdiv = 10 when eco
   int itile = icell / twidth, jtile = jcell / theight;
   if (i < 0 || itile >= tcols || j < 0 || jtile >= trows) return false;
-  IPtTile *tile = tiles[jtile * tcols + itile];
+  int ktile = jtile * tcols + itile;
+  IPtTile *tile = holdTile (ktile);
   if (tile != NULL)
   {
-    if (tile->unloaded ()) return false;
+    if (tile->unloaded ())
+    {
+      releaseTile (ktile);
+      return false;
+    }
     icell = icell - itile * tile->countOfColumns ();
     jcell = jcell - jtile * tile->countOfRows ();
     int nbpts = tile->cellSize (icell, jcell);
@@ -300,8 +317,8 @@ bool IPtTileSet::collectPoints (std::vector<Pt3i> &pts, int i, int j) // const
         int cymax = cymin + cxy;
 
         Pt3i *ptfin = pt + nbpts;
-        while (pt->y () < cymin && pt != ptfin) pt ++;
-        while (pt->x () < cxmin && pt != ptfin) pt ++;
+        pt = tile->subcellStartPt (icell * cdiv + i % cdiv,
+                                   jcell * cdiv + j % cdiv);
         while (pt->x () < cxmax && pt->y () < cymax && pt != ptfin)
         {
           pts.push_back (Pt3i (txspread * itile + pt->x (),
@@ -312,71 +329,262 @@ bool IPtTileSet::collectPoints (std::vector<Pt3i> &pts, int i, int j) // const
       }
     }
   }
+  releaseTile (ktile);
   return true;
 }
 
 
-bool IPtTileSet::collectPoints (std::vector<Pt3f> &pts, int i, int j) // const
+bool IPtTileSet::collectPoints (std::vector<Pt3f> &pts, int i, int j) const
 {
   int icell = i / cdiv, jcell = j / cdiv;                // cdiv = 10 when eco
   int itile = icell / twidth, jtile = jcell / theight;
   if (i < 0 || itile >= tcols || j < 0 || jtile >= trows) return false;
-  IPtTile *tile = tiles[jtile * tcols + itile];
-  if (tile != NULL)
+  int ktile = jtile * tcols + itile;
+  IPtTile *tile = holdTile (ktile);
+  bool loaded = (tile == NULL || ! tile->unloaded ());
+  if (tile != NULL && loaded) gatherPoints (pts, tile, itile, jtile, i, j);
+  releaseTile (ktile);
+  return loaded;
+}
+
+
+int IPtTileSet::collectScanPoints (std::vector<Pt3f> &pts,
+                                   const std::vector<Pt2i> &scan,
+                                   std::vector<int> *ends) const
+{
+  int nbout = 0;
+  int ktile = -1;
+  IPtTile *tile = NULL;
+  if (ends != NULL) ends->reserve (ends->size () + scan.size ());
+  std::vector<Pt2i>::const_iterator it = scan.begin ();
+  while (it != scan.end ())
   {
-    if (tile->unloaded ()) return false;
-    icell = icell - itile * tile->countOfColumns ();
-    jcell = jcell - jtile * tile->countOfRows ();
-    int nbpts = tile->cellSize (icell, jcell);
-    if (nbpts != 0)
+    int i = it->x (), j = it->y ();
+    int itile = (i / cdiv) / twidth, jtile = (j / cdiv) / theight;
+    if (i < 0 || itile >= tcols || j < 0 || jtile >= trows) nbout ++;
+    else
     {
-      Pt3i *pt = tile->cellStartPt (icell, jcell);
-      if (cdiv == 1)
+      // Neighbour subcells mostly lie in the same tile
+      if (jtile * tcols + itile != ktile)
       {
-        for (int i = 0; i < nbpts; i++)
-        {
-          pts.push_back (Pt3f (((float) (txspread * itile + pt->x ())) * MM2M,
-                               ((float) (tyspread * jtile + pt->y ())) * MM2M,
-                               ((float) pt->z ()) * MM2M));
-          pt ++;
-        }
+        if (ktile != -1) releaseTile (ktile);
+        ktile = jtile * tcols + itile;
+        tile = holdTile (ktile);
       }
-      else
+      if (tile != NULL)
       {
-        int cxy = tile->cellSize () / cdiv;
-        int cxmin = icell * tile->cellSize () + (i % cdiv) * cxy;
-        int cymin = jcell * tile->cellSize () + (j % cdiv) * cxy;
-        int cxmax = cxmin + cxy;
-        int cymax = cymin + cxy;
+        if (tile->unloaded ()) nbout ++;
+        else gatherPoints (pts, tile, itile, jtile, i, j);
+      }
+    }
+    if (ends != NULL) ends->push_back ((int) (pts.size ()));
+    it ++;
+  }
+  if (ktile != -1) releaseTile (ktile);
+  return nbout;
+}
 
-        Pt3i *ptfin = pt + nbpts;
-        while (pt->y () < cymin && pt != ptfin) pt ++;
-        while (pt->x () < cxmin && pt != ptfin) pt ++;
-        while (pt->x () < cxmax && pt->y () < cymax && pt != ptfin)
+
+int IPtTileSet::collectScanProfile (std::vector<Pt2f> &prof,
+                                    const std::vector<Pt2i> &scan,
+                                    const Pt2f &org, const Vr2f &dir,
+                                    float len) const
+{
+  int nbout = 0;
+  int ktile = -1;
+  IPtTile *tile = NULL;
+  bool loaded = false;
+  std::vector<Pt2i>::const_iterator it = scan.begin ();
+  while (it != scan.end ())
+  {
+    int i = it->x (), j = it->y ();
+    int itile = (i / cdiv) / twidth, jtile = (j / cdiv) / theight;
+    if (i < 0 || itile >= tcols || j < 0 || jtile >= trows) nbout ++;
+    else
+    {
+      if (jtile * tcols + itile != ktile)
+      {
+        if (ktile != -1) releaseTile (ktile);
+        ktile = jtile * tcols + itile;
+        tile = holdTile (ktile);
+        loaded = (tile != NULL && ! tile->unloaded ());
+      }
+      if (tile != NULL)
+      {
+        if (! loaded) nbout ++;
+        else
         {
-          pts.push_back (Pt3f (((float) (txspread * itile + pt->x ())) * MM2M,
-                               ((float) (tyspread * jtile + pt->y ())) * MM2M,
-                               ((float) pt->z ()) * MM2M));
-          pt ++;
+          int nb = 0;
+          const Pt3i *pt = subcellPoints (nb, tile, itile, jtile, i, j);
+          if (nb != 0)
+            projectPoints (prof, pt, nb, txspread * itile, tyspread * jtile,
+                           org, dir, len);
         }
       }
     }
+    it ++;
+  }
+  if (ktile != -1) releaseTile (ktile);
+  return nbout;
+}
+
+
+IPtTile *IPtTileSet::holdTile (int k) const
+{
+  std::lock_guard<std::mutex> lock (cache_lock);
+  touch (k);
+  cache->pin (k);
+  return (tiles[k]);
+}
+
+
+void IPtTileSet::releaseTile (int k) const
+{
+  std::lock_guard<std::mutex> lock (cache_lock);
+  cache->unpin (k);
+}
+
+
+void IPtTileSet::gatherPoints (std::vector<Pt3f> &pts, const IPtTile *tile,
+                               int itile, int jtile, int i, int j) const
+{
+  int nbpts = 0;
+  const Pt3i *pt = subcellPoints (nbpts, tile, itile, jtile, i, j);
+  for (int k = 0; k < nbpts; k++)
+  {
+    pts.push_back (Pt3f (((float) (txspread * itile + pt->x ())) * MM2M,
+                         ((float) (tyspread * jtile + pt->y ())) * MM2M,
+                         ((float) pt->z ()) * MM2M));
+    pt ++;
+  }
+}
+
+
+const Pt3i *IPtTileSet::subcellPoints (int &nb, const IPtTile *tile,
+                                       int itile, int jtile,
+                                       int i, int j) const
+{
+  int icell = i / cdiv - itile * tile->countOfColumns ();
+  int jcell = j / cdiv - jtile * tile->countOfRows ();
+  nb = tile->cellSize (icell, jcell);
+  if (nb == 0) return NULL;
+  Pt3i *pt = tile->cellStartPt (icell, jcell);
+  if (cdiv == 1) return pt;
+
+  int cxy = tile->cellSize () / cdiv;
+  int cxmax = icell * tile->cellSize () + (i % cdiv) * cxy + cxy;
+  int cymax = jcell * tile->cellSize () + (j % cdiv) * cxy + cxy;
+  Pt3i *ptfin = pt + nb;
+  pt = tile->subcellStartPt (icell * cdiv + i % cdiv,
+                             jcell * cdiv + j % cdiv);
+  Pt3i *ptend = pt;
+  while (ptend != ptfin && ptend->x () < cxmax && ptend->y () < cymax)
+    ptend ++;
+  nb = (int) (ptend - pt);
+  return pt;
+}
+
+
+void IPtTileSet::projectPoints (std::vector<Pt2f> &prof, const Pt3i *pt,
+                                int nb, int xoff, int yoff, const Pt2f &org,
+                                const Vr2f &dir, float len) const
+{
+  // Same operations as Vr2f::scalarProduct on converted Pt3f points,
+  //   so that profiles do not depend on the instruction set.
+  int k = (int) (prof.size ());
+  prof.resize (k + nb);
+  static_assert (sizeof (Pt2f) == 2 * sizeof (float)
+                 && std::is_standard_layout<Pt2f>::value,
+                 "Pt2f layout changed");
+  float *out = reinterpret_cast<float *> (prof.data () + k);
+  static_assert (sizeof (Pt3i) == 4 * sizeof (int)
+                 && std::is_standard_layout<Pt3i>::value,
+                 "Pt3i layout changed");
+  const int *in = reinterpret_cast<const int *> (pt);
+  int n = 0;
+#if defined (__AVX2__)
+  const __m256i idx = _mm256_setr_epi32 (0, 4, 8, 12, 16, 20, 24, 28);
+  const __m256i xo8 = _mm256_set1_epi32 (xoff);
+  const __m256i yo8 = _mm256_set1_epi32 (yoff);
+  const __m256 mm8 = _mm256_set1_ps (MM2M);
+  const __m256 ox8 = _mm256_set1_ps (org.x ());
+  const __m256 oy8 = _mm256_set1_ps (org.y ());
+  const __m256 dx8 = _mm256_set1_ps (dir.x ());
+  const __m256 dy8 = _mm256_set1_ps (dir.y ());
+  const __m256 len8 = _mm256_set1_ps (len);
+  for (; n + 8 <= nb; n += 8)
+  {
+    const int *p = in + 4 * n;
+    __m256 x = _mm256_mul_ps (_mm256_cvtepi32_ps (_mm256_add_epi32 (xo8,
+                  _mm256_i32gather_epi32 (p, idx, 4))), mm8);
+    __m256 y = _mm256_mul_ps (_mm256_cvtepi32_ps (_mm256_add_epi32 (yo8,
+                  _mm256_i32gather_epi32 (p + 1, idx, 4))), mm8);
+    __m256 z = _mm256_mul_ps (_mm256_cvtepi32_ps (
+                  _mm256_i32gather_epi32 (p + 2, idx, 4)), mm8);
+    __m256 d = _mm256_div_ps (_mm256_add_ps (
+                 _mm256_mul_ps (_mm256_sub_ps (x, ox8), dx8),
+                 _mm256_mul_ps (_mm256_sub_ps (y, oy8), dy8)), len8);
+    __m256 lo = _mm256_unpacklo_ps (d, z);
+    __m256 hi = _mm256_unpackhi_ps (d, z);
+    _mm256_storeu_ps (out + 2 * n, _mm256_permute2f128_ps (lo, hi, 0x20));
+    _mm256_storeu_ps (out + 2 * n + 8, _mm256_permute2f128_ps (lo, hi, 0x31));
+  }
+#endif
+#if defined (__SSE2__) || defined (_M_X64)
+  const __m128i off = _mm_setr_epi32 (xoff, yoff, 0, 0);
+  const __m128 mm4 = _mm_set1_ps (MM2M);
+  const __m128 ox4 = _mm_set1_ps (org.x ());
+  const __m128 oy4 = _mm_set1_ps (org.y ());
+  const __m128 dx4 = _mm_set1_ps (dir.x ());
+  const __m128 dy4 = _mm_set1_ps (dir.y ());
+  const __m128 len4 = _mm_set1_ps (len);
+  for (; n + 4 <= nb; n += 4)
+  {
+    // One point (x, y, z, clone count) per vector, then transposed
+    const __m128i *p = reinterpret_cast<const __m128i *> (in + 4 * n);
+    __m128 x = _mm_mul_ps (_mm_cvtepi32_ps (
+                 _mm_add_epi32 (_mm_loadu_si128 (p), off)), mm4);
+    __m128 y = _mm_mul_ps (_mm_cvtepi32_ps (
+                 _mm_add_epi32 (_mm_loadu_si128 (p + 1), off)), mm4);
+    __m128 z = _mm_mul_ps (_mm_cvtepi32_ps (
+                 _mm_add_epi32 (_mm_loadu_si128 (p + 2), off)), mm4);
+    __m128 w = _mm_mul_ps (_mm_cvtepi32_ps (
+                 _mm_add_epi32 (_mm_loadu_si128 (p + 3), off)), mm4);
+    _MM_TRANSPOSE4_PS (x, y, z, w);
+    __m128 d = _mm_div_ps (_mm_add_ps (
+                 _mm_mul_ps (_mm_sub_ps (x, ox4), dx4),
+                 _mm_mul_ps (_mm_sub_ps (y, oy4), dy4)), len4);
+    _mm_storeu_ps (out + 2 * n, _mm_unpacklo_ps (d, z));
+    _mm_storeu_ps (out + 2 * n + 4, _mm_unpackhi_ps (d, z));
+  }
+#endif
+  for (; n < nb; n++)
+  {
+    const int *p = in + 4 * n;
+    float x = ((float) (xoff + p[0])) * MM2M - org.x ();
+    float y = ((float) (yoff + p[1])) * MM2M - org.y ();
+    out[2 * n] = (x * dir.x () + y * dir.y ()) / len;
+    out[2 * n + 1] = ((float) p[2]) * MM2M;
   }
-  return true;
 }
 
 
 bool IPtTileSet::collectPointsAndLabels (
                          std::vector<Pt3f> &pts, std::vector<int> &tls,
-                         std::vector<int> &lbs, int i, int j) // const
+                         std::vector<int> &lbs, int i, int j) const
 {
   int icell = i / cdiv, jcell = j / cdiv;                // cdiv = 10 when eco
   int itile = icell / twidth, jtile = jcell / theight;
   if (i < 0 || itile >= tcols || j < 0 || jtile >= trows) return false;
-  IPtTile *tile = tiles[jtile * tcols + itile];
+  int ktile = jtile * tcols + itile;
+  IPtTile *tile = holdTile (ktile);
   if (tile != NULL)
   {
-    if (tile->unloaded ()) return false;
+    if (tile->unloaded ())
+    {
+      releaseTile (ktile);
+      return false;
+    }
     icell = icell - itile * tile->countOfColumns ();
     jcell = jcell - jtile * tile->countOfRows ();
     int nbpts = tile->cellSize (icell, jcell);
@@ -405,16 +613,10 @@ bool IPtTileSet::collectPointsAndLabels (
         int cymax = cymin + cxy;
 
         Pt3i *ptfin = pt + nbpts;
-        while (pt->y () < cymin && pt != ptfin)
-        {
-          pt ++;
-          lab ++;
-        }
-        while (pt->x () < cxmin && pt != ptfin)
-        {
-          pt ++;
-          lab ++;
-        }
+        Pt3i *ptstart = tile->subcellStartPt (icell * cdiv + i % cdiv,
+                                              jcell * cdiv + j % cdiv);
+        lab += (int) (ptstart - pt);
+        pt = ptstart;
         while (pt->x () < cxmax && pt->y () < cymax && pt != ptfin)
         {
           pts.push_back (Pt3f (((float) (txspread * itile + pt->x ())) * MM2M,
@@ -427,6 +629,7 @@ bool IPtTileSet::collectPointsAndLabels (
       }
     }
   }
+  releaseTile (ktile);
   return true;
 }
 
@@ -437,7 +640,7 @@ void IPtTileSet::collectUnsortedPoints (std::vector<Pt3f> &pts,
   int icell = i / cdiv, jcell = j / cdiv;
   int itile = icell / twidth, jtile = jcell / theight;
   if (i < 0 || itile >= tcols || j < 0 || jtile >= trows) return;
-  IPtTile *tile = tiles[jtile * tcols + itile];
+  IPtTile *tile = holdTile (jtile * tcols + itile);
   if (tile != NULL)
   {
     icell = icell - itile * tile->countOfColumns ();
@@ -462,11 +665,13 @@ void IPtTileSet::collectUnsortedPoints (std::vector<Pt3f> &pts,
       }
     }
   }
+  releaseTile (jtile * tcols + itile);
 }
 
 
 int IPtTileSet::cellMaxSize () const
 {
+  awaitTiles ();
   int max = 0;
   for (int j = 0; j < trows; j++)
     for (int i = 0; i < tcols; i++)
@@ -481,6 +686,7 @@ int IPtTileSet::cellMaxSize () const
 
 int IPtTileSet::cellMinSize (int max) const
 {
+  awaitTiles ();
   int min = max;
   for (int j = 0; j < trows; j++)
     for (int i = 0; i < tcols; i++)
@@ -493,518 +699,73 @@ int IPtTileSet::cellMinSize (int max) const
 }
 
 
-int IPtTileSet::bufferSize () const
-{
-  return buf_size;
-}
-
-
-void IPtTileSet::setBufferSize (int val)
-{
-  if (val > 0 && val % 2 == 1)
-  {
-    buf_size = val;
-    buf_w = buf_size;
-    buf_h = buf_size;
-    if (buf_pts != NULL)
-    {
-      if (buf_w > tcols) buf_w = tcols;
-      if (buf_h > trows) buf_h = trows;
-      buf_pts = new Pt3i[buf_w * buf_h * buf_np];
-      buf_ind = new int[buf_w * buf_h * buf_ni];
-    }
-  }
-}
-
-
-void IPtTileSet::deleteBuffers ()
-{
-  if (buf_pts != NULL) delete [] buf_pts;
-  buf_pts = NULL;
-  if (buf_ind != NULL) delete [] buf_ind;
-  buf_ind = NULL;
-}
-
-
-void IPtTileSet::createBuffers ()
-{
-  if (buf_w > tcols) buf_w = tcols;
-  if (buf_h > trows) buf_h = trows;
-  buf_pts = new Pt3i[buf_w * buf_h * buf_np];
-  buf_ind = new int[buf_w * buf_h * buf_ni];
-}
-
-
 int IPtTileSet::nextTile ()
 {
-  int k, bk;
-
-  // SWEEP START
-  if (buf_step == 0)
-  {
-//    std::cout << "SWEEP START IN ..." << std::endl;
-    for (int j = 0; j < buf_h; j++)
-      for (int i = 0; i < buf_w; i++)
-      {
-        k = j * tcols + i;
-        bk = j * buf_w + i;
-        // std::cout << "ADD " << k << " IN " << bk << std::endl;
-        if (tiles[k] != NULL)
-          tiles[k]->loadPoints (buf_ind + bk * buf_ni, buf_pts + bk * buf_np);
-      }
-    buf_x = 0;
-    buf_y = 0;
-    if (buf_w == 1 && buf_h == 1) buf_step = 13;
-    else buf_step = (buf_w > buf_h ? 7 : 1);
-//    std::cout << "SWEEP START OUT -> " << buf_x << " " << buf_y << std::endl;
-  }
-
-  // HORIZONTAL SWEEP - FIRST SAW
-  else if (buf_step == 1)
-  {
-//    std::cout << "FIRST SAW IN ..." << std::endl;
-    if ((buf_h == trows && buf_y == buf_h - 1)
-        || (buf_h != trows && buf_y == buf_h / 2)) // next tooth
-    {
-      buf_x ++;
-      buf_y = 0;
-      if (buf_w != tcols && buf_x > buf_w / 2 && buf_x + buf_w / 2 < tcols)
-      {
-        k = buf_x - buf_w / 2 - 1;
-        for (int j = 0; j < buf_h; j++)
-        {
-          // std::cout << "RELIZ " << k << std::endl;
-          if (tiles[k] != NULL) tiles[k]->releasePoints ();
-          k += tcols;
-        }
-        k = buf_x + buf_w / 2;
-        bk = k % buf_w;
-        for (int j = 0; j < buf_h; j++)
-        {
-          // std::cout << "ADD " << k << " IN " << bk << std::endl;
-          if (tiles[k] != NULL)
-            tiles[k]->loadPoints (buf_ind + bk * buf_ni, buf_pts + bk * buf_np);
-          k += tcols;
-          bk += buf_w;
-          if (bk >= buf_w * buf_h) bk -= buf_w * buf_h;
-        }
-      }
-    }
-    else // same tooth
-    {
-      buf_y ++;
-      if (buf_x == tcols - 1)
-      {
-        if (buf_y == trows - 1) buf_step = 13;
-        else if (buf_h != trows && buf_y == buf_w / 2) buf_step = 2;
-      }
-    }
-//    std::cout << "FIRST SAW OUT -> " << buf_x << " " << buf_y << std::endl;
-  }
-
-  // HORIZONTAL SWEEP - CLIMB TO NEXT ROW
-  else if (buf_step == 2)
-  {
-//    std::cout << "CLIMB IN ..." << std::endl;
-    buf_y ++;
-    k = (buf_y - buf_h / 2 - 1) * tcols;
-    if (buf_x != 0) k += tcols - buf_w;
-    for (int i = 0; i < buf_w; i++)
-    {
-      // std::cout << "RELIZ " << k << std::endl;
-      if (tiles[k] != NULL) tiles[k]->releasePoints ();
-      k ++;
-    }
-    k += buf_h * tcols - buf_w;
-    bk = ((k / tcols) % buf_h) * buf_w + ((k % tcols) % buf_w);
-    for (int i = 0; i < buf_w; i++)
-    {
-      // std::cout << "ADD " << k << " IN " << bk << std::endl;
-      if (tiles[k] != NULL)
-        tiles[k]->loadPoints (buf_ind + bk * buf_ni, buf_pts + bk * buf_np);
-      k ++;
-      if (++bk % buf_w == 0) bk -= buf_w;
-    }
-    buf_step = (buf_y + buf_h / 2 < trows - 1 ?
-                (buf_x != 0 ? 3 : 4) : (buf_x != 0 ? 6 : 5));
-//    std::cout << "CLIMB OUT -> " << buf_x << " " << buf_y << std::endl;
-  }
-
-  // HORIZONTAL SWEEP - WAY BACK
-  else if (buf_step == 3)
-  {
-//    std::cout << "WAY BACK IN ..." << std::endl;
-    if (buf_x + buf_w / 2 < tcols && buf_x > buf_w / 2)
-    {
-      k = (buf_y - buf_h / 2) * tcols + buf_x + buf_w / 2;
-      for (int j = 0; j < buf_h; j++)
-      {
-        // std::cout << "RELIZ " << k << std::endl;
-        if (tiles[k] != NULL) tiles[k]->releasePoints ();
-        k += tcols;
-      }
-      buf_x --;
-      k -= buf_w + tcols * buf_h;
-      bk = ((k / tcols) % buf_h) * buf_w + ((k % tcols) % buf_w);
-      for (int j = 0; j < buf_h; j++)
-      {
-        // std::cout << "ADD " << k << " IN " << bk << std::endl;
-        if (tiles[k] != NULL)
-          tiles[k]->loadPoints (buf_ind + bk * buf_ni, buf_pts + bk * buf_np);
-        k += tcols;
-        bk += buf_w;
-        if (bk >= buf_h * buf_w) bk -= buf_h * buf_w;
-      }
-    }
-    else buf_x --;
-    if (buf_x == 0) buf_step = 2;
-//    std::cout << "WAY BACK OUT -> " << buf_x << " " << buf_y << std::endl;
-  }
-
-  // HORIZONTAL SWEEP - WAY ON
-  else if (buf_step == 4)
-  {
-//    std::cout << "WAY ON IN ..." << std::endl;
-    if (buf_x >= buf_w / 2 && buf_x + buf_w / 2 < tcols - 1)
-    {
-      k = (buf_y - buf_h / 2) * tcols + buf_x - buf_w / 2;
-      for (int j = 0; j < buf_h; j++)
-      {
-        // std::cout << "RELIZ " << k << std::endl;
-        if (tiles[k] != NULL) tiles[k]->releasePoints ();
-        k += tcols;
-      }
-      buf_x ++;
-      k += buf_w - buf_h * tcols;
-      bk = ((k / tcols) % buf_h) * buf_w + ((k % tcols) % buf_w);
-      for (int j = 0; j < buf_h; j++)
-      {
-        // std::cout << "ADD " << k << " IN " << bk << std::endl;
-        if (tiles[k] != NULL)
-          tiles[k]->loadPoints (buf_ind + bk * buf_ni, buf_pts + bk * buf_np);
-        k += tcols;
-        bk += buf_w;
-        if (bk >= buf_h * buf_w) bk -= buf_h * buf_w;
-      }
-    }
-    else buf_x ++;
-    if (buf_x == tcols - 1) buf_step = 2;
-//    std::cout << "WAY ON OUT -> " << buf_x << " " << buf_y << std::endl;
-  }
-
-  // HORIZONTAL SWEEP - LAST SAW ON
-  else if (buf_step == 5)
-  {
-//    std::cout << "LAST SAW ON IN ..." << std::endl;
-    if (buf_y == trows - 1) // next tooth
-    {
-      buf_x ++;
-      buf_y -= buf_h / 2;
-      if (buf_w != tcols && buf_x > buf_w / 2 && buf_x + buf_w / 2 < tcols)
-      {
-        k = (buf_y - buf_h / 2) * tcols + buf_x - buf_w / 2 - 1;
-        for (int j = 0; j < buf_h; j++)
-        {
-          // std::cout << "RELIZ " << k << std::endl;
-          if (tiles[k] != NULL) tiles[k]->releasePoints ();
-          k += tcols;
-        }
-        k += buf_w - buf_h * tcols;
-        bk = ((k / tcols) % buf_h) * buf_w + ((k % tcols) % buf_w);
-        for (int j = 0; j < buf_h; j++)
-        {
-          // std::cout << "ADD " << k << " IN " << bk << std::endl;
-          if (tiles[k] != NULL)
-            tiles[k]->loadPoints (buf_ind + bk * buf_ni, buf_pts + bk * buf_np);
-          k += tcols;
-          bk += buf_w;
-          if (bk >= buf_w * buf_h) bk -= buf_w * buf_h;
-        }
-      }
-    }
-    else // same tooth
-    {
-      buf_y ++;
-      if (buf_y == trows - 1 && buf_x == tcols - 1) buf_step = 13;
-    }
-//    std::cout << "LAST SAW ON OUT -> " << buf_x << " " << buf_y << std::endl;
-  }
-
-  // HORIZONTAL SWEEP - LAST SAW BACK
-  else if (buf_step == 6)
-  {
-//    std::cout << "LAST SAW BACK IN ..." << std::endl;
-    if (buf_y == trows - 1) // next tooth
-    {
-      buf_x --;
-      buf_y -= buf_h / 2;
-      if (buf_w != tcols && buf_x >= buf_w / 2 && buf_x + buf_w / 2 < tcols - 1)
-      {
-        k = (buf_y - buf_h / 2) * tcols + buf_x + buf_w / 2 + 1;
-        for (int j = 0; j < buf_h; j++)
-        {
-          // std::cout << "RELIZ " << k << std::endl;
-          if (tiles[k] != NULL) tiles[k]->releasePoints ();
-          k += tcols;
-        }
-        k = (trows - buf_h) * tcols + buf_x - buf_w / 2;
-        bk = ((k / tcols) % buf_h) * buf_w + ((k % tcols) % buf_w);
-        for (int j = 0; j < buf_h; j++)
-        {
-          // std::cout << "ADD " << k << " IN " << bk << std::endl;
-          if (tiles[k] != NULL)
-            tiles[k]->loadPoints (buf_ind + bk * buf_ni, buf_pts + bk * buf_np);
-          k += tcols;
-          bk += buf_w;
-          if (bk >= buf_h * buf_w) bk -= buf_h * buf_w;
-        }
-      }
-    }
-    else // same tooth
-    {
-      buf_y ++;
-      if (buf_y == trows - 1 && buf_x == 0) buf_step = 13;
-    }
-//    std::cout << "LAST SAW BACK OUT -> " << buf_x << " " << buf_y << std::endl;
-  }
-
-  // VERTICAL SWEEP - FIRST SAW
-  else if (buf_step == 7)
+  if (tiles == NULL) return (-1);
+  if (sweep_pos == -1) createSweep ();
+  int k = (sweep_pos < (int) (sweep.size ()) ? sweep[sweep_pos] : -1);
+  std::lock_guard<std::mutex> lock (cache_lock);
+  if (k != -1) pinNeighbourhood (k, true);
+  if (sweep_pos != 0) pinNeighbourhood (sweep[sweep_pos - 1], false);
+  if (k == -1)
   {
-//    std::cout << "V FIRST SAW IN ..." << std::endl;
-    if ((buf_w == tcols && buf_x == buf_w - 1)      // stripe end
-        || (buf_w != tcols && buf_x == buf_w / 2))  // stripe center
-    {
-      // process next tooth
-      buf_y ++;
-      buf_x = 0;
-      if (buf_h != trows && buf_y > buf_h / 2 && buf_y + buf_h / 2 < trows)
-      {
-        k = (buf_y - buf_h / 2 - 1) * tcols;
-        for (int i = 0; i < buf_w; i++)
-        {
-          // std::cout << "RELIZ " << k << std::endl;
-          if (tiles[k] != NULL) tiles[k]->releasePoints ();
-          k ++;
-        }
-        k = (buf_y + buf_h / 2) * tcols;
-        bk = (k % buf_h) * buf_w;
-        for (int i = 0; i < buf_w; i++)
-        {
-          // std::cout << "ADD " << k << " IN " << bk << std::endl;
-          if (tiles[k] != NULL)
-            tiles[k]->loadPoints (buf_ind + bk * buf_ni, buf_pts + bk * buf_np);
-          k ++;
-          if (++bk % buf_w == 0) bk -= buf_w;
-        }
-      }
-    }
-    else // same tooth
-    {
-      buf_x ++;
-      if (buf_y == trows - 1)
-      {
-        if (buf_x == tcols - 1) buf_step = 13;
-        else if (buf_w != tcols && buf_x == buf_h / 2) buf_step = 8;
-      }
-    }
-//    std::cout << "V FIRST SAW OUT -> " << buf_x << " " << buf_y << std::endl;
+    sweep_pos = -1;
+    return (-1);
   }
-
-  // VERTICAL SWEEP - CLIMB TO NEXT ROW
-  else if (buf_step == 8)
+  if (++sweep_pos < (int) (sweep.size ()))
   {
-//    std::cout << "V CLIMB IN ..." << std::endl;
-    buf_x ++;
-    k = buf_x - buf_w / 2 - 1;
-    if (buf_y != 0) k += (trows - buf_h) * tcols;
-    for (int j = 0; j < buf_h; j++)
-    {
-      // std::cout << "RELIZ " << k << std::endl;
-      if (tiles[k] != NULL) tiles[k]->releasePoints ();
-      k += tcols;
-    }
-    k += buf_w - buf_h * tcols;
-    bk = ((k / tcols) % buf_h) * buf_w + ((k % tcols) % buf_w);
-    for (int j = 0; j < buf_h; j++)
-    {
-      // std::cout << "ADD " << k << " IN " << bk << std::endl;
-      if (tiles[k] != NULL)
-        tiles[k]->loadPoints (buf_ind + bk * buf_ni, buf_pts + bk * buf_np);
-      k += tcols;
-      bk += buf_w;
-      if (bk >= buf_w * buf_h) bk -= buf_w * buf_h;
-    }
-    buf_step = (buf_x + buf_w / 2 < tcols - 1 ?
-                (buf_y != 0 ? 9 : 10) : (buf_y != 0 ? 12 : 11));
-//    std::cout << "V CLIMB OUT -> " << buf_x << " " << buf_y << std::endl;
+    // Requests the next neighbourhood in advance
+    int nk = sweep[sweep_pos];
+    int ni = nk % tcols, nj = nk / tcols;
+    for (int j = nj - SWEEP_RADIUS; j <= nj + SWEEP_RADIUS; j++)
+      for (int i = ni - SWEEP_RADIUS; i <= ni + SWEEP_RADIUS; i++)
+        if (i >= 0 && i < tcols && j >= 0 && j < trows)
+          cache->request (j * tcols + i);
   }
+  return (k);
+}
 
-  // VERTICAL SWEEP - WAY BACK
-  else if (buf_step == 9)
-  {
-//    std::cout << "V WAY BACK IN ..." << std::endl;
-    if (buf_y + buf_h / 2 < trows && buf_y > buf_h / 2)
-    {
-      k = (buf_x - buf_w / 2) + (buf_y + buf_h / 2) * tcols;
-      for (int i = 0; i < buf_w; i++)
-      {
-        // std::cout << "RELIZ " << k << std::endl;
-        if (tiles[k] != NULL) tiles[k]->releasePoints ();
-        k ++;
-      }
-      buf_y --;
-      k -= buf_h * tcols + buf_w;
-      bk = ((k / tcols) % buf_h) * buf_w + ((k % tcols) % buf_w);
-      for (int j = 0; j < buf_h; j++)
-      {
-        // std::cout << "ADD " << k << " IN " << bk << std::endl;
-        if (tiles[k] != NULL)
-          tiles[k]->loadPoints (buf_ind + bk * buf_ni, buf_pts + bk * buf_np);
-        k ++;
-        if (++bk % buf_w == 0) bk -= buf_w;
-      }
-    }
-    else buf_y --;
-    if (buf_y == 0) buf_step = 8;
-//    std::cout << "V WAY BACK OUT -> " << buf_x << " " << buf_y << std::endl;
-  }
 
-  // VERTICAL SWEEP - WAY ON
-  else if (buf_step == 10)
+void IPtTileSet::createSweep ()
+{
+  // Stripes of (2 * radius + 1) tiles along the longest side of the set,
+  //   alternately swept forth and back, each column (or row) of a stripe
+  //   being alternately swept up and down.
+  sweep.clear ();
+  bool horizontal = (tcols >= trows);
+  int along = (horizontal ? tcols : trows);
+  int across = (horizontal ? trows : tcols);
+  int swidth = 2 * SWEEP_RADIUS + 1;
+  bool up = true;
+  for (int s = 0; s * swidth < across; s++)
   {
-//    std::cout << "V WAY ON IN ..." << std::endl;
-    if (buf_y >= buf_h / 2 && buf_y + buf_h / 2 < trows - 1)
+    int smin = s * swidth;
+    int smax = (smin + swidth < across ? smin + swidth : across);
+    for (int a = 0; a < along; a++)
     {
-      k = (buf_x - buf_w / 2) + (buf_y - buf_h / 2) * tcols;
-      for (int i = 0; i < buf_w; i++)
-      {
-        // std::cout << "RELIZ " << k << std::endl;
-        if (tiles[k] != NULL) tiles[k]->releasePoints ();
-        k ++;
-      }
-      buf_y ++;
-      k -= buf_w + tcols * buf_h;
-      bk = ((k / tcols) % buf_h) * buf_w + ((k % tcols) % buf_w);
-      for (int i = 0; i < buf_w; i++)
+      int pa = (s % 2 == 0 ? a : along - 1 - a);
+      for (int b = 0; b < smax - smin; b++)
       {
-        // std::cout << "ADD " << k << " IN " << bk << std::endl;
-        if (tiles[k] != NULL)
-          tiles[k]->loadPoints (buf_ind + bk * buf_ni, buf_pts + bk * buf_np);
-        k ++;
-        if (++bk % buf_w == 0) bk -= buf_w;
+        int pb = (up ? smin + b : smax - 1 - b);
+        sweep.push_back (horizontal ? pb * tcols + pa : pa * tcols + pb);
       }
+      up = ! up;
     }
-    else buf_y ++;
-    if (buf_y == trows - 1) buf_step = 8;
-//    std::cout << "V WAY ON OUT -> " << buf_x << " " << buf_y << std::endl;
-  }
-
-  // VERTICAL SWEEP - LAST SAW ON
-  else if (buf_step == 11)
-  {
-//    std::cout << "V LAST SAW ON IN ..." << std::endl;
-    if (buf_x == tcols - 1) // next tooth
-    {
-      buf_y ++;
-      buf_x -= buf_w / 2;
-      if (buf_h != trows && buf_y > buf_h / 2 && buf_y + buf_h / 2 < trows)
-      {
-        k = (buf_x - buf_w / 2) + (buf_y - buf_h / 2 - 1) * tcols;
-        for (int i = 0; i < buf_w; i++)
-        {
-          // std::cout << "RELIZ " << k << std::endl;
-          if (tiles[k] != NULL) tiles[k]->releasePoints ();
-          k ++;
-        }
-        k += buf_h * tcols - buf_w;
-        bk = ((k / tcols) % buf_h) * buf_w + ((k % tcols) % buf_w);
-        for (int i = 0; i < buf_w; i++)
-        {
-          // std::cout << "ADD " << k << " IN " << bk << std::endl;
-          if (tiles[k] != NULL)
-            tiles[k]->loadPoints (buf_ind + bk * buf_ni, buf_pts + bk * buf_np);
-          k ++;
-          if (++bk % buf_w == 0) bk -= buf_w;
-        }
-      }
-    }
-    else // same tooth
-    {
-      buf_x ++;
-      if (buf_x == tcols - 1 && buf_y == trows - 1) buf_step = 13;
-    }
-//    std::cout << "V LAST SAW ON OUT -> " << buf_x << " " << buf_y << std::endl;
   }
+  sweep_pos = 0;
+}
 
-  // VERTICAL SWEEP - LAST SAW BACK
-  else if (buf_step == 12)
-  {
-//    std::cout << "V LAST SAW BACK IN ..." << std::endl;
-    if (buf_x == tcols - 1) // next tooth
-    {
-      buf_y --;
-      buf_x -= buf_w / 2;
-      if (buf_h != trows && buf_y >= buf_h / 2 && buf_y + buf_h / 2 < trows - 1)
-      {
-        k = (buf_x - buf_w / 2) + (buf_y + buf_h / 2 + 1) * tcols;
-        for (int i = 0; i < buf_w; i++)
-        {
-          // std::cout << "RELIZ " << k << std::endl;
-          if (tiles[k] != NULL) tiles[k]->releasePoints ();
-          k ++;
-        }
-        k = (tcols - buf_w) + (buf_y - buf_h / 2) * tcols;
-        bk = ((k / tcols) % buf_h) * buf_w + ((k % tcols) % buf_w);
-        for (int i = 0; i < buf_w; i++)
-        {
-          // std::cout << "ADD " << k << " IN " << bk << std::endl;
-          if (tiles[k] != NULL)
-            tiles[k]->loadPoints (buf_ind + bk * buf_ni, buf_pts + bk * buf_np);
-          k ++;
-          if (++bk % buf_w == 0) bk -= buf_w;
-        }
-      }
-    }
-    else // same tooth
-    {
-      buf_x ++;
-      if (buf_x == tcols - 1 && buf_y == 0) buf_step = 13;
-    }
-//    std::cout << "V LAST SAW BACK OUT -> " << buf_x << " " << buf_y
-//              << std::endl;
-  }
 
-  // SWEEP STOP
-  else if (buf_step == 13)
-  {
-//    std::cout << "SWEEP STOP IN ..." << std::endl;
-    k = 0;
-    if (buf_x != 0) k += tcols - buf_w;
-    if (buf_y != 0) k += (trows - buf_h) * tcols;
-    for (int j = 0; j < buf_h; j++)
-    {
-      for (int i = 0; i < buf_w; i++)
+void IPtTileSet::pinNeighbourhood (int k, bool on)
+{
+  int ci = k % tcols, cj = k / tcols;
+  for (int j = cj - SWEEP_RADIUS; j <= cj + SWEEP_RADIUS; j++)
+    for (int i = ci - SWEEP_RADIUS; i <= ci + SWEEP_RADIUS; i++)
+      if (i >= 0 && i < tcols && j >= 0 && j < trows)
       {
-        // std::cout << "RELIZ " << k << std::endl;
-        if (tiles[k] != NULL) tiles[k]->releasePoints ();
-        k ++;
+        if (on) cache->pin (j * tcols + i);
+        else cache->unpin (j * tcols + i);
       }
-      k += tcols - buf_w;
-    }
-    buf_x = 0;
-    buf_y = 0;
-    buf_step = 0;
-//    std::cout << "SWEEP STOP OUT -> " << buf_x << " " << buf_y << std::endl;
-    return (-1);
-  }
-
-  // std::cout << "LOADED :";
-  // for (int i = 0; i < tcols * trows; i++)
-  // if (! tiles[i]->unloaded ()) std::cout << " " << i;
-  // std::cout << std::endl;
-
-  return (buf_y * tcols + buf_x);
 }
 
 
@@ -1028,13 +789,20 @@ void IPtTileSet::saveSubTile (int imin, int jmin, int imax, int jmax) const
   std::vector<Pt3i> pts;
   std::vector<int> inds;
   inds.push_back (index);
+  int ktile = -1;
+  IPtTile *tile = NULL;
   for (int j = jmin; j < jmin + sizey; j++)
   {
     for (int i = imin; i < imin + sizex; i++)
     {
       int icell = i, jcell = j;
       int itile = icell / twidth, jtile = jcell / theight;
-      IPtTile *tile = tiles[jtile * tcols + itile];
+      if (jtile * tcols + itile != ktile)
+      {
+        if (ktile != -1) releaseTile (ktile);
+        ktile = jtile * tcols + itile;
+        tile = holdTile (ktile);
+      }
       if (tile != NULL && ! tile->unloaded ())
       {
         icell = icell - itile * tile->countOfColumns ();
@@ -1059,6 +827,8 @@ void IPtTileSet::saveSubTile (int imin, int jmin, int imax, int jmax) const
     }
   }
 
+  if (ktile != -1) releaseTile (ktile);
+
   IPtTile *ntile = new IPtTile (sizey, sizex);
   ntile->setArea (nxmin, nymin, zm, tilein->cellSize ());
   ntile->setData (pts, inds);
@@ -1069,7 +839,8 @@ void IPtTileSet::saveSubTile (int imin, int jmin, int imax, int jmax) const
 
 void IPtTileSet::labelAsTrack (int tnum, int plab)
 {
-  tiles[tnum]->labelAsTrack (plab);
+  holdTile (tnum)->labelAsTrack (plab);
+  releaseTile (tnum);
 }
 
 
@@ -1077,12 +848,13 @@ void IPtTileSet::unlabel (int i, int j, int unit)
 {
   int icell = i * unit / cdiv, jcell = j * unit / cdiv;  // cdiv = 10 avec over
   int itile = icell / twidth, jtile = jcell / theight;
-  IPtTile *tile = tiles[jtile * tcols + itile];
+  IPtTile *tile = holdTile (jtile * tcols + itile);
   if (tile != NULL && !tile->unloaded ())
     for (int uj = 0; uj < unit; uj++)
       for (int ui = 0; ui < unit; ui++)
         tile->unlabel (icell + ui - twidth * itile,
                        jcell + uj - theight * jtile);
+  releaseTile (jtile * tcols + itile);
 }
 
 
@@ -1090,18 +862,21 @@ bool IPtTileSet::isLabelled (int i, int j, int unit)
 {
   int icell = i * unit / cdiv, jcell = j * unit / cdiv;  // cdiv = 10 avec over
   int itile = icell / twidth, jtile = jcell / theight;
-  IPtTile *tile = tiles[jtile * tcols + itile];
-  if (tile == NULL || tile->unloaded ()) return false;
-  for (int uj = 0; uj < unit; uj++)
-    for (int ui = 0; ui < unit; ui++)
-      if (tile->isLabelled (icell + ui - twidth * itile,
-                            jcell + uj - theight * jtile)) return true;
-  return false;
+  IPtTile *tile = holdTile (jtile * tcols + itile);
+  bool labelled = false;
+  if (tile != NULL && ! tile->unloaded ())
+    for (int uj = 0; uj < unit && ! labelled; uj++)
+      for (int ui = 0; ui < unit && ! labelled; ui++)
+        labelled = tile->isLabelled (icell + ui - twidth * itile,
+                                     jcell + uj - theight * jtile);
+  releaseTile (jtile * tcols + itile);
+  return labelled;
 }
 
 
 int IPtTileSet::countOfLabelledPoints ()
 {
+  awaitTiles ();
   int nblp = 0;
   for (int j = 0; j < trows; j++)
     for (int i = 0; i < tcols; i++)
@@ -1113,6 +888,7 @@ int IPtTileSet::countOfLabelledPoints ()
 
 int IPtTileSet::countOfLabelledPixels (int unit)
 {
+  awaitTiles ();
   int nblp = 0;
   for (int j = 0; j < trows; j++)
     for (int i = 0; i < tcols; i++)
@@ -1138,6 +914,7 @@ int IPtTileSet::countOfLabelledPixels (int unit)
 
 void IPtTileSet::createLabels ()
 {
+  awaitTiles ();
   for (int j = 0; j < trows; j++)
     for (int i = 0; i < tcols; i++)
       if (tiles[j * tcols + i] != NULL && ! tiles[j * tcols + i]->unloaded ())
@@ -1147,6 +924,7 @@ void IPtTileSet::createLabels ()
 
 bool IPtTileSet::loadLabels (std::string dir) const
 {
+  awaitTiles ();
   bool ok = true;
   for (int j = 0; ok && j < trows; j++)
     for (int i = 0; ok && i < tcols; i++)
@@ -1158,6 +936,7 @@ bool IPtTileSet::loadLabels (std::string dir) const
 
 bool IPtTileSet::saveLabels (std::string dir) const
 {
+  awaitTiles ();
   bool ok = true;
   for (int j = 0; ok && j < trows; j++)
     for (int i = 0; ok && i < tcols; i++)
@@ -1169,6 +948,7 @@ bool IPtTileSet::saveLabels (std::string dir) const
 
 void IPtTileSet::toXYZ (bool lab)
 {
+  awaitTiles ();
   for (int j = 0; j < trows; j++)
     for (int i = 0; i < tcols; i++)
       if (tiles[j * tcols + i] != NULL)
@@ -1178,17 +958,20 @@ void IPtTileSet::toXYZ (bool lab)
 
 bool IPtTileSet::saveXYZFile (bool lab) const
 {
+  awaitTiles ();
   return (tiles[0]->saveXYZFile (lab));
 }
 
 
 bool IPtTileSet::loadXYZFile (std::string name, int sub, bool lab)
 {
+  awaitTiles ();
   return (tiles[0]->loadXYZFile (name, sub, lab));
 }
 
 
 void IPtTileSet::check ()
 {
+  awaitTiles ();
   tiles[0]->check ();
 }
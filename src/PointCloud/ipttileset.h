@@ -25,8 +25,12 @@
 #ifndef IPT_TILE_SET_H
 #define IPT_TILE_SET_H
 
+#include <mutex>
 #include "ipttile.h"
+#include "ipttilecache.h"
 #include "pt3f.h"
+#include "pt2f.h"
+#include "vr2f.h"
 #include "pt2i.h"
 
 
@@ -41,9 +45,8 @@ public:
 
   /**
    * \brief Creates a point tile set.
-   * @param Tile set buffer size value (optional).
    */
-  IPtTileSet (int buffer_size = 0);
+  IPtTileSet ();
 
   /**
    * \brief Deletes the point tile set.
@@ -71,8 +74,11 @@ public:
    * @param dir Tile file directory.
    * @param name Tile name.
    * @param access Required access type.
+   * @param complete Only loads headers if set to false (points are then
+   *   loaded on demand within the cache budget).
    */
-  bool addTile (const std::string &dir, const std::string &name, int access);
+  bool addTile (const std::string &dir, const std::string &name, int access,
+                bool complete = true);
 
   /**
    * \brief Adds an already created point tile to the tile vector.
@@ -92,6 +98,78 @@ public:
    */
   bool loadPoints ();
 
+  /**
+   * \brief Returns whether tile files are memory mapped rather than loaded.
+   */
+  inline bool memoryMapping () const { return mapped; }
+
+  /**
+   * \brief Sets the tile file memory mapping modality.
+   * Mapped tiles directly refer to their file pages without any copy.
+   * Only affects tiles loaded afterwards.
+   * @param status Memory mapping status.
+   */
+  void setMemoryMapping (bool status);
+
+  /**
+   * \brief Returns whether new tile files are saved with packed format.
+   */
+  inline bool packedFormat () const { return packed; }
+
+  /**
+   * \brief Sets the packed format modality of new tile files.
+   * Packed tiles are about three times smaller, points being decoded
+   *   when their cells are first accessed.
+   * @param status Packed format status.
+   */
+  inline void setPackedFormat (bool status) { packed = status; }
+
+  /**
+   * \brief Returns whether tiles are loaded in background during sweeps.
+   */
+  inline bool prefetching () const { return (cache->prefetching ()); }
+
+  /**
+   * \brief Sets the background tile loading modality of tile set sweeps.
+   * When set, nextTile returns as soon as the loading of next tiles is
+   *   requested, and a tile access waits for its loading completion.
+   * @param status Background loading status.
+   */
+  inline void setPrefetching (bool status) { cache->setPrefetching (status); }
+
+  /**
+   * \brief Returns the memory budget of tiles loaded on demand (in bytes).
+   */
+  inline int64_t cacheBudget () const { return (cache->budget ()); }
+
+  /**
+   * \brief Sets the memory budget of tiles loaded on demand.
+   * Tiles loaded during sweeps or when accessing an unloaded tile are kept
+   *   until the budget is exceeded, then evicted in least recently used
+   *   order unless pinned.
+   * @param bytes New memory budget (in bytes), no limit if not positive.
+   */
+  inline void setCacheBudget (int64_t bytes) {
+    std::lock_guard<std::mutex> lock (cache_lock);
+    cache->setBudget (bytes); }
+
+  /**
+   * \brief Returns the memory size of tiles loaded on demand (in bytes).
+   */
+  inline int64_t cacheFootprint () const { return (cache->footprint ()); }
+
+  /**
+   * \brief Loads a tile if needed and protects it from eviction.
+   * @param num Number of the tile in the tile set.
+   */
+  inline void pinTile (int num) { holdTile (num); }
+
+  /**
+   * \brief Releases a tile protection from eviction.
+   * @param num Number of the tile in the tile set.
+   */
+  inline void unpinTile (int num) { releaseTile (num); }
+
   /**
    * \brief Returns whether a specifc tile is effectively loaded.
    * @param num Number of the tile to check in the tile set.
@@ -101,6 +179,7 @@ public:
 
   /**
    * \brief Updates access type of the tiles.
+   * Tiles with unloaded points are replaced by tiles with only headers.
    * @param oldtype Previous access type.
    * @param newtype New access type.
    * @param prefix New file prefix.
@@ -234,7 +313,7 @@ public:
    * @param i Tile subcell column.
    * @param j Tile subcell row.
    */
-  bool collectPoints (std::vector<Pt3i> &pts, int i, int j);// const;
+  bool collectPoints (std::vector<Pt3i> &pts, int i, int j) const;
 
   /**
    * \brief Pushes the points of given tile subcell in provided vector.
@@ -245,7 +324,38 @@ public:
    * @param i Tile subcell column.
    * @param j Tile subcell row.
    */
-  bool collectPoints (std::vector<Pt3f> &pts, int i, int j);// const;
+  bool collectPoints (std::vector<Pt3f> &pts, int i, int j) const;
+
+  /**
+   * \brief Appends the points of all the subcells of a scan in provided vector.
+   *   Points are transfered in meter unit, in scan order.
+   * Returns the count of scan subcells out of loaded tiles.
+   * @param pts Provided vector of points (not cleared).
+   * @param scan Tile subcells.
+   * @param ends If not NULL, provided vector of point counts after each
+   *   scan subcell.
+   */
+  int collectScanPoints (std::vector<Pt3f> &pts, const std::vector<Pt2i> &scan,
+                         std::vector<int> *ends = NULL) const;
+
+  /**
+   * \brief Appends the cross profile of a scan in provided vector.
+   *   Each point of the scan subcells is directly projected from tile cells
+   *   on the stroke line, giving its distance (in meter) along the stroke
+   *   and its height (in meter).
+   * Returns the count of scan subcells out of loaded tiles.
+   * As other point collections, profiles can be collected from concurrent
+   *   threads: the tile in use is pinned in the cache.
+   * @param prof Provided vector of profile points (not cleared).
+   * @param scan Tile subcells.
+   * @param org Stroke origin (in meter).
+   * @param dir Stroke direction vector.
+   * @param len Stroke direction length (distances are divided by it).
+   */
+  int collectScanProfile (std::vector<Pt2f> &prof,
+                          const std::vector<Pt2i> &scan,
+                          const Pt2f &org, const Vr2f &dir,
+                          float len = 1.0f) const;
 
   /**
    * \brief Pushes points and labels of given tile subcell in provided vectors.
@@ -260,7 +370,7 @@ public:
    * @param j Tile subcell row.
    */
   bool collectPointsAndLabels (std::vector<Pt3f> &pts, std::vector<int> & tls,
-                               std::vector<int> &lbs, int i, int j);// const;
+                               std::vector<int> &lbs, int i, int j) const;
 
   /**
    * \brief Pushes the points of given tile subcell in provided vector.
@@ -284,28 +394,10 @@ public:
   int cellMinSize (int max) const;
 
   /**
-   * \brief Returns the size of local buffers.
-   */
-  int bufferSize () const;
-
-  /**
-   * \brief Sets the size of local buffers.
-   * @param val New size value (only positive odd).
-   */
-  void setBufferSize (int val);
-
-  /**
-   * \brief Deletes tile point and index buffers.
-   */
-  void deleteBuffers ();
-
-  /**
-   * \brief Creates tile point and index buffers.
-   */
-  void createBuffers ();
-
-  /**
-   * \brief Returns the next traversed tile index.
+   * \brief Returns the next traversed tile index, or -1 at sweep end.
+   * Tiles are swept by stripes, along the longest side of the tile set.
+   * The neighbourhood of the returned tile is pinned in memory till next call,
+   *   and the neighbourhood of the next tile is already requested.
    */
   int nextTile ();
 
@@ -401,8 +493,8 @@ public:
 
 private:
 
-  /** Default value for local tile set size. */
-  static const int DEFAULT_BUF_SIZE;
+  /** Radius of the pinned neighbourhood of the current tile in sweeps. */
+  static const int SWEEP_RADIUS;
 
   /** Conversion ratio from millimeters to meters. */
   static const float MM2M;
@@ -435,26 +527,97 @@ private:
   /** Tile array. */
   IPtTile **tiles;
 
-  /** Local tile set size. */
-  int buf_size;
-  /** Local tile set width. */
-  int buf_w;
-  /** Local tile set height. */
-  int buf_h;
-  /** Current tile X position (wrt loaded tile set). */
-  int buf_x;
-  /** Current tile Y position (wrt loaded tile set). */
-  int buf_y;
-  /** Maximum number of loaded points in a tile. */
-  int buf_np;
-  /** Number of loaded indices in a tile. */
-  int buf_ni;
-  /** Loaded points in local tiles. */
-  Pt3i *buf_pts;
-  /** Loaded indices in local tiles. */
-  int *buf_ind;
-  /** Current step of tile set traversal. */
-  int buf_step;
+  /** Tile file memory mapping modality. */
+  bool mapped;
+  /** Packed format modality of new tile files. */
+  bool packed;
+  /** Cache of tiles loaded on demand. */
+  IPtTileCache *cache;
+  /** Lock on cache accesses of concurrent point collections. */
+  mutable std::mutex cache_lock;
+  /** Tile sweep order. */
+  std::vector<int> sweep;
+  /** Current position in tile sweep (-1 if no sweep in progress). */
+  int sweep_pos;
+
+
+  /**
+   * \brief Prepares a tile for access (waits or loads it if required).
+   * Must be called with the cache lock held (see holdTile).
+   * @param k Index of the tile in the set.
+   */
+  inline void touch (int k) const { cache->touch (k); }
+
+  /**
+   * \brief Prepares a tile for access and pins it till its release.
+   * Cache accesses are serialized so that tiles can be collected from
+   *   concurrent threads. Returns the tile (possibly NULL).
+   * @param k Index of the tile in the set.
+   */
+  IPtTile *holdTile (int k) const;
+
+  /**
+   * \brief Releases a tile pinned by holdTile.
+   * @param k Index of the tile in the set.
+   */
+  void releaseTile (int k) const;
+
+  /**
+   * \brief Pushes the points of a subcell of a loaded tile in meter unit.
+   * @param pts Provided vector of points.
+   * @param tile Loaded tile.
+   * @param itile Tile column.
+   * @param jtile Tile row.
+   * @param i Tile set subcell column.
+   * @param j Tile set subcell row.
+   */
+  void gatherPoints (std::vector<Pt3f> &pts, const IPtTile *tile,
+                     int itile, int jtile, int i, int j) const;
+
+  /**
+   * \brief Returns the first point of a subcell of a loaded tile.
+   * @param nb Count of points of the subcell (output).
+   * @param tile Loaded tile.
+   * @param itile Tile column.
+   * @param jtile Tile row.
+   * @param i Tile set subcell column.
+   * @param j Tile set subcell row.
+   */
+  const Pt3i *subcellPoints (int &nb, const IPtTile *tile,
+                             int itile, int jtile, int i, int j) const;
+
+  /**
+   * \brief Pushes the projections of some tile points on a stroke line.
+   *   Uses SSE2 or AVX2 instructions when available.
+   * @param prof Provided vector of profile points.
+   * @param pt First tile point.
+   * @param nb Count of tile points.
+   * @param xoff Tile X position (in millimeter).
+   * @param yoff Tile Y position (in millimeter).
+   * @param org Stroke origin (in meter).
+   * @param dir Stroke direction vector.
+   * @param len Stroke direction length.
+   */
+  void projectPoints (std::vector<Pt2f> &prof, const Pt3i *pt, int nb,
+                      int xoff, int yoff, const Pt2f &org, const Vr2f &dir,
+                      float len) const;
+
+  /**
+   * \brief Waits for all tile loading requests before accessing tiles.
+   */
+  inline void awaitTiles () const { cache->awaitAll (); }
+
+  /**
+   * \brief Builds the tile sweep order.
+   */
+  void createSweep ();
+
+  /**
+   * \brief Pins or unpins the neighbourhood of a tile.
+   * @param k Index of the tile in the set.
+   * @param on Pinning status.
+   */
+  void pinNeighbourhood (int k, bool on);
 };
 
 #endif
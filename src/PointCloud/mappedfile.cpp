@@ -0,0 +1,117 @@
+/*  Copyright 2021 Philippe Even, Phuc Ngo and Pierre Even,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#if _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "mappedfile.h"
+
+
+MappedFile::MappedFile ()
+{
+  data = NULL;
+  len = 0;
+#if _WIN32
+  hfile = NULL;
+  hmap = NULL;
+#endif
+}
+
+
+MappedFile::~MappedFile ()
+{
+  close ();
+}
+
+
+bool MappedFile::open (const std::string &name)
+{
+  close ();
+#if _WIN32
+  HANDLE fh = CreateFileA (name.c_str (), GENERIC_READ, FILE_SHARE_READ,
+                           NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+  if (fh == INVALID_HANDLE_VALUE) return false;
+  LARGE_INTEGER fsize;
+  if (! GetFileSizeEx (fh, &fsize) || fsize.QuadPart == 0)
+  {
+    CloseHandle (fh);
+    return false;
+  }
+  HANDLE mh = CreateFileMappingA (fh, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+  if (mh == NULL)
+  {
+    CloseHandle (fh);
+    return false;
+  }
+  void *addr = MapViewOfFile (mh, FILE_MAP_COPY, 0, 0, 0);
+  if (addr == NULL)
+  {
+    CloseHandle (mh);
+    CloseHandle (fh);
+    return false;
+  }
+  hfile = fh;
+  hmap = mh;
+  len = (size_t) (fsize.QuadPart);
+  data = (char *) addr;
+#else
+  int fd = ::open (name.c_str (), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st;
+  if (fstat (fd, &st) != 0 || st.st_size == 0)
+  {
+    ::close (fd);
+    return false;
+  }
+  void *addr = mmap (NULL, (size_t) (st.st_size),
+                     PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close (fd);  // the mapping keeps its own reference on the file
+  if (addr == MAP_FAILED) return false;
+  len = (size_t) (st.st_size);
+  data = (char *) addr;
+#endif
+  return true;
+}
+
+
+void MappedFile::close ()
+{
+  if (data == NULL) return;
+#if _WIN32
+  UnmapViewOfFile (data);
+  CloseHandle ((HANDLE) hmap);
+  CloseHandle ((HANDLE) hfile);
+  hmap = NULL;
+  hfile = NULL;
+#else
+  munmap (data, len);
+#endif
+  data = NULL;
+  len = 0;
+}
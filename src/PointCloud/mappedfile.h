@@ -0,0 +1,103 @@
+/*  Copyright 2021 Philippe Even, Phuc Ngo and Pierre Even,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+
+/** 
+ * @class MappedFile mappedfile.h
+ * \brief Read-only memory mapping of a whole file.
+ * Mapped pages are private: writing in them never modifies the file.
+ */
+class MappedFile
+{
+public:
+
+  /**
+   * \brief Creates an empty file mapping.
+   */
+  MappedFile ();
+
+  /**
+   * \brief Deletes the file mapping (unmaps the file).
+   */
+  ~MappedFile ();
+
+  /**
+   * \brief Maps a file in memory.
+   * Returns whether mapping succeeded.
+   * @param name File name.
+   */
+  bool open (const std::string &name);
+
+  /**
+   * \brief Unmaps the mapped file.
+   */
+  void close ();
+
+  /**
+   * \brief Returns whether a file is currently mapped.
+   */
+  inline bool isOpen () const { return (data != NULL); }
+
+  /**
+   * \brief Returns the address of the first byte of the mapped file.
+   */
+  inline char *address () const { return data; }
+
+  /**
+   * \brief Returns the size of the mapped file in bytes.
+   */
+  inline size_t size () const { return len; }
+
+
+private:
+
+  /** Mapped file start address. */
+  char *data;
+  /** Mapped file size. */
+  size_t len;
+#if _WIN32
+  /** Opened file handle. */
+  void *hfile;
+  /** File mapping handle. */
+  void *hmap;
+#endif
+
+  /**
+   * \brief Forbids mapping copies.
+   */
+  MappedFile (const MappedFile &);
+
+  /**
+   * \brief Forbids mapping assignments.
+   */
+  MappedFile &operator= (const MappedFile &);
+};
+
+#endif
@@ -26,8 +26,13 @@
 #include <fstream>
 #include <inttypes.h>
 #include <cmath>
+#if defined (__SSE2__) || defined (_M_X64)
+#include <immintrin.h>
+#endif
 #include "asmath.h"
 #include "terrainmap.h"
+#include "ascreader.h"
+#include "workerpool.h"
 
 const int TerrainMap::SHADE_HILL = 0;
 const int TerrainMap::SHADE_SLOPE = 1;
@@ -41,11 +46,18 @@ const std::string TerrainMap::NVM_SUFFIX = std::string (".nvm");
 
 const float TerrainMap::MM2M = 0.001f;
 const double TerrainMap::EPS = 0.001;
+const int TerrainMap::PACKED_TAG = -2;
+const float TerrainMap::OCT_MAX = 65535.0f;
+const int TerrainMap::SHADE_BAND = 32;
+const double TerrainMap::SLOPE_UNIT = 4294967296.;
 
 
 TerrainMap::TerrainMap ()
 {
   nmap = NULL;
+  packed = false;
+  slope_sat = NULL;
+  sat_fact = 0;
   arr_files = NULL;
   iwidth = 0;
   iheight = 0;
@@ -85,6 +97,7 @@ void TerrainMap::clear ()
     delete [] arr_files;
   }
   arr_files = NULL;
+  clearDerivedMaps ();
   if (nmap != NULL) delete [] nmap;
   nmap = NULL;
   input_layout.clear ();
@@ -99,24 +112,25 @@ int TerrainMap::get (int i, int j) const
 { 
   if (shading == SHADE_HILL)
   {
-    float val1 = light_v1.scalar (nmap[j * iwidth + i]);
+    Pt3f nv = decode (nmap + 2 * (j * iwidth + i));
+    float val1 = light_v1.scalar (nv);
     if (val1 < 0.0f) val1 = 0.;
-    float val2 = light_v2.scalar (nmap[j * iwidth + i]);
+    float val2 = light_v2.scalar (nv);
     if (val2 < 0.0f) val2 = 0.;
-    float val3 = light_v3.scalar (nmap[j * iwidth + i]);
+    float val3 = light_v3.scalar (nv);
     if (val3 < 0.0f) val3 = 0.;
     float val = val1 + (val2 + val3) / 2;
     return (int) (val * 100);
   }
   else if (shading == SHADE_SLOPE)
   {
-    Pt3f *pt = nmap + j * iwidth + i;
-    return (255 - (int) (sqrt (pt->x() * pt->x() + pt->y() * pt->y()) * 255));
+    Pt3f nv = decode (nmap + 2 * (j * iwidth + i));
+    return (255 - (int) (sqrt (nv.x() * nv.x() + nv.y() * nv.y()) * 255));
   }
   else if (shading == SHADE_EXP_SLOPE)
   {
-    Pt3f *pt = nmap + j * iwidth + i;
-    double alph = 1. - pt->x () * pt->x () - pt->y () * pt->y ();
+    Pt3f nv = decode (nmap + 2 * (j * iwidth + i));
+    double alph = 1. - nv.x () * nv.x () - nv.y () * nv.y ();
     for (int sl = slopiness; sl > 1; sl --) alph *= alph;
     return ((int) (alph * 255));
   }
@@ -128,24 +142,25 @@ int TerrainMap::get (int i, int j, int shading_type) const
 {
   if (shading_type == SHADE_HILL)
   {
-    float val1 = light_v1.scalar (nmap[j * iwidth + i]);
+    Pt3f nv = decode (nmap + 2 * (j * iwidth + i));
+    float val1 = light_v1.scalar (nv);
     if (val1 < 0.0f) val1 = 0.;
-    float val2 = light_v2.scalar (nmap[j * iwidth + i]);
+    float val2 = light_v2.scalar (nv);
     if (val2 < 0.0f) val2 = 0.;
-    float val3 = light_v3.scalar (nmap[j * iwidth + i]);
+    float val3 = light_v3.scalar (nv);
     if (val3 < 0.0f) val3 = 0.;
     float val = val1 + (val2 + val3) / 2;
     return (int) (val * 100);
   }
   else if (shading_type == SHADE_SLOPE)
   {
-    Pt3f *pt = nmap + j * iwidth + i;
-    return (255 - (int) (sqrt (pt->x() * pt->x() + pt->y() * pt->y()) * 255));
+    Pt3f nv = decode (nmap + 2 * (j * iwidth + i));
+    return (255 - (int) (sqrt (nv.x() * nv.x() + nv.y() * nv.y()) * 255));
   }
   else if (shading_type == SHADE_EXP_SLOPE)
   {
-    Pt3f *pt = nmap + j * iwidth + i;
-    double alph = 1. - pt->x () * pt->x () - pt->y () * pt->y ();
+    Pt3f nv = decode (nmap + 2 * (j * iwidth + i));
+    double alph = 1. - nv.x () * nv.x () - nv.y () * nv.y ();
     if (alph < 0.) alph = 0.;  // saturation
     for (int sl = slopiness; sl > 1; sl --) alph *= alph;
     return ((int) (alph * 255));
@@ -154,10 +169,108 @@ int TerrainMap::get (int i, int j, int shading_type) const
 }
 
 
+void TerrainMap::shade (unsigned char *map, int imin, int jmin,
+                        int w, int h, int level) const
+{
+  const uint16_t *lmap = (level == 0 ? nmap : pyramid[level - 1]);
+  int lw = levelWidth (level);
+  int nbands = (h + SHADE_BAND - 1) / SHADE_BAND;
+  WorkerPool::common ().run (nbands, [&] (int b) {
+    float *buf = new float[3 * w];
+    int jmax = (b + 1) * SHADE_BAND;
+    if (jmax > h) jmax = h;
+    for (int j = b * SHADE_BAND; j < jmax; j ++)
+      shadeRow (map + j * w, lmap + 2 * ((jmin + j) * lw + imin), w, buf);
+    delete [] buf;
+  });
+}
+
+
+void TerrainMap::buildPyramid (int level)
+{
+  while ((int) (pyramid.size ()) < level)
+  {
+    int l = (int) (pyramid.size ()) + 1;
+    const uint16_t *fmap = (l == 1 ? nmap : pyramid[l - 2]);
+    int fw = levelWidth (l - 1), fh = levelHeight (l - 1);
+    int lw = levelWidth (l), lh = levelHeight (l);
+    uint16_t *lmap = new uint16_t[2 * lw * lh];
+    int nbands = (lh + SHADE_BAND - 1) / SHADE_BAND;
+    WorkerPool::common ().run (nbands, [&] (int b) {
+      int jmax = (b + 1) * SHADE_BAND;
+      if (jmax > lh) jmax = lh;
+      for (int j = b * SHADE_BAND; j < jmax; j ++)
+        for (int i = 0; i < lw; i ++)
+        {
+          // Sum of the available (up to four) finer normal vectors
+          float x = 0.0f, y = 0.0f, z = 0.0f;
+          for (int fj = 2 * j; fj < 2 * j + 2 && fj < fh; fj ++)
+            for (int fi = 2 * i; fi < 2 * i + 2 && fi < fw; fi ++)
+            {
+              Pt3f nv = decode (fmap + 2 * (fj * fw + fi));
+              x += nv.x ();
+              y += nv.y ();
+              z += nv.z ();
+            }
+          encode (lmap + 2 * (j * lw + i), x, y, z);
+        }
+    });
+    pyramid.push_back (lmap);
+  }
+}
+
+
+void TerrainMap::shadeRow (unsigned char *out, const uint16_t *codes, int w,
+                           float *buf) const
+{
+  // Same expressions as get (i, j) on decoded vectors
+  float *nx = buf, *ny = buf + w, *nz = buf + 2 * w;
+  decodeRow (codes, w, nx, ny, nz);
+  if (shading == SHADE_HILL)
+  {
+    for (int i = 0; i < w; i ++)
+    {
+      float val1 = nx[i] * light_v1.x () + ny[i] * light_v1.y ()
+                   + nz[i] * light_v1.z ();
+      if (val1 < 0.0f) val1 = 0.;
+      float val2 = nx[i] * light_v2.x () + ny[i] * light_v2.y ()
+                   + nz[i] * light_v2.z ();
+      if (val2 < 0.0f) val2 = 0.;
+      float val3 = nx[i] * light_v3.x () + ny[i] * light_v3.y ()
+                   + nz[i] * light_v3.z ();
+      if (val3 < 0.0f) val3 = 0.;
+      float val = val1 + (val2 + val3) / 2;
+      out[i] = (unsigned char) ((int) (val * 100));
+    }
+  }
+  else if (shading == SHADE_SLOPE)
+  {
+    for (int i = 0; i < w; i ++)
+      out[i] = (unsigned char) (255 - (int) (sqrt (nx[i] * nx[i]
+                                                   + ny[i] * ny[i]) * 255));
+  }
+  else if (shading == SHADE_EXP_SLOPE)
+  {
+    double *alph = new double[w];
+    for (int i = 0; i < w; i ++)
+    {
+      alph[i] = 1. - nx[i] * nx[i] - ny[i] * ny[i];
+      if (alph[i] < 0.) alph[i] = 0.;  // saturation
+    }
+    for (int sl = slopiness; sl > 1; sl --)
+      for (int i = 0; i < w; i ++) alph[i] *= alph[i];
+    for (int i = 0; i < w; i ++)
+      out[i] = (unsigned char) ((int) (alph[i] * 255));
+    delete [] alph;
+  }
+  else for (int i = 0; i < w; i ++) out[i] = 0;
+}
+
+
 double TerrainMap::getSlopeFactor (int i, int j, int slp) const
 {
-  Pt3f *pt = nmap + j * iwidth + i;
-  double alph = 1. - pt->x () * pt->x () - pt->y () * pt->y ();
+  Pt3f nv = decode (nmap + 2 * (j * iwidth + i));
+  double alph = 1. - nv.x () * nv.x () - nv.y () * nv.y ();
   if (alph < 0.) alph = 0.;  // saturation
   for (int sl = slp; sl > 1; sl --) alph *= alph;
   return (alph);
@@ -235,47 +348,97 @@ Pt2i TerrainMap::closestFlatArea (const Pt2i &pt, int srad, int frad, int sfact)
   if (fxmax > iwidth) fxmax = iwidth;
   if (fymax > iheight) fymax = iheight;
 
-  int sw = sxmax - sxmin, sh = symax - symin, swh = sw * sh;
-  double *val = new double[swh];
-  int *cpt = new int[swh];
-  for (int i = 0; i < swh; i++)
+  // Integral image of the whole map if available, else of the search area
+  const int64_t *sat = slope_sat;
+  int64_t *lsat = NULL;
+  int satw = iwidth + 1, xoff = 0, yoff = 0;
+  if (slope_sat == NULL || sat_fact != sfact)
   {
-    val[i] = 0.;
-    cpt[i] = 0;
+    satw = fxmax - fxmin + 1;
+    lsat = new int64_t[satw * (fymax - fymin + 1)];
+    integrateSlopes (lsat, fxmin, fymin, satw - 1, fymax - fymin, sfact);
+    sat = lsat;
+    xoff = fxmin;
+    yoff = fymin;
   }
 
-  for (int fi = fxmin; fi < fxmax; fi ++)
+  int cmax = 0, sw = sxmax - sxmin, swh = sw * (symax - symin);
+  double vmax = 0.;
+  for (int i = 0; i < swh; i ++)
   {
-    int lxmin = fi - frad - sxmin;
-    int lxmax = fi + frad + 1 - sxmin;
-    if (lxmin < 0) lxmin = 0;
-    if (lxmax > sw) lxmax = sw;
-    for (int fj = fymin; fj < fymax; fj ++)
+    int x = sxmin + i % sw, y = symin + i / sw;
+    int x0 = x - frad, x1 = x + frad + 1, y0 = y - frad, y1 = y + frad + 1;
+    if (x0 < fxmin) x0 = fxmin;
+    if (y0 < fymin) y0 = fymin;
+    if (x1 > fxmax) x1 = fxmax;
+    if (y1 > fymax) y1 = fymax;
+    x0 -= xoff;
+    x1 -= xoff;
+    y0 -= yoff;
+    y1 -= yoff;
+    double val = (double) (sat[y1 * satw + x1] - sat[y1 * satw + x0]
+                           - sat[y0 * satw + x1] + sat[y0 * satw + x0])
+                 / ((x1 - x0) * (y1 - y0));
+    if (i == 0 || val > vmax)
     {
-      double dval = getSlopeFactor (fi, iheight - 1 - fj, sfact);
-      int lymin = fj - frad - symin;
-      int lymax = fj + frad + 1 - symin;
-      if (lymin < 0) lymin = 0;
-      if (lymax > sh) lymax = sh;
-      for (int lj = lymin; lj < lymax; lj ++)
-        for (int li = lxmin; li < lxmax; li ++)
-        {
-          val[lj * sw + li] += dval;
-          cpt[lj * sw + li] ++;
-        }
+      cmax = i;
+      vmax = val;
     }
   }
+  if (lsat != NULL) delete [] lsat;
+  return (Pt2i (sxmin + cmax % sw, symin + cmax / sw));
+}
+
+
+void TerrainMap::buildSlopeIntegral (int sfact)
+{
+  if (sat_fact == sfact) return;
+  if (slope_sat == NULL) slope_sat = new int64_t[(iwidth + 1) * (iheight + 1)];
+  integrateSlopes (slope_sat, 0, 0, iwidth, iheight, sfact);
+  sat_fact = sfact;
+}
+
 
-  int cmax = 0;
-  val[0] /= cpt[0];
-  for (int i = 1; i < swh; i ++)
+double TerrainMap::flatness (const Pt2i &pt, int frad) const
+{
+  int x0 = pt.x () - frad, x1 = pt.x () + frad + 1;
+  int y0 = pt.y () - frad, y1 = pt.y () + frad + 1;
+  if (x0 < 0) x0 = 0;
+  if (y0 < 0) y0 = 0;
+  if (x1 > iwidth) x1 = iwidth;
+  if (y1 > iheight) y1 = iheight;
+  if (slope_sat == NULL || x1 <= x0 || y1 <= y0) return 0.;
+  int satw = iwidth + 1;
+  int64_t val = slope_sat[y1 * satw + x1] - slope_sat[y1 * satw + x0]
+                - slope_sat[y0 * satw + x1] + slope_sat[y0 * satw + x0];
+  return (val / (SLOPE_UNIT * (x1 - x0) * (y1 - y0)));
+}
+
+
+void TerrainMap::integrateSlopes (int64_t *sat, int xmin, int ymin,
+                                  int w, int h, int sfact) const
+{
+  float *buf = new float[3 * w];
+  for (int i = 0; i <= w; i ++) sat[i] = 0;
+  for (int j = 0; j < h; j ++)
   {
-    val[i] /= cpt[i];
-    if (val[i] > val[cmax]) cmax = i;
+    // Same slope factor as getSlopeFactor, integrated in fixed-point
+    float *nx = buf, *ny = buf + w, *nz = buf + 2 * w;
+    decodeRow (nmap + 2 * ((iheight - 1 - ymin - j) * iwidth + xmin), w,
+               nx, ny, nz);
+    int64_t *prev = sat + j * (w + 1), *cur = prev + w + 1;
+    int64_t rsum = 0;
+    cur[0] = 0;
+    for (int i = 0; i < w; i ++)
+    {
+      double alph = 1. - nx[i] * nx[i] - ny[i] * ny[i];
+      if (alph < 0.) alph = 0.;  // saturation
+      for (int sl = sfact; sl > 1; sl --) alph *= alph;
+      rsum += (int64_t) (alph * SLOPE_UNIT + 0.5);
+      cur[i + 1] = prev[i + 1] + rsum;
+    }
   }
-  delete [] val;
-  delete [] cpt;
-  return (Pt2i (sxmin + cmax % sw, symin + cmax / sw));
+  delete [] buf;
 }
 
 
@@ -308,6 +471,7 @@ bool TerrainMap::assembleMap (int cols, int rows, int64_t xmin, int64_t ymin,
     arr_files = new std::string *[cols * rows];
     for (int i = 0; i < cols * rows; i++) arr_files[i] = NULL;
   }
+  Pt3f *buf = NULL;
   std::vector<std::string>::iterator it = input_fullnames.begin ();
   while (it != input_fullnames.end ())
   {
@@ -316,11 +480,7 @@ bool TerrainMap::assembleMap (int cols, int rows, int64_t xmin, int64_t ymin,
       std::cout << "File " << *it << " can't be opened" << std::endl;
     else
     {
-      nvmf.read ((char *) (&locw), sizeof (int));
-      nvmf.read ((char *) (&loch), sizeof (int));
-      nvmf.read ((char *) (&locs), sizeof (float));
-      nvmf.read ((char *) (&locxmin), sizeof (float));
-      nvmf.read ((char *) (&locymin), sizeof (float));
+      bool pk = readHeader (nvmf, locw, loch, locs, locxmin, locymin);
       if (twidth != 0)
       {
         bool ok = true;
@@ -359,6 +519,7 @@ bool TerrainMap::assembleMap (int cols, int rows, int64_t xmin, int64_t ymin,
         if (! ok)
         {
           nvmf.close ();
+          if (buf != NULL) delete [] buf;
           return false;
         }
       }
@@ -371,8 +532,10 @@ bool TerrainMap::assembleMap (int cols, int rows, int64_t xmin, int64_t ymin,
         iheight = rows * theight;
         if (! padding)
         {
+          clearDerivedMaps ();
           if (nmap != NULL) delete [] nmap;
-          nmap = new Pt3f[iwidth * iheight];
+          nmap = new uint16_t[2 * iwidth * iheight];
+          buf = new Pt3f[twidth];
         }
       }
       wmap = twidth * cell_size;
@@ -382,19 +545,20 @@ bool TerrainMap::assembleMap (int cols, int rows, int64_t xmin, int64_t ymin,
       if (padding) arr_files[locj * cols + loci] = &(*it);
       else
       {
-        Pt3f *line = nmap + iwidth * (iheight - 1);
-        line -= locj * theight * iwidth;
-        line += loci * twidth;
+        uint16_t *line = nmap + 2 * iwidth * (iheight - 1);
+        line -= 2 * locj * theight * iwidth;
+        line += 2 * loci * twidth;
         for (int j = 0; j < theight; j++)
         {
-          nvmf.read ((char *) line, twidth * sizeof (Pt3f));
-          line -= iwidth;
+          readRow (nvmf, line, twidth, pk, buf);
+          line -= 2 * iwidth;
         }
       }
       nvmf.close ();
     }
     it ++;
   }
+  if (buf != NULL) delete [] buf;
   return true;
 }
 
@@ -408,11 +572,7 @@ bool TerrainMap::loadNormalMapInfo (const std::string &name)
     return false;
   }
   float x, y;
-  nvmf.read ((char *) (&twidth), sizeof (int));
-  nvmf.read ((char *) (&theight), sizeof (int));
-  nvmf.read ((char *) (&cell_size), sizeof (float));
-  nvmf.read ((char *) (&x), sizeof (float));
-  nvmf.read ((char *) (&y), sizeof (float));
+  readHeader (nvmf, twidth, theight, cell_size, x, y);
   nvmf.close ();
   x_min = (double) (x + 0.5f);
   y_min = (double) (y + 0.5f);
@@ -446,7 +606,7 @@ int TerrainMap::nextPad (unsigned char *map)
   {
     pad_ref = 0;
     if (nmap != NULL) delete [] nmap;
-    nmap = new Pt3f[twidth];
+    nmap = new uint16_t[2 * twidth];
     for (int j = 0; j < pad_h; j ++)
       for (int i = 0; i < pad_w; i ++)
         loadMap (j * ts_cot + i,
@@ -617,11 +777,7 @@ bool TerrainMap::loadMap (int k, unsigned char *submap)
                         std::ios::in | std::ifstream::binary);
     if (! nvmf.is_open ())
       std::cout << "File " << *arr_files[k] << " can't be opened" << std::endl;
-    nvmf.read ((char *) (&locw), sizeof (int));
-    nvmf.read ((char *) (&loch), sizeof (int));
-    nvmf.read ((char *) (&locs), sizeof (float));
-    nvmf.read ((char *) (&locxmin), sizeof (float));
-    nvmf.read ((char *) (&locymin), sizeof (float));
+    bool pk = readHeader (nvmf, locw, loch, locs, locxmin, locymin);
     if (locw != twidth)
     {
       std::cout << "File " << *arr_files[k] << " inconsistent width"
@@ -644,15 +800,17 @@ bool TerrainMap::loadMap (int k, unsigned char *submap)
       return false;
     }
 
+    Pt3f *buf = (pk ? NULL : new Pt3f[twidth]);
     unsigned char *pmap = submap;
     for (int j = 0; j < theight; j++)
     {
-      nvmf.read ((char *) nmap, twidth * sizeof (Pt3f));
+      readRow (nvmf, nmap, twidth, pk, buf);
       //traite la ligne nmap pour construire submap
       for (int i = 0; i < twidth; i ++)
       {
-        int val = 255 - (int) (sqrt (nmap[i].x () * nmap[i].x ()
-                                     + nmap[i].y () * nmap[i].y ()) * 255);
+        Pt3f nv = decode (nmap + 2 * i);
+        int val = 255 - (int) (sqrt (nv.x () * nv.x ()
+                                     + nv.y () * nv.y ()) * 255);
         if (val < 0) val = 0;
         if (val > 255) val = 255;
         *pmap++ = val;
@@ -660,6 +818,7 @@ bool TerrainMap::loadMap (int k, unsigned char *submap)
       pmap -= (pad_w + 1) * twidth;
     }
     nvmf.close ();
+    if (buf != NULL) delete [] buf;
   }
   else
   {
@@ -691,23 +850,20 @@ void TerrainMap::saveFirstNormalMap (const std::string &name) const
     std::cout << "File " << name << " can't be created" << std::endl;
   else
   {
-    nvmf.write ((char *) (&twidth), sizeof (int));
-    nvmf.write ((char *) (&theight), sizeof (int));
-    nvmf.write ((char *) (&cell_size), sizeof (float));
-    float fxm = (float) input_xmins.front ();
-    nvmf.write ((char *) (&fxm), sizeof (float));
-    float fym = (float) input_ymins.front ();
-    nvmf.write ((char *) (&fym), sizeof (float));
+    writeHeader (nvmf, twidth, theight, (float) input_xmins.front (),
+                 (float) input_ymins.front ());
     Pt2i txy = input_layout.front ();
-    Pt3f *line = nmap + iwidth * (iheight - 1);
-    line -= txy.y () * theight * iwidth;
-    line += txy.x () * twidth;
+    Pt3f *buf = (packed ? NULL : new Pt3f[twidth]);
+    uint16_t *line = nmap + 2 * iwidth * (iheight - 1);
+    line -= 2 * txy.y () * theight * iwidth;
+    line += 2 * txy.x () * twidth;
     for (int j = 0; j < theight; j++)
     {
-      nvmf.write ((char *) line, twidth * sizeof (Pt3f));
-      line -= iwidth;
+      writeRow (nvmf, line, twidth, buf);
+      line -= 2 * iwidth;
     }
     nvmf.close ();
+    if (buf != NULL) delete [] buf;
   }
 }
 
@@ -717,6 +873,7 @@ void TerrainMap::saveLoadedNormalMaps (const std::string &dir) const
   std::vector<double>::const_iterator xit = input_xmins.begin ();
   std::vector<double>::const_iterator yit = input_ymins.begin ();
   std::vector<Pt2i>::const_iterator lit = input_layout.begin ();
+  Pt3f *buf = (packed ? NULL : new Pt3f[twidth]);
   while (it != input_nicknames.end ())
   {
     std::string name (dir);
@@ -726,21 +883,15 @@ void TerrainMap::saveLoadedNormalMaps (const std::string &dir) const
       std::cout << "File " << name << " can't be created" << std::endl;
     else
     {
-      nvmf.write ((char *) (&twidth), sizeof (int));
-      nvmf.write ((char *) (&theight), sizeof (int));
-      nvmf.write ((char *) (&cell_size), sizeof (float));
-      float fxm = (float) (*xit);
-      nvmf.write ((char *) (&fxm), sizeof (float));
-      float fym = (float) (*yit);
-      nvmf.write ((char *) (&fym), sizeof (float));
+      writeHeader (nvmf, twidth, theight, (float) (*xit), (float) (*yit));
       Pt2i txy (*lit);
-      Pt3f *line = nmap + iwidth * (iheight - 1);
-      line -= txy.y () * theight * iwidth;
-      line += txy.x () * twidth;
+      uint16_t *line = nmap + 2 * iwidth * (iheight - 1);
+      line -= 2 * txy.y () * theight * iwidth;
+      line += 2 * txy.x () * twidth;
       for (int j = 0; j < theight; j++)
       {
-        nvmf.write ((char *) line, twidth * sizeof (Pt3f));
-        line -= iwidth;
+        writeRow (nvmf, line, twidth, buf);
+        line -= 2 * iwidth;
       }
       nvmf.close ();
     }
@@ -749,6 +900,7 @@ void TerrainMap::saveLoadedNormalMaps (const std::string &dir) const
     yit ++;
     lit ++;
   }
+  if (buf != NULL) delete [] buf;
 }
 
 
@@ -899,9 +1051,10 @@ bool TerrainMap::createMapFromDtm (bool verb, bool grid_ref)
     itn ++;
   }
 
+  clearDerivedMaps ();
   if (nmap != NULL) delete [] nmap;
-  nmap = new Pt3f[iwidth * iheight];
-  Pt3f *nval = nmap;
+  nmap = new uint16_t[2 * iwidth * iheight];
+  uint16_t *nval = nmap;
   double dhx, dhy;
   if (grid_ref)
   {
@@ -913,9 +1066,8 @@ bool TerrainMap::createMapFromDtm (bool verb, bool grid_ref)
                    * 2 * RELIEF_AMPLI;
         dhx = (hval[j * iwidth + i + 1] - hval[j * iwidth + i])
                    * 2 * RELIEF_AMPLI;
-        nval->set (- (float) dhx, - (float) dhy, 1.0f);
-        nval->normalize ();
-        nval++;
+        encode (nval, - (float) dhx, - (float) dhy, 1.0f);
+        nval += 2;
       }
     }
   }
@@ -942,9 +1094,8 @@ bool TerrainMap::createMapFromDtm (bool verb, bool grid_ref)
         else dhx = (hval[j * iwidth + i+1] - hval[j * iwidth + i-1])
                    * RELIEF_AMPLI;
 
-        nval->set (- (float) dhx, - (float) dhy, 1.0f);
-        nval->normalize ();
-        nval++;
+        encode (nval, - (float) dhx, - (float) dhy, 1.0f);
+        nval += 2;
       }
     }
   }
@@ -953,6 +1104,270 @@ bool TerrainMap::createMapFromDtm (bool verb, bool grid_ref)
 }
 
 
+bool TerrainMap::saveNormalMapsFromDtm (const std::vector<std::string> &names,
+                                        bool verb, bool grid_ref)
+{
+  if (twidth < 3 || theight < 3)
+  {
+    std::cout << "DTM tiles too small for conversion" << std::endl;
+    return false;
+  }
+  int nb = (int) (input_fullnames.size ());
+  int cols = iwidth / twidth;
+  std::vector<int> grid (cols * (iheight / theight), -1);
+  for (int k = 0; k < nb; k ++)
+    grid[input_layout[k].y () * cols + input_layout[k].x ()] = k;
+  std::vector<std::string> outnames (names);
+  outnames.resize (nb);
+
+  // Tiles parsing, with inner normal vectors writing
+  std::vector<double *> edges (nb, NULL);
+  std::vector<char> done (nb, 0);
+  WorkerPool::common ().run (nb, [&] (int k) {
+    if (grid_ref) done[k] = (outnames[k] == ""
+                             || streamGridDtmTile (k, outnames[k]));
+    else
+    {
+      edges[k] = new double[4 * (twidth + theight)];
+      done[k] = streamDtmTile (k, outnames[k], edges[k]);
+    }
+  });
+  bool ok = true;
+  for (int k = 0; k < nb; k ++)
+    if (! done[k])
+    {
+      std::cout << "File " << input_fullnames[k] << " conversion failed"
+                << std::endl;
+      ok = false;
+    }
+
+  // Tile borders writing from neighbour tile edges
+  if (ok && ! grid_ref)
+  {
+    WorkerPool::common ().run (nb, [&] (int k) {
+      done[k] = (outnames[k] == ""
+                 || patchDtmTile (k, outnames[k], edges, grid)); });
+    for (int k = 0; k < nb; k ++)
+      if (! done[k])
+      {
+        std::cout << "File " << outnames[k] << " can't be completed"
+                  << std::endl;
+        ok = false;
+      }
+  }
+  for (int k = 0; k < nb; k ++) if (edges[k] != NULL) delete [] edges[k];
+  if (ok && verb)
+    for (int k = 0; k < nb; k ++)
+      if (outnames[k] != "")
+        std::cout << "Created " << outnames[k] << std::endl;
+  return ok;
+}
+
+
+double TerrainMap::heightSlope (double prev, double cur, double next,
+                                bool first, bool last) const
+{
+  // Same differences as in createMapFromDtm
+  if (last) return ((cur - prev) * 2 * RELIEF_AMPLI);
+  else if (first) return ((next - cur) * 2 * RELIEF_AMPLI);
+  else return ((next - prev) * RELIEF_AMPLI);
+}
+
+
+bool TerrainMap::streamDtmTile (int k, const std::string &name,
+                                double *edges) const
+{
+  AscReader ascf;
+  if (! ascf.open (input_fullnames[k])) return false;
+  std::ofstream nvmf;
+  if (name != "")
+  {
+    nvmf.open (name.c_str (), std::ios::out | std::ofstream::binary);
+    if (! nvmf.is_open ()) return false;
+    writeHeader (nvmf, twidth, theight, (float) input_xmins[k],
+                 (float) input_ymins[k]);
+  }
+  std::streamoff hsize = (packed ? 6 : 5) * (std::streamoff) sizeof (int);
+  std::streamoff rsize = (packed ? 2 * sizeof (uint16_t) : sizeof (Pt3f))
+                         * (std::streamoff) twidth;
+  double *rows = new double[3 * twidth];
+  uint16_t *codes = new uint16_t[2 * twidth];
+  Pt3f *buf = (packed ? NULL : new Pt3f[twidth]);
+  double *cols = edges + 4 * twidth;
+  double nodata = 0.;
+  bool ok = ascf.skip (11) && ascf.read (&nodata, 1);
+  for (int j = 0; ok && j < theight; j ++)
+  {
+    double *cur = rows + (j % 3) * twidth;
+    ok = ascf.read (cur, twidth);
+    for (int i = 0; i < twidth; i ++) if (cur[i] == nodata) cur[i] = no_data;
+    if (j < 2)
+      for (int i = 0; i < twidth; i ++) edges[j * twidth + i] = cur[i];
+    if (j >= theight - 2)
+      for (int i = 0; i < twidth; i ++)
+        edges[(j + 4 - theight) * twidth + i] = cur[i];
+    cols[j] = cur[0];
+    cols[theight + j] = cur[1];
+    cols[2 * theight + j] = cur[twidth - 2];
+    cols[3 * theight + j] = cur[twidth - 1];
+
+    // Inner normal vectors of former row (borders set later)
+    if (j >= 2 && name != "")
+    {
+      const double *north = rows + ((j - 2) % 3) * twidth;
+      const double *mid = rows + ((j - 1) % 3) * twidth;
+      encode (codes, 0.0f, 0.0f, 1.0f);
+      encode (codes + 2 * (twidth - 1), 0.0f, 0.0f, 1.0f);
+      for (int i = 1; i < twidth - 1; i ++)
+      {
+        double dhx = heightSlope (mid[i-1], mid[i], mid[i+1], false, false);
+        double dhy = heightSlope (north[i], mid[i], cur[i], false, false);
+        encode (codes + 2 * i, - (float) dhx, - (float) dhy, 1.0f);
+      }
+      nvmf.seekp (hsize + (theight - j) * rsize);
+      writeRow (nvmf, codes, twidth, buf);
+    }
+  }
+  if (ok && name != "")
+  {
+    // First and last rows set later
+    for (int i = 0; i < twidth; i ++) encode (codes + 2 * i, 0.0f, 0.0f, 1.0f);
+    nvmf.seekp (hsize);
+    writeRow (nvmf, codes, twidth, buf);
+    nvmf.seekp (hsize + (theight - 1) * rsize);
+    writeRow (nvmf, codes, twidth, buf);
+    ok = nvmf.good ();
+  }
+  if (name != "") nvmf.close ();
+  ascf.close ();
+  delete [] rows;
+  delete [] codes;
+  if (buf != NULL) delete [] buf;
+  return ok;
+}
+
+
+bool TerrainMap::streamGridDtmTile (int k, const std::string &name) const
+{
+  AscReader ascf;
+  if (! ascf.open (input_fullnames[k])) return false;
+  std::ofstream nvmf (name.c_str (), std::ios::out | std::ofstream::binary);
+  if (! nvmf.is_open ()) return false;
+  writeHeader (nvmf, twidth, theight, (float) input_xmins[k],
+               (float) input_ymins[k]);
+  std::streamoff hsize = (packed ? 6 : 5) * (std::streamoff) sizeof (int);
+  std::streamoff rsize = (packed ? 2 * sizeof (uint16_t) : sizeof (Pt3f))
+                         * (std::streamoff) twidth;
+  int lw = twidth + 1;
+  double *rows = new double[2 * lw];
+  uint16_t *codes = new uint16_t[2 * twidth];
+  Pt3f *buf = (packed ? NULL : new Pt3f[twidth]);
+  double nodata = 0.;
+  bool ok = ascf.skip (11) && ascf.read (&nodata, 1);
+  for (int j = 0; ok && j <= theight; j ++)
+  {
+    double *cur = rows + (j % 2) * lw;
+    ok = ascf.read (cur, lw);
+    for (int i = 0; i < lw; i ++) if (cur[i] == nodata) cur[i] = no_data;
+    if (j != 0)
+    {
+      // Forward differences from former row
+      const double *prev = rows + ((j - 1) % 2) * lw;
+      for (int i = 0; i < twidth; i ++)
+        encode (codes + 2 * i, - (float) ((prev[i+1] - prev[i])
+                                          * 2 * RELIEF_AMPLI),
+                - (float) ((cur[i] - prev[i]) * 2 * RELIEF_AMPLI), 1.0f);
+      nvmf.seekp (hsize + (theight - j) * rsize);
+      writeRow (nvmf, codes, twidth, buf);
+    }
+  }
+  ok = ok && nvmf.good ();
+  nvmf.close ();
+  ascf.close ();
+  delete [] rows;
+  delete [] codes;
+  if (buf != NULL) delete [] buf;
+  return ok;
+}
+
+
+bool TerrainMap::patchDtmTile (int k, const std::string &name,
+                               const std::vector<double *> &edges,
+                               const std::vector<int> &grid) const
+{
+  std::ofstream nvmf (name.c_str (),
+                      std::ios::in | std::ios::out | std::ofstream::binary);
+  if (! nvmf.is_open ()) return false;
+  std::streamoff hsize = (packed ? 6 : 5) * (std::streamoff) sizeof (int);
+  std::streamoff psize = (packed ? 2 * sizeof (uint16_t) : sizeof (Pt3f));
+  std::streamoff rsize = psize * twidth;
+  int cols = iwidth / twidth, rows = iheight / theight;
+  int tx = input_layout[k].x (), ty = input_layout[k].y ();
+
+  // Own edges, then neighbour edges (no data heights if no neighbour tile)
+  const double *top0 = edges[k], *top1 = top0 + twidth;
+  const double *bot1 = top1 + twidth, *bot0 = bot1 + twidth;
+  const double *left0 = bot0 + twidth, *left1 = left0 + theight;
+  const double *right1 = left1 + theight, *right0 = right1 + theight;
+  int sz = (twidth > theight ? twidth : theight);
+  double *none = new double[sz];
+  for (int i = 0; i < sz; i ++) none[i] = no_data;
+  bool nout = (ty + 1 == rows), sout = (ty == 0);
+  bool wout = (tx == 0), eout = (tx + 1 == cols);
+  int nk = (nout ? -1 : grid[(ty + 1) * cols + tx]);
+  int sk = (sout ? -1 : grid[(ty - 1) * cols + tx]);
+  int wk = (wout ? -1 : grid[ty * cols + tx - 1]);
+  int ek = (eout ? -1 : grid[ty * cols + tx + 1]);
+  const double *nrow = (nk == -1 ? none : edges[nk] + 3 * twidth);
+  const double *srow = (sk == -1 ? none : edges[sk]);
+  const double *wcol = (wk == -1 ? none
+                                 : edges[wk] + 4 * twidth + 3 * theight);
+  const double *ecol = (ek == -1 ? none : edges[ek] + 4 * twidth);
+
+  uint16_t *codes = new uint16_t[2 * twidth];
+  Pt3f *buf = (packed ? NULL : new Pt3f[twidth]);
+  for (int i = 0; i < twidth; i ++)
+  {
+    double dhx = heightSlope (i == 0 ? wcol[0] : top0[i-1], top0[i],
+                              i == twidth - 1 ? ecol[0] : top0[i+1],
+                              i == 0 && wout, i == twidth - 1 && eout);
+    double dhy = heightSlope (nrow[i], top0[i], top1[i], nout, false);
+    encode (codes + 2 * i, - (float) dhx, - (float) dhy, 1.0f);
+  }
+  nvmf.seekp (hsize + (theight - 1) * rsize);
+  writeRow (nvmf, codes, twidth, buf);
+  for (int i = 0; i < twidth; i ++)
+  {
+    double dhx = heightSlope (i == 0 ? wcol[theight - 1] : bot0[i-1], bot0[i],
+                              i == twidth - 1 ? ecol[theight - 1] : bot0[i+1],
+                              i == 0 && wout, i == twidth - 1 && eout);
+    double dhy = heightSlope (bot1[i], bot0[i], srow[i], false, sout);
+    encode (codes + 2 * i, - (float) dhx, - (float) dhy, 1.0f);
+  }
+  nvmf.seekp (hsize);
+  writeRow (nvmf, codes, twidth, buf);
+  for (int j = 1; j < theight - 1; j ++)
+  {
+    double dhx = heightSlope (wcol[j], left0[j], left1[j], wout, false);
+    double dhy = heightSlope (left0[j-1], left0[j], left0[j+1], false, false);
+    encode (codes, - (float) dhx, - (float) dhy, 1.0f);
+    nvmf.seekp (hsize + (theight - 1 - j) * rsize);
+    writeRow (nvmf, codes, 1, buf);
+    dhx = heightSlope (right1[j], right0[j], ecol[j], false, eout);
+    dhy = heightSlope (right0[j-1], right0[j], right0[j+1], false, false);
+    encode (codes, - (float) dhx, - (float) dhy, 1.0f);
+    nvmf.seekp (hsize + (theight - 1 - j) * rsize + (twidth - 1) * psize);
+    writeRow (nvmf, codes, 1, buf);
+  }
+  bool ok = nvmf.good ();
+  nvmf.close ();
+  delete [] none;
+  delete [] codes;
+  if (buf != NULL) delete [] buf;
+  return ok;
+}
+
+
 bool TerrainMap::loadDtmMapInfo (const std::string &name)
 {
   std::ifstream dtmf (name.c_str (), std::ios::in);
@@ -993,20 +1408,18 @@ void TerrainMap::saveSubMap (int imin, int jmin, int imax, int jmax) const
     std::cout << "nvm/newtile.nvm can't be created" << std::endl;
   else
   {
-    nvmf.write ((char *) (&nw), sizeof (int));
-    nvmf.write ((char *) (&nh), sizeof (int));
-    nvmf.write ((char *) (&cell_size), sizeof (float));
-    nvmf.write ((char *) (&xm), sizeof (float));
-    nvmf.write ((char *) (&ym), sizeof (float));
-    Pt3f *line = nmap + iwidth * (iheight - 1);
-    line -= jmin * iwidth;
-    line += imin;
+    writeHeader (nvmf, nw, nh, xm, ym);
+    Pt3f *buf = (packed ? NULL : new Pt3f[nw]);
+    uint16_t *line = nmap + 2 * iwidth * (iheight - 1);
+    line -= 2 * jmin * iwidth;
+    line += 2 * imin;
     for (int j = 0; j < nh; j++)
     {
-      nvmf.write ((char *) line, nw * sizeof (Pt3f));
-      line -= iwidth;
+      writeRow (nvmf, line, nw, buf);
+      line -= 2 * iwidth;
     }
     nvmf.close ();
+    if (buf != NULL) delete [] buf;
   }
 }
 
@@ -1019,6 +1432,148 @@ void TerrainMap::checkArrangement ()
 }
 
 
+void TerrainMap::clearDerivedMaps ()
+{
+  std::vector<uint16_t *>::iterator it = pyramid.begin ();
+  while (it != pyramid.end ()) delete [] *it++;
+  pyramid.clear ();
+  if (slope_sat != NULL) delete [] slope_sat;
+  slope_sat = NULL;
+  sat_fact = 0;
+}
+
+
+Pt3f TerrainMap::decode (const uint16_t *code) const
+{
+  float u = code[0] * (2.0f / OCT_MAX) - 1.0f;
+  float v = code[1] * (2.0f / OCT_MAX) - 1.0f;
+  float z = 1.0f - (u < 0.0f ? - u : u) - (v < 0.0f ? - v : v);
+  if (z < 0.0f)
+  {
+    u += (u < 0.0f ? - z : z);
+    v += (v < 0.0f ? - z : z);
+  }
+  float n = (float) sqrt (u * u + v * v + z * z);
+  return (Pt3f (u / n, v / n, z / n));
+}
+
+
+void TerrainMap::decodeRow (const uint16_t *codes, int w,
+                            float *nx, float *ny, float *nz) const
+{
+  int i = 0;
+#if defined (__SSE2__) || defined (_M_X64)
+  const __m128 sc4 = _mm_set1_ps (2.0f / OCT_MAX);
+  const __m128 one4 = _mm_set1_ps (1.0f);
+  const __m128 zero4 = _mm_setzero_ps ();
+  const __m128 abs4 = _mm_castsi128_ps (_mm_set1_epi32 (0x7fffffff));
+  const __m128i lo16 = _mm_set1_epi32 (0xffff);
+  for (; i + 4 <= w; i += 4)
+  {
+    // Four pairs of codes (u, v) per vector
+    __m128i c = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (
+                                   codes + 2 * i));
+    __m128 u = _mm_sub_ps (_mm_mul_ps (_mm_cvtepi32_ps (
+                 _mm_and_si128 (c, lo16)), sc4), one4);
+    __m128 v = _mm_sub_ps (_mm_mul_ps (_mm_cvtepi32_ps (
+                 _mm_srli_epi32 (c, 16)), sc4), one4);
+    __m128 z = _mm_sub_ps (_mm_sub_ps (one4, _mm_and_ps (u, abs4)),
+                           _mm_and_ps (v, abs4));
+    // Lower hemisphere folding : z < 0 added to |u| and |v|
+    __m128 t = _mm_and_ps (_mm_cmplt_ps (z, zero4), z);
+    u = _mm_add_ps (u, _mm_xor_ps (t, _mm_andnot_ps (abs4,
+                                    _mm_cmplt_ps (u, zero4))));
+    v = _mm_add_ps (v, _mm_xor_ps (t, _mm_andnot_ps (abs4,
+                                    _mm_cmplt_ps (v, zero4))));
+    __m128 n = _mm_sqrt_ps (_mm_add_ps (_mm_add_ps (_mm_mul_ps (u, u),
+                 _mm_mul_ps (v, v)), _mm_mul_ps (z, z)));
+    _mm_storeu_ps (nx + i, _mm_div_ps (u, n));
+    _mm_storeu_ps (ny + i, _mm_div_ps (v, n));
+    _mm_storeu_ps (nz + i, _mm_div_ps (z, n));
+  }
+#endif
+  for (; i < w; i ++)
+  {
+    Pt3f nv = decode (codes + 2 * i);
+    nx[i] = nv.x ();
+    ny[i] = nv.y ();
+    nz[i] = nv.z ();
+  }
+}
+
+
+void TerrainMap::encode (uint16_t *code, float x, float y, float z) const
+{
+  float l1 = (x < 0.0f ? - x : x) + (y < 0.0f ? - y : y)
+             + (z < 0.0f ? - z : z);
+  float u = 0.0f, v = 0.0f;
+  if (l1 > 0.0f)
+  {
+    u = x / l1;
+    v = y / l1;
+    if (z < 0.0f)
+    {
+      float fu = (1.0f - (v < 0.0f ? - v : v)) * (u < 0.0f ? -1.0f : 1.0f);
+      v = (1.0f - (u < 0.0f ? - u : u)) * (v < 0.0f ? -1.0f : 1.0f);
+      u = fu;
+    }
+  }
+  code[0] = (uint16_t) ((u + 1.0f) * (OCT_MAX / 2) + 0.5f);
+  code[1] = (uint16_t) ((v + 1.0f) * (OCT_MAX / 2) + 0.5f);
+}
+
+
+bool TerrainMap::readHeader (std::ifstream &nvmf, int &w, int &h,
+                             float &cs, float &xm, float &ym) const
+{
+  nvmf.read ((char *) (&w), sizeof (int));
+  bool pk = (w == PACKED_TAG);
+  if (pk) nvmf.read ((char *) (&w), sizeof (int));
+  nvmf.read ((char *) (&h), sizeof (int));
+  nvmf.read ((char *) (&cs), sizeof (float));
+  nvmf.read ((char *) (&xm), sizeof (float));
+  nvmf.read ((char *) (&ym), sizeof (float));
+  return pk;
+}
+
+
+void TerrainMap::readRow (std::ifstream &nvmf, uint16_t *codes, int w,
+                          bool pk, Pt3f *buf) const
+{
+  if (pk) nvmf.read ((char *) codes, 2 * w * sizeof (uint16_t));
+  else
+  {
+    nvmf.read ((char *) buf, w * sizeof (Pt3f));
+    for (int i = 0; i < w; i ++)
+      encode (codes + 2 * i, buf[i].x (), buf[i].y (), buf[i].z ());
+  }
+}
+
+
+void TerrainMap::writeHeader (std::ofstream &nvmf, int w, int h,
+                              float xm, float ym) const
+{
+  if (packed) nvmf.write ((char *) (&PACKED_TAG), sizeof (int));
+  nvmf.write ((char *) (&w), sizeof (int));
+  nvmf.write ((char *) (&h), sizeof (int));
+  nvmf.write ((char *) (&cell_size), sizeof (float));
+  nvmf.write ((char *) (&xm), sizeof (float));
+  nvmf.write ((char *) (&ym), sizeof (float));
+}
+
+
+void TerrainMap::writeRow (std::ofstream &nvmf, const uint16_t *codes, int w,
+                           Pt3f *buf) const
+{
+  if (packed) nvmf.write ((char *) codes, 2 * w * sizeof (uint16_t));
+  else
+  {
+    for (int i = 0; i < w; i ++) buf[i].set (decode (codes + 2 * i));
+    nvmf.write ((char *) buf, w * sizeof (Pt3f));
+  }
+}
+
+
 /*
 void TerrainMap::trace ()
 {
@@ -26,6 +26,9 @@
 #define TERRAIN_MAP_H
 
 #include <string>
+#include <vector>
+#include <fstream>
+#include <inttypes.h>
 #include "pt3f.h"
 #include "pt2i.h"
 
@@ -34,6 +37,8 @@
  * @class TerrainMap terrainmap.h
  * \brief Map of Ground normal vectors.
  * The map is assembled from ASC or NVM files.
+ * Normal vectors are stored with an octahedral encoding on two 16 bit codes,
+ *   and decoded by shading functions.
  */
 class TerrainMap
 {
@@ -101,6 +106,19 @@ public:
    */
   inline double yMin () const { return y_min; }
 
+  /**
+   * \brief Returns whether new normal map files are saved with packed format.
+   */
+  inline bool packedFormat () const { return packed; }
+
+  /**
+   * \brief Sets the packed format modality of new normal map files.
+   * Packed files store the octahedral codes and are three times smaller.
+   * Both formats are recognized when reading normal map files.
+   * @param status Packed format status.
+   */
+  inline void setPackedFormat (bool status) { packed = status; }
+
   /**
    * \brief Returns a pixel from the normal map and a lighting device.
    * @param i Pixel absiscae.
@@ -116,6 +134,47 @@ public:
    */
   int get (int i, int j, int shading_type) const;
 
+  /**
+   * \brief Shades a rectangular area of the normal map with current shading.
+   * Output values are those of get (i, j), rows being shaded by bands
+   *   on the common worker pool.
+   * @param map Grayscale map of area size to fill in (row after row).
+   * @param imin Left column of the area.
+   * @param jmin First row of the area.
+   * @param w Area width.
+   * @param h Area height.
+   * @param level Level of the normal map pyramid (optional).
+   */
+  void shade (unsigned char *map, int imin, int jmin, int w, int h,
+              int level = 0) const;
+
+  /**
+   * \brief Returns the width of a level of the normal map pyramid.
+   * Level 0 is the normal map, next levels halving its size.
+   * @param level Pyramid level.
+   */
+  inline int levelWidth (int level) const {
+    return (iwidth == 0 ? 0 : ((iwidth - 1) >> level) + 1); }
+
+  /**
+   * \brief Returns the height of a level of the normal map pyramid.
+   * @param level Pyramid level.
+   */
+  inline int levelHeight (int level) const {
+    return (iheight == 0 ? 0 : ((iheight - 1) >> level) + 1); }
+
+  /**
+   * \brief Returns the count of built levels of the normal map pyramid.
+   */
+  inline int pyramidLevels () const { return ((int) pyramid.size ()); }
+
+  /**
+   * \brief Builds the normal map pyramid up to given level.
+   * Each lacking level averages the normal vectors of the former one.
+   * @param level Last required level.
+   */
+  void buildPyramid (int level);
+
   /**
    * \brief Returns an exponential slope value for a pixel of the normal map.
    * @param i Pixel absiscae.
@@ -169,6 +228,8 @@ public:
   void setSlopinessFactor (int val);
 
   /** Return the center of the closest flat area to given point.
+   * Area mean slope factors are got from an integral image, the whole map
+   *   one if built for the same factor, or a local one otherwise.
    * @param pt The input point.
    * @param srad The search area radius.
    * @param frad The slope integration area radius.
@@ -176,6 +237,27 @@ public:
    */
   Pt2i closestFlatArea (const Pt2i &pt, int srad, int frad, int sfact);
 
+  /**
+   * \brief Builds the integral image of slope factors on the whole map.
+   * It is kept for later flat area queries with the same factor.
+   * @param sfact The slope angle exponential factor.
+   */
+  void buildSlopeIntegral (int sfact);
+
+  /**
+   * \brief Returns the slope factor of the whole map integral image.
+   * Returns 0 if this integral image is not built.
+   */
+  inline int slopeIntegralFactor () const { return sat_fact; }
+
+  /**
+   * \brief Returns the mean slope factor in a square area around a pixel.
+   * Requires the whole map integral image (see buildSlopeIntegral).
+   * @param pt Area center (same coordinates as closestFlatArea).
+   * @param frad The slope integration area radius.
+   */
+  double flatness (const Pt2i &pt, int frad) const;
+
   /**
    * \brief Declares a new normal map file to add.
    * Returns whether the named file exists.
@@ -304,6 +386,19 @@ public:
    */
   bool createMapFromDtm (bool verb = false, bool grid_ref = false);
 
+  /**
+   * \brief Creates normal vector map files from added DTM (ASC) files.
+   * The map is not assembled : DTM files are parsed concurrently row after
+   *   row, then tile borders are completed from neighbour tile edges.
+   * Returns whether conversion succeeded.
+   * @param names Output file name for each added DTM file (none if empty).
+   * @param verb Warning display modality (optional).
+   * @param grid_ref True if the input file is grid-referenced (optional) :
+   *    standard is pixel-center-referenced
+   */
+  bool saveNormalMapsFromDtm (const std::vector<std::string> &names,
+                              bool verb = false, bool grid_ref = false);
+
   /**
    * \brief Loads normal map information from a DTM file.
    * Returns whether information reading was successful.
@@ -349,6 +444,14 @@ private:
   static const float MM2M;
   /** Small value for testing non zero values. */
   static const double EPS;
+  /** Leading tag of packed NVM files (first int of former ones is > 0). */
+  static const int PACKED_TAG;
+  /** Largest value of octahedral normal codes. */
+  static const float OCT_MAX;
+  /** Count of rows of shading tasks. */
+  static const int SHADE_BAND;
+  /** Fixed-point unit of integrated slope factors. */
+  static const double SLOPE_UNIT;
 
 
   /** Tile width. */
@@ -368,8 +471,16 @@ private:
   int iwidth;
   /** DTM normal map height. */
   int iheight;
-  /** DTM normal map. */
-  Pt3f *nmap;
+  /** DTM normal map (two octahedral codes per pixel). */
+  uint16_t *nmap;
+  /** Packed format modality of new normal map files. */
+  bool packed;
+  /** Normal map pyramid, from level 1 on (same encoding as the map). */
+  std::vector<uint16_t *> pyramid;
+  /** Integral image of fixed-point slope factors (rows from map bottom). */
+  int64_t *slope_sat;
+  /** Slope angle exponential factor of the integral image (0 if none). */
+  int sat_fact;
 
   /** Applied shading type. */
   int shading;
@@ -409,6 +520,152 @@ private:
   int ts_cot;
   /** Count of tile rows. */
   int ts_rot;
+
+
+  /**
+   * \brief Deletes the maps derived from the normal map.
+   * These are the pyramid and the slope factor integral image.
+   */
+  void clearDerivedMaps ();
+
+  /**
+   * \brief Fills in the integral image of slope factors of an area.
+   * The image size is (w + 1) * (h + 1), with null first row and column.
+   * @param sat Integral image to fill in.
+   * @param xmin Left column of the area.
+   * @param ymin Lower row of the area (counted from map bottom).
+   * @param w Area width.
+   * @param h Area height.
+   * @param sfact The slope angle exponential factor.
+   */
+  void integrateSlopes (int64_t *sat, int xmin, int ymin, int w, int h,
+                        int sfact) const;
+
+  /**
+   * \brief Returns the unit normal vector encoded by a pair of codes.
+   * @param code Pointer to the pair of octahedral codes.
+   */
+  Pt3f decode (const uint16_t *code) const;
+
+  /**
+   * \brief Decodes a row of octahedral codes into unit vector coordinates.
+   * @param codes Row of codes.
+   * @param w Row length.
+   * @param nx Returned first coordinates.
+   * @param ny Returned second coordinates.
+   * @param nz Returned third coordinates.
+   */
+  void decodeRow (const uint16_t *codes, int w,
+                  float *nx, float *ny, float *nz) const;
+
+  /**
+   * \brief Shades a row of the normal map with current shading.
+   * @param out Row of grayscale values to fill in.
+   * @param codes Row of codes.
+   * @param w Row length.
+   * @param buf Float buffer of three times row length.
+   */
+  void shadeRow (unsigned char *out, const uint16_t *codes, int w,
+                 float *buf) const;
+
+  /**
+   * \brief Encodes a normal vector in a pair of octahedral codes.
+   * The vector needs not be normalized.
+   * @param code Pointer to the pair of codes to set.
+   * @param x Vector first coordinate.
+   * @param y Vector second coordinate.
+   * @param z Vector third coordinate.
+   */
+  void encode (uint16_t *code, float x, float y, float z) const;
+
+  /**
+   * \brief Reads the header of a normal vector map file.
+   * Returns whether the file has packed format.
+   * @param nvmf Normal vector map file stream.
+   * @param w Returned tile width.
+   * @param h Returned tile height.
+   * @param cs Returned cell size.
+   * @param xm Returned leftmost coordinate.
+   * @param ym Returned lower coordinate.
+   */
+  bool readHeader (std::ifstream &nvmf, int &w, int &h,
+                   float &cs, float &xm, float &ym) const;
+
+  /**
+   * \brief Reads a row of a normal vector map file into octahedral codes.
+   * @param nvmf Normal vector map file stream.
+   * @param codes Row of codes to fill in.
+   * @param w Row length.
+   * @param pk Packed format of the file.
+   * @param buf Vector buffer of row length for former format files.
+   */
+  void readRow (std::ifstream &nvmf, uint16_t *codes, int w,
+                bool pk, Pt3f *buf) const;
+
+  /**
+   * \brief Writes the header of a normal vector map file.
+   * Packed format is used if packed modality is set.
+   * @param nvmf Normal vector map file stream.
+   * @param w Tile width.
+   * @param h Tile height.
+   * @param xm Leftmost coordinate.
+   * @param ym Lower coordinate.
+   */
+  void writeHeader (std::ofstream &nvmf, int w, int h,
+                    float xm, float ym) const;
+
+  /**
+   * \brief Writes a row of octahedral codes in a normal vector map file.
+   * Packed format is used if packed modality is set.
+   * @param nvmf Normal vector map file stream.
+   * @param codes Row of codes to write.
+   * @param w Row length.
+   * @param buf Vector buffer of row length for former format files.
+   */
+  void writeRow (std::ofstream &nvmf, const uint16_t *codes, int w,
+                 Pt3f *buf) const;
+
+  /**
+   * \brief Returns a DTM height difference along a row or a column.
+   * @param prev Previous height.
+   * @param cur Current height.
+   * @param next Next height.
+   * @param first No previous height (map border).
+   * @param last No next height (map border).
+   */
+  double heightSlope (double prev, double cur, double next,
+                      bool first, bool last) const;
+
+  /**
+   * \brief Parses a DTM file and writes inner normal vectors of its tile.
+   * Returns whether the file was correctly read and written.
+   * Tile borders are completed later by patchDtmTile.
+   * @param k Index of the DTM file.
+   * @param name Output normal map file name (only parsed if empty).
+   * @param edges Returned edge heights (two first and last rows, then
+   *   two first and last columns).
+   */
+  bool streamDtmTile (int k, const std::string &name, double *edges) const;
+
+  /**
+   * \brief Parses a grid-referenced DTM file and writes its normal map file.
+   * Returns whether the file was correctly read and written.
+   * @param k Index of the DTM file.
+   * @param name Output normal map file name.
+   */
+  bool streamGridDtmTile (int k, const std::string &name) const;
+
+  /**
+   * \brief Writes border normal vectors of a DTM tile normal map file.
+   * Returns whether the file was correctly written.
+   * @param k Index of the DTM file.
+   * @param name Normal map file name.
+   * @param edges Edge heights of all the DTM files.
+   * @param grid Index of the DTM file at each tile location (-1 if none).
+   */
+  bool patchDtmTile (int k, const std::string &name,
+                     const std::vector<double *> &edges,
+                     const std::vector<int> &grid) const;
 };
 
 #endif
@@ -0,0 +1,113 @@
+/*  Copyright 2021 Philippe Even, Phuc Ngo and Pierre Even,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "workerpool.h"
+
+
+/** Tells whether current thread is processing a task of a pool. */
+static thread_local bool in_pool = false;
+
+
+WorkerPool::WorkerPool (int nbthreads)
+{
+  job = NULL;
+  next = 0;
+  count = 0;
+  done = 0;
+  stopping = false;
+  if (nbthreads <= 0) nbthreads = (int) std::thread::hardware_concurrency ();
+  for (int i = 1; i < nbthreads; i++)
+    workers.push_back (std::thread (&WorkerPool::work, this));
+}
+
+
+WorkerPool::~WorkerPool ()
+{
+  {
+    std::lock_guard<std::mutex> lock (mtx);
+    stopping = true;
+  }
+  started.notify_all ();
+  std::vector<std::thread>::iterator it = workers.begin ();
+  while (it != workers.end ()) (it++)->join ();
+}
+
+
+WorkerPool &WorkerPool::common ()
+{
+  static WorkerPool pool;
+  return pool;
+}
+
+
+void WorkerPool::run (int nbtasks, const std::function<void (int)> &task)
+{
+  if (nbtasks <= 0) return;
+  if (in_pool || workers.empty () || nbtasks == 1)
+  {
+    for (int i = 0; i < nbtasks; i++) task (i);
+    return;
+  }
+  std::lock_guard<std::mutex> runlock (busy);
+  std::unique_lock<std::mutex> lock (mtx);
+  job = &task;
+  next = 0;
+  count = nbtasks;
+  done = 0;
+  started.notify_all ();
+  in_pool = true;
+  while (next < count)
+  {
+    int i = next++;
+    lock.unlock ();
+    task (i);
+    lock.lock ();
+    done ++;
+  }
+  in_pool = false;
+  finished.wait (lock, [this] { return (done == count); });
+  job = NULL;
+}
+
+
+void WorkerPool::work ()
+{
+  in_pool = true;
+  std::unique_lock<std::mutex> lock (mtx);
+  while (true)
+  {
+    started.wait (lock, [this] { return (stopping || next < count); });
+    if (stopping) return;
+    while (next < count)
+    {
+      int i = next++;
+      const std::function<void (int)> *task = job;
+      lock.unlock ();
+      (*task) (i);
+      lock.lock ();
+      if (++done == count) finished.notify_all ();
+    }
+  }
+}
@@ -0,0 +1,105 @@
+/*  Copyright 2021 Philippe Even, Phuc Ngo and Pierre Even,
+      co-authors of paper:
+      Even, P., Grzesznik, A., Gebhardt, A., Chenal, T., Even, P. and Ngo, P.,
+      2021,
+      Fast extraction of linear structures fromLiDAR raw data
+      for archaeomorphological structure prospection.
+      In the International Archives of the Photogrammetry, Remote Sensing
+      and Spatial Information Sciences (proceedings of the 2021 edition
+      of the XXIVth ISPRS Congress).
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+
+/** 
+ * @class WorkerPool workerpool.h
+ * \brief Pool of persistent threads sharing indexed tasks.
+ * The calling thread also processes tasks and returns when all are done.
+ * Runs called from a task of the pool are processed in the calling thread.
+ */
+class WorkerPool
+{
+public:
+
+  /**
+   * \brief Creates a pool of worker threads.
+   * @param nbthreads Count of threads including the caller (0 for hardware).
+   */
+  WorkerPool (int nbthreads = 0);
+
+  /**
+   * \brief Stops and deletes the worker threads.
+   */
+  ~WorkerPool ();
+
+  /**
+   * \brief Returns the pool shared by all the application.
+   */
+  static WorkerPool &common ();
+
+  /**
+   * \brief Returns the count of threads processing tasks, caller included.
+   */
+  inline int size () const { return ((int) workers.size () + 1); }
+
+  /**
+   * \brief Processes indexed tasks and waits for their completion.
+   * @param nbtasks Count of tasks.
+   * @param task Task to process for each index from 0 to nbtasks - 1.
+   */
+  void run (int nbtasks, const std::function<void (int)> &task);
+
+
+private:
+
+  /** Worker threads. */
+  std::vector<std::thread> workers;
+  /** Current task. */
+  const std::function<void (int)> *job;
+  /** Index of next task to process. */
+  int next;
+  /** Count of tasks in current run. */
+  int count;
+  /** Count of completed tasks in current run. */
+  int done;
+  /** Worker threads stop request. */
+  bool stopping;
+  /** Lock on runs. */
+  std::mutex busy;
+  /** Lock on tasks distribution. */
+  std::mutex mtx;
+  /** New tasks signal. */
+  std::condition_variable started;
+  /** Run completion signal. */
+  std::condition_variable finished;
+
+
+  /**
+   * \brief Processes tasks until the pool is stopped.
+   */
+  void work ();
+};
+
+#endif
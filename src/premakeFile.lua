@@ -62,6 +62,7 @@ project "ILSD"
 	language "C++"
 	cppdialect "C++17"
 	files { "**.cpp", "**.hpp", "**.h", "**.c", "**.cxx" }
+	removefiles { "Converter/**" }
 
 	--vs paths
 	targetdir (SrcDir.."/../binaries/".."%{prj.name}".."/".."%{cfg.longname}")
@@ -80,6 +81,10 @@ project "ILSD"
 		buildoptions { "/Ot", "/MP" }
 	filter { }
 
+	filter "system:linux"
+		links { "pthread" }
+	filter { }
+
 	--Includes
 	includedirs(SrcDir.."/ILSDInterface")
 	includedirs(SrcDir.."/GLTools")
@@ -95,3 +100,37 @@ project "ILSD"
 	includeStbi()
 	includeGlew()
 	includeGlad()
+
+project "ILSDConvert"
+	--project configuration
+	kind ("ConsoleApp")
+	language "C++"
+	cppdialect "C++17"
+	files { "Converter/**.cpp", "Converter/**.h",
+		"PointCloud/**.cpp", "PointCloud/**.h",
+		"ImageTools/**.cpp", "ImageTools/**.h" }
+
+	--vs paths
+	targetdir (SrcDir.."/../binaries/".."%{prj.name}".."/".."%{cfg.longname}")
+	objdir (SrcDir.."/../intermediate/".."%{prj.name}".."/".."%{cfg.longname}")
+	debugdir(SrcDir.."/../resources")
+
+	filter "configurations:Debug"
+		defines { "DEBUG" }
+		symbols "On"
+	filter "configurations:Release"
+		defines { "NDEBUG" }
+		optimize "On"
+	filter { }
+
+	filter "system:windows"
+		buildoptions { "/Ot", "/MP" }
+	filter { }
+
+	filter "system:linux"
+		links { "pthread" }
+	filter { }
+
+	--Includes
+	includedirs(SrcDir.."/ImageTools")
+	includedirs(SrcDir.."/PointCloud")